@@ -0,0 +1,23 @@
+//
+// fib
+//
+// Benchmark
+// - naive recursive Fibonacci (call overhead)
+//
+// Input: n
+//
+
+module fib;
+
+function fibonacci(n: integer): integer;
+begin
+  if (n < 2) then return n end;
+  return fibonacci(n-1) + fibonacci(n-2)
+end fibonacci;
+
+var n: integer;
+
+begin
+  n := ReadInt();
+  WriteStr("fib("); WriteInt(n); WriteStr(") = "); WriteInt(fibonacci(n)); WriteLn()
+end fib.
@@ -0,0 +1,118 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 synthetic module generator
+#
+# Writes a large, valid SnuPL/2 module to standard output. The module is deterministic for a given
+# set of parameters and consists of
+#  - a chain of symbolic constants, each defined in terms of its two predecessors,
+#  - a number of procedures, each with a body of straight-line assignments, nested array
+#    designators (array elements indexed by array elements), if/while statements, and calls to
+#    previously defined procedures,
+#  - a module body that calls the last procedure.
+#
+# usage: genmod.sh [-p PROCEDURES] [-s STATEMENTS] [-d DEPTH] [-c CONSTANTS] [-m MODULE]
+#   -p PROCEDURES  number of procedures (default: 100)
+#   -s STATEMENTS  number of statements per procedure (default: 20)
+#   -d DEPTH       nesting depth of array designators (default: 3)
+#   -c CONSTANTS   length of the constant chain (default: 50)
+#   -m MODULE      module name (default: synth)
+#
+
+PROCS=100
+STMTS=20
+DEPTH=3
+CONSTS=50
+MODULE=synth
+
+while getopts "p:s:d:c:m:" opt; do
+  case "$opt" in
+    p) PROCS=$OPTARG ;;
+    s) STMTS=$OPTARG ;;
+    d) DEPTH=$OPTARG ;;
+    c) CONSTS=$OPTARG ;;
+    m) MODULE=$OPTARG ;;
+    *) sed -n '/^# usage/,/^#$/p' "$0" | sed 's/^# \{0,1\}//' >&2; exit 1 ;;
+  esac
+done
+
+if [ "$CONSTS" -lt 2 ] || [ "$PROCS" -lt 1 ] || [ "$STMTS" -lt 1 ] || [ "$DEPTH" -lt 0 ]; then
+  echo "genmod.sh: need at least 2 constants, 1 procedure and 1 statement" >&2
+  exit 1
+fi
+
+awk -v procs="$PROCS" -v stmts="$STMTS" -v depth="$DEPTH" -v consts="$CONSTS" \
+    -v module="$MODULE" '
+# nested designator of depth d: alternately indexes T and M with the next inner designator
+function designator(d, k) {
+  if (d == 0) return "(" k " + j) / 2";
+  if (d % 2) return "T[" designator(d-1, k) "]";
+  return "M[" designator(d-1, k+1) "][" k "]";
+}
+
+function constant(k) {
+  return "C" (k % consts);
+}
+
+BEGIN {
+  srand(4190);
+
+  print "//";
+  print "// " module;
+  print "//";
+  print "// synthetic module: " procs " procedures, " stmts " statements per procedure,";
+  print "// designator depth " depth ", constant chain length " consts;
+  print "//";
+  print "";
+  print "module " module ";";
+  print "";
+
+  print "const";
+  print "  C0 : integer = 1;";
+  print "  C1 : integer = 2;";
+  for (c=2; c<consts; c++) {
+    printf "  C%d : integer = (C%d + C%d) / 2 + 1;\n", c, c-1, c-2;
+  }
+  print "";
+
+  print "var T : integer[8];";
+  print "    M : integer[8][8];";
+  print "    g : integer;";
+  print "";
+
+  for (p=0; p<procs; p++) {
+    printf "procedure p%d(x: integer; A: integer[]);\n", p;
+    print  "var i, j, t : integer;";
+    print  "    L : integer[8][8];";
+    print  "begin";
+    line = "  i := 0; j := x / 8; t := x";
+    for (s=0; s<stmts; s++) {
+      print line ";";
+      kind = int(rand() * 6);
+      k = int(rand() * 8);
+      if (kind == 0) {
+        line = sprintf("  t := t + %s * i - x / (j + 1)", constant(int(rand() * consts)));
+      } else if (kind == 1) {
+        line = sprintf("  L[%d][j] := %s + T[%d]", k, designator(depth, k), (k + 3) % 8);
+      } else if (kind == 2) {
+        line = sprintf("  if (t > %s) then t := t - %d else t := t + A[%d] end",
+                       constant(int(rand() * consts)), k, k % 2);
+      } else if (kind == 3) {
+        line = sprintf("  while (i < %d) do L[i][%d] := %s; i := i + 1 end",
+                       k, k, designator(depth > 1 ? 1 : depth, k));
+      } else if (kind == 4 && p > 0) {
+        line = sprintf("  p%d(t / 8, A)", int(rand() * p));
+      } else {
+        line = sprintf("  g := g + L[%d][%d] * %s", k, (k + 5) % 8, constant(p + s));
+      }
+    }
+    print line;
+    printf "end p%d;\n", p;
+    print  "";
+  }
+
+  print "var A : integer[2];";
+  print "begin";
+  print "  g := 0;";
+  printf "  p%d(C%d, A)\n", procs-1, consts-1;
+  print "end " module ".";
+}'
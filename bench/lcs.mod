@@ -0,0 +1,91 @@
+//
+// lcs
+//
+// Benchmark
+// - dynamic programming over a 2-D array (longest common subsequence)
+//
+// Input: sequence length (at most N), number of repetitions
+//
+
+module lcs;
+
+const N: integer = 1200;
+
+var L: integer[N+1][N+1];
+    a, b: char[N];
+    seed: integer;
+
+function rnd(): integer;
+begin
+  seed := seed * 75 + 74;
+  seed := seed - seed / 65537 * 65537;
+  return seed
+end rnd;
+
+// random sequence over the alphabet "ACGT"
+procedure generate(s: char[]; n: integer);
+var i, r: integer;
+begin
+  i := 0;
+  while (i < n) do
+    r := rnd();
+    r := r - r / 4 * 4;
+    if (r = 0) then s[i] := 'A'
+    else if (r = 1) then s[i] := 'C'
+    else if (r = 2) then s[i] := 'G'
+    else s[i] := 'T'
+    end end end;
+    i := i + 1
+  end
+end generate;
+
+function length(L: integer[][]; a, b: char[]; n: integer): integer;
+var i, j: integer;
+begin
+  i := 0;
+  while (i <= n) do
+    L[i][0] := 0;
+    L[0][i] := 0;
+    i := i + 1
+  end;
+
+  i := 1;
+  while (i <= n) do
+    j := 1;
+    while (j <= n) do
+      if (a[i-1] = b[j-1]) then
+        L[i][j] := L[i-1][j-1] + 1
+      else
+        if (L[i-1][j] >= L[i][j-1]) then
+          L[i][j] := L[i-1][j]
+        else
+          L[i][j] := L[i][j-1]
+        end
+      end;
+      j := j + 1
+    end;
+    i := i + 1
+  end;
+
+  return L[n][n]
+end length;
+
+var n, reps, r, len: integer;
+
+begin
+  n := ReadInt();
+  reps := ReadInt();
+  if (n > N) then n := N end;
+
+  seed := 3;
+  generate(a, n);
+  generate(b, n);
+
+  r := 0;
+  while (r < reps) do
+    len := length(L, a, b, n);
+    r := r + 1
+  end;
+
+  WriteStr("lcs "); WriteInt(n); WriteStr(": "); WriteInt(len); WriteLn()
+end lcs.
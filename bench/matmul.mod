@@ -0,0 +1,98 @@
+//
+// matmul
+//
+// Benchmark
+// - dense integer matrix multiplication C = A * B over open 2-D arrays
+//
+// Input: matrix size n (at most N), number of repetitions
+//
+
+module matmul;
+
+const N: integer = 160;
+
+var A, B, C: integer[N][N];
+    seed: integer;
+
+// pseudo-random numbers in [0, 100)
+function rnd(): integer;
+begin
+  seed := seed * 75 + 74;
+  seed := seed - seed / 65537 * 65537;
+  return seed - seed / 100 * 100
+end rnd;
+
+procedure init(M: integer[][]; n: integer);
+var i, j: integer;
+begin
+  i := 0;
+  while (i < n) do
+    j := 0;
+    while (j < n) do
+      M[i][j] := rnd();
+      j := j + 1
+    end;
+    i := i + 1
+  end
+end init;
+
+procedure multiply(A, B, C: integer[][]; n: integer);
+var i, j, k, s: integer;
+begin
+  i := 0;
+  while (i < n) do
+    j := 0;
+    while (j < n) do
+      s := 0;
+      k := 0;
+      while (k < n) do
+        s := s + A[i][k] * B[k][j];
+        k := k + 1
+      end;
+      C[i][j] := s;
+      j := j + 1
+    end;
+    i := i + 1
+  end
+end multiply;
+
+// polynomial hash of the elements modulo a prime
+function checksum(M: integer[][]; n: integer): integer;
+var i, j, s: integer;
+begin
+  s := 0;
+  i := 0;
+  while (i < n) do
+    j := 0;
+    while (j < n) do
+      s := s * 31 + M[i][j];
+      s := s - s / 1000003 * 1000003;
+      j := j + 1
+    end;
+    i := i + 1
+  end;
+  return s
+end checksum;
+
+var n, reps, r, total: integer;
+
+begin
+  n := ReadInt();
+  reps := ReadInt();
+  if (n > N) then n := N end;
+
+  seed := 1;
+  init(A, n);
+  init(B, n);
+
+  total := 0;
+  r := 0;
+  while (r < reps) do
+    multiply(A, B, C, n);
+    total := total + checksum(C, n);
+    total := total - total / 1000003 * 1000003;
+    r := r + 1
+  end;
+
+  WriteStr("matmul "); WriteInt(n); WriteStr(": "); WriteInt(total); WriteLn()
+end matmul.
@@ -0,0 +1,123 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 benchmark harness
+#
+# Builds each benchmark with our snuplc and with the reference compiler, checks the output against
+# .reference/<benchmark>.mod.out, and reports the median runtime over several runs, the number of
+# retired instructions (if 'perf stat' is available), and the size of the generated code.
+#
+# usage: run.sh [-r REPS] [-b BENCHMARK]... [SNUPLC OPTIONS]...
+#   -r REPS       number of timed runs per benchmark (default: 5)
+#   -b BENCHMARK  run only the given benchmark (may be repeated; default: all)
+#   remaining options are passed to our snuplc (e.g., -O2)
+#
+# The compilers can be overridden with the SNUPLC and REFERENCE environment variables.
+#
+
+BENCH=$(cd "$(dirname "$0")" && pwd)
+ROOT=$BENCH/../snuplc
+SNUPLC=${SNUPLC:-$ROOT/snuplc}
+REFERENCE=${REFERENCE:-$ROOT/reference/snuplc}
+TARGET=x86-64
+RUNTIME=snupl
+
+REPS=5
+BENCHMARKS=()
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -r) REPS=$2; shift 2 ;;
+    -b) BENCHMARKS+=("$2"); shift 2 ;;
+    *)  break ;;
+  esac
+done
+FLAGS=("$@")
+
+if [ ${#BENCHMARKS[@]} -eq 0 ]; then
+  for f in "$BENCH"/*.mod; do BENCHMARKS+=("$(basename "$f" .mod)"); done
+fi
+
+# perf counts the instructions of the benchmark only if it may access the counters
+PERF=0
+if command -v perf >/dev/null 2>&1 && perf stat -x, -e instructions:u true >/dev/null 2>&1; then
+  PERF=1
+fi
+
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+# time_ms <benchmark> <input>: run the benchmark once and print the elapsed time in ms
+time_ms() {
+  local s e
+  s=$(date +%s%N)
+  "$1" < "$2" > /dev/null 2>&1
+  e=$(date +%s%N)
+  echo $(( (e - s) / 1000 )) | awk '{ printf "%.1f\n", $1 / 1000 }'
+}
+
+# median of the numbers on stdin
+median() {
+  sort -n | awk '{ v[NR] = $1 } END { if (NR % 2) print v[(NR+1)/2]; else printf "%.1f\n", (v[NR/2] + v[NR/2+1]) / 2 }'
+}
+
+# measure <name> <compiler> <benchmark> [compiler options]: build and measure a benchmark
+measure() {
+  local name=$1 cc=$2 b=$3
+  shift 3
+  local dir=$BUILD/$name
+  local exe=$dir/$b input=$BENCH/$b.in
+  local status=ok ms=- insn=- text=-
+
+  mkdir -p "$dir"
+  cp "$BENCH/$b.mod" "$dir/"
+
+  if ! (cd "$dir" && "$cc" "$@" "$b.mod" > "$b.log" 2>&1 && [ -f "$b.mod.s" ]); then
+    status="compile error"
+  elif ! gcc -m64 -L"$ROOT/rte/$TARGET" -o "$exe" "$dir/$b.mod.s" -l$RUNTIME > /dev/null 2>&1; then
+    status="link error"
+  else
+    gcc -m64 -c -o "$dir/$b.o" "$dir/$b.mod.s" > /dev/null 2>&1
+    text=$(size -A "$dir/$b.o" | awk '$1 == ".text" { print $2 }')
+
+    # SnuPL programs do not set a meaningful exit code; only the output is checked
+    "$exe" < "$input" > "$dir/$b.out" 2>&1
+    if ! cmp -s "$dir/$b.out" "$BENCH/.reference/$b.mod.out"; then
+      status="wrong output"
+    fi
+
+    ms=$(for i in $(seq "$REPS"); do time_ms "$exe" "$input"; done | median)
+
+    if [ $PERF -eq 1 ]; then
+      insn=$(perf stat -x, -e instructions:u "$exe" < "$input" 2>&1 >/dev/null | \
+             awk -F, '/instructions/ { print $1 }')
+    fi
+  fi
+
+  printf "  %-10s %-10s %12s %15s %10s  %s\n" "$b" "$name" "$ms" "$insn" "$text" "$status"
+  LAST_MS=$ms
+  [ "$status" = ok ]
+}
+
+echo "SnuPL/2 benchmarks: $REPS runs, snuplc options: ${FLAGS[*]:-(none)}"
+[ $PERF -eq 1 ] || echo "  (perf not available: instruction counts are not measured)"
+printf "  %-10s %-10s %12s %15s %10s  %s\n" benchmark compiler "median (ms)" instructions "text (B)" status
+
+fail=0
+for b in "${BENCHMARKS[@]}"; do
+  if [ ! -f "$BENCH/$b.mod" ]; then
+    echo "  $b: no such benchmark"
+    fail=1
+    continue
+  fi
+
+  measure snuplc "$SNUPLC" "$b" --no-cache "${FLAGS[@]}" || fail=1
+  ours=$LAST_MS
+  measure reference "$REFERENCE" "$b"
+  ref=$LAST_MS
+
+  if [ "$ours" != - ] && [ "$ref" != - ]; then
+    awk -v o="$ours" -v r="$ref" \
+      'BEGIN { if (o > 0) printf "  %-10s %-10s %11.2fx\n", "", "speedup", r / o }'
+  fi
+done
+
+exit $fail
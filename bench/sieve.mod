@@ -0,0 +1,58 @@
+//
+// sieve
+//
+// Benchmark
+// - sieve of Eratosthenes over a boolean array
+//
+// Input: upper limit (at most N), number of repetitions
+//
+
+module sieve;
+
+const N: integer = 1000000;
+
+var composite: boolean[N+1];
+
+function primes(flags: boolean[]; limit: integer): integer;
+var i, j, count: integer;
+begin
+  i := 0;
+  while (i <= limit) do
+    flags[i] := false;
+    i := i + 1
+  end;
+
+  count := 0;
+  i := 2;
+  while (i <= limit) do
+    if (!flags[i]) then
+      count := count + 1;
+      if (i <= limit / i) then
+        j := i * i;
+        while (j <= limit) do
+          flags[j] := true;
+          j := j + i
+        end
+      end
+    end;
+    i := i + 1
+  end;
+
+  return count
+end primes;
+
+var limit, reps, r, count: integer;
+
+begin
+  limit := ReadInt();
+  reps := ReadInt();
+  if (limit > N) then limit := N end;
+
+  r := 0;
+  while (r < reps) do
+    count := primes(composite, limit);
+    r := r + 1
+  end;
+
+  WriteStr("primes <= "); WriteInt(limit); WriteStr(": "); WriteInt(count); WriteLn()
+end sieve.
@@ -0,0 +1,94 @@
+//
+// sort
+//
+// Benchmark
+// - recursive quicksort of pseudo-random integers
+//
+// Input: number of elements (at most N), number of repetitions
+//
+
+module sort;
+
+const N: integer = 200000;
+
+var data: integer[N];
+    seed: integer;
+
+// pseudo-random numbers in [0, 1000000)
+function rnd(): integer;
+begin
+  seed := seed * 75 + 74;
+  seed := seed - seed / 65537 * 65537;
+  return seed * 15 + seed / 7
+end rnd;
+
+procedure fill(a: integer[]; n: integer);
+var i: integer;
+begin
+  i := 0;
+  while (i < n) do
+    a[i] := rnd();
+    i := i + 1
+  end
+end fill;
+
+procedure quicksort(a: integer[]; lo, hi: integer);
+var i, j, pivot, t: integer;
+begin
+  while (lo < hi) do
+    pivot := a[lo + (hi - lo) / 2];
+    i := lo;
+    j := hi;
+    while (i <= j) do
+      while (a[i] < pivot) do i := i + 1 end;
+      while (a[j] > pivot) do j := j - 1 end;
+      if (i <= j) then
+        t := a[i]; a[i] := a[j]; a[j] := t;
+        i := i + 1;
+        j := j - 1
+      end
+    end;
+
+    // recurse into the smaller part, iterate over the larger one
+    if (j - lo < hi - i) then
+      quicksort(a, lo, j);
+      lo := i
+    else
+      quicksort(a, i, hi);
+      hi := j
+    end
+  end
+end quicksort;
+
+function sorted(a: integer[]; n: integer): boolean;
+var i: integer;
+begin
+  i := 1;
+  while (i < n) do
+    if (a[i-1] > a[i]) then return false end;
+    i := i + 1
+  end;
+  return true
+end sorted;
+
+var n, reps, r, sum: integer;
+
+begin
+  n := ReadInt();
+  reps := ReadInt();
+  if (n > N) then n := N end;
+
+  seed := 7;
+  sum := 0;
+  r := 0;
+  while (r < reps) do
+    fill(data, n);
+    quicksort(data, 0, n-1);
+    if (!sorted(data, n)) then WriteStr("not sorted"); WriteLn() end;
+    sum := sum + data[0] + data[n/2] + data[n-1];
+    sum := sum - sum / 1000003 * 1000003;
+    r := r + 1
+  end;
+
+  WriteStr("sort "); WriteInt(n); WriteStr(": "); WriteInt(sum); WriteLn()
+end sort.
@@ -0,0 +1,120 @@
+//
+// strscan
+//
+// Benchmark
+// - scanning and searching character arrays
+//
+// Input: text length (at most N), number of repetitions
+//
+
+module strscan;
+
+const N: integer = 400000;
+      Words: char[] = "the quick brown fox jumps over the lazy dog, then the other dog bathes.\n";
+
+var text: char[N];
+
+// length of a NUL-terminated string
+function length(s: char[]): integer;
+var n: integer;
+begin
+  n := 0;
+  while (s[n] # '\0') do n := n + 1 end;
+  return n
+end length;
+
+// fill t with n characters of s (repeated) and terminate it
+procedure fill(t: char[]; n: integer; s: char[]);
+var i, j, l: integer;
+begin
+  l := length(s);
+  i := 0;
+  j := 0;
+  while (i < n) do
+    t[i] := s[j];
+    i := i + 1;
+    j := j + 1;
+    if (j = l) then j := 0 end
+  end;
+  t[n] := '\0'
+end fill;
+
+function isvowel(c: char): boolean;
+begin
+  return (c = 'a') || (c = 'e') || (c = 'i') || (c = 'o') || (c = 'u')
+end isvowel;
+
+function isletter(c: char): boolean;
+begin
+  return ((c >= 'a') && (c <= 'z')) || ((c >= 'A') && (c <= 'Z'))
+end isletter;
+
+// number of words
+function words(t: char[]): integer;
+var i, n: integer;
+    inword: boolean;
+begin
+  i := 0;
+  n := 0;
+  inword := false;
+  while (t[i] # '\0') do
+    if (isletter(t[i])) then
+      if (!inword) then n := n + 1 end;
+      inword := true
+    else
+      inword := false
+    end;
+    i := i + 1
+  end;
+  return n
+end words;
+
+// number of vowels
+function vowels(t: char[]): integer;
+var i, n: integer;
+begin
+  i := 0;
+  n := 0;
+  while (t[i] # '\0') do
+    if (isvowel(t[i])) then n := n + 1 end;
+    i := i + 1
+  end;
+  return n
+end vowels;
+
+// number of occurrences of p in t (naive search)
+function count(t, p: char[]): integer;
+var i, j, n: integer;
+begin
+  i := 0;
+  n := 0;
+  while (t[i] # '\0') do
+    j := 0;
+    while ((p[j] # '\0') && (t[i+j] = p[j])) do j := j + 1 end;
+    if (p[j] = '\0') then n := n + 1 end;
+    i := i + 1
+  end;
+  return n
+end count;
+
+var n, reps, r: integer;
+    w, v, c: integer;
+
+begin
+  n := ReadInt();
+  reps := ReadInt();
+  if (n > N-1) then n := N-1 end;
+
+  fill(text, n, Words);
+
+  r := 0;
+  while (r < reps) do
+    w := words(text);
+    v := vowels(text);
+    c := count(text, "the") + count(text, "dog");
+    r := r + 1
+  end;
+
+  WriteStr("strscan "); WriteInt(n); WriteStr(": ");
+  WriteInt(w); WriteChar(' '); WriteInt(v); WriteChar(' '); WriteInt(c); WriteLn()
+end strscan.
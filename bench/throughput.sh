@@ -0,0 +1,147 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 compiler throughput benchmark
+#
+# Generates synthetic modules of increasing size with genmod.sh and measures how fast the compiler
+# processes them. Each module is run through the test drivers test_scanner, test_parser,
+# test_semanal, and test_ir (each of which runs all phases up to its own) and through snuplc.
+# The first table reports the throughput of each driver in lines per second together with the
+# peak memory and the number of allocations per line of snuplc. The second table breaks down the
+# time of snuplc per phase (from --time-report-json) in microseconds per line; with linear
+# compile-time complexity, these numbers stay constant as the modules grow.
+#
+# Note that the test drivers print their results (tokens, AST, TAC); their times include the
+# cost of printing to /dev/null.
+#
+# usage: throughput.sh [-r REPS] [-k KNOB] [-n SIZES] [-g GENMOD OPTIONS] [SNUPLC OPTIONS]...
+#   -r REPS     number of timed runs per driver and module (default: 3)
+#   -k KNOB     genmod.sh option that is scaled: p, s, d, or c (default: p)
+#   -n SIZES    values of the scaled option (default: "100 200 400 800 1600")
+#   -g OPTIONS  options for genmod.sh for the other knobs (default: "-s 20 -d 3 -c 50")
+#   remaining options are passed to snuplc (e.g., -O2)
+#
+# The compiler directory can be overridden with the SNUPLC_DIR environment variable.
+#
+
+BENCH=$(cd "$(dirname "$0")" && pwd)
+ROOT=${SNUPLC_DIR:-$BENCH/../snuplc}
+DRIVERS=(test_scanner test_parser test_semanal test_ir snuplc)
+
+REPS=3
+KNOB=p
+SIZES="100 200 400 800 1600"
+GENOPTS="-s 20 -d 3 -c 50"
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -r) REPS=$2; shift 2 ;;
+    -k) KNOB=$2; shift 2 ;;
+    -n) SIZES=$2; shift 2 ;;
+    -g) GENOPTS=$2; shift 2 ;;
+    *)  break ;;
+  esac
+done
+FLAGS=("$@")
+
+case "$KNOB" in
+  p|s|d|c) ;;
+  *) echo "throughput.sh: invalid knob '$KNOB' (must be p, s, d, or c)" >&2; exit 1 ;;
+esac
+
+for d in "${DRIVERS[@]}"; do
+  if [ ! -x "$ROOT/$d" ]; then
+    echo "throughput.sh: $ROOT/$d not found (run 'make reallyall' in $ROOT)" >&2
+    exit 1
+  fi
+done
+
+BUILD=$(mktemp -d)
+trap 'rm -rf "$BUILD"' EXIT
+
+# time_s <command>...: run the command once in the build directory and print the elapsed time in s
+time_s() {
+  local s e
+  s=$(date +%s%N)
+  (cd "$BUILD" && "$@" > /dev/null 2>&1)
+  e=$(date +%s%N)
+  awk -v ns=$((e - s)) 'BEGIN { printf "%.6f\n", ns / 1e9 }'
+}
+
+# median of the numbers on stdin
+median() {
+  sort -g | awk '{ v[NR] = $1 } END { if (NR % 2) print v[(NR+1)/2]; else printf "%.6f\n", (v[NR/2] + v[NR/2+1]) / 2 }'
+}
+
+# phases <json>: print "phase wall allocs" for each phase of the total of a time report
+phases() {
+  awk '/"files"/ { exit }
+       /"phase":/ { gsub(/[",{}]/, ""); print $2, $4, $8 }' "$1"
+}
+
+echo "SnuPL/2 compiler throughput: $REPS runs, scaling -$KNOB over $SIZES, genmod options: $GENOPTS"
+echo "snuplc options: ${FLAGS[*]:-(none)}"
+printf "  %6s %8s" "-$KNOB" lines
+for d in "${DRIVERS[@]}"; do printf " %13s" "$d"; done
+printf " %10s %10s %7s\n" "B/line" "allocs/l" growth
+printf "  %6s %8s" "" ""
+for d in "${DRIVERS[@]}"; do printf " %13s" "(lines/s)"; done
+printf "\n"
+
+fail=0
+prev_lines=
+prev_time=
+PHASES=()
+declare -A USPERLINE
+for n in $SIZES; do
+  mod=synth$n.mod
+  # shellcheck disable=SC2086
+  "$BENCH/genmod.sh" $GENOPTS -$KNOB "$n" -m "synth$n" > "$BUILD/$mod" || exit 1
+  lines=$(wc -l < "$BUILD/$mod")
+
+  printf "  %6s %8s" "$n" "$lines"
+  for d in "${DRIVERS[@]}"; do
+    args=("$mod")
+    [ "$d" = snuplc ] && args=(--no-cache "${FLAGS[@]}" "$mod")
+    t=$(for i in $(seq "$REPS"); do time_s "$ROOT/$d" "${args[@]}"; done | median)
+    awk -v l="$lines" -v t="$t" 'BEGIN { printf " %13.0f", (t > 0 ? l / t : 0) }'
+  done
+
+  # memory and per-phase breakdown of snuplc
+  json=$BUILD/synth$n.json
+  if ! (cd "$BUILD" && "$ROOT/snuplc" --no-cache "${FLAGS[@]}" --time-report-json="$json" "$mod" \
+        > /dev/null 2>&1) || [ ! -s "$json" ]; then
+    printf "  compile error\n"
+    fail=1
+    continue
+  fi
+  rss=$(awk -F'[:,]' '/"peak_rss_kib"/ { print $2; exit }' "$json")
+  allocs=$(phases "$json" | awk '{ a += $3 } END { print a + 0 }')
+  growth=-
+  if [ -n "$prev_lines" ]; then
+    growth=$(awk -v l0="$prev_lines" -v t0="$prev_time" -v l1="$lines" -v t1="$t" \
+             'BEGIN { if (t0 > 0 && t1 > 0 && l1 != l0) printf "%.2f", log(t1/t0) / log(l1/l0); else print "-" }')
+  fi
+  awk -v r="$rss" -v a="$allocs" -v l="$lines" -v g="$growth" \
+    'BEGIN { printf " %10.0f %10.1f %7s\n", r * 1024 / l, a / l, g }'
+  prev_lines=$lines
+  prev_time=$t
+
+  while read -r phase wall _; do
+    [ -z "${USPERLINE[$phase,order]}" ] && { USPERLINE[$phase,order]=1; PHASES+=("$phase"); }
+    USPERLINE[$phase,$n]=$(awk -v w="$wall" -v l="$lines" 'BEGIN { printf "%.2f", w * 1e6 / l }')
+  done < <(phases "$json")
+done
+
+echo
+echo "snuplc time per phase (us/line)"
+printf "  %-12s" phase
+for n in $SIZES; do printf " %9s" "-$KNOB $n"; done
+printf "\n"
+for phase in "${PHASES[@]}"; do
+  printf "  %-12s" "$phase"
+  for n in $SIZES; do printf " %9s" "${USPERLINE[$phase,$n]:--}"; done
+  printf "\n"
+done
+echo
+echo "growth: exponent k of the snuplc time t ~ lines^k between consecutive sizes (1 = linear)"
+
+exit $fail
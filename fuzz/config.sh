@@ -0,0 +1,110 @@
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 differential testing: configurations and the sandbox (sourced by run.sh and reduce.sh)
+#
+# Expects SNUPLC, REFERENCE, and LIMIT (seconds) to be set.
+#
+
+TARGET=x86-64
+RUNTIME=snupl
+CONFIGS="interp interp-O2 O0 O1 O2 reference"
+
+# limits of the sandbox: virtual memory and size of written files in KB
+MEMORY=2097152
+FILESIZE=65536
+
+# run without network access if unprivileged user namespaces are available
+UNSHARE=
+if unshare -rn true > /dev/null 2>&1; then
+  UNSHARE="unshare -rn"
+fi
+
+# sandbox <dir> <stdout> <stderr> <command>...: run a command in dir with limited resources
+sandbox() {
+  local dir=$1 out=$2 err=$3
+  shift 3
+  # the outer redirection silences the shell's report of children killed by a signal
+  {
+    (
+      cd "$dir" || exit 1
+      ulimit -t "$LIMIT" -v $MEMORY -f $FILESIZE -c 0
+      exec timeout -s KILL "$LIMIT" $UNSHARE "$@"
+    ) < /dev/null > "$out" 2> "$err"
+  } 2> /dev/null
+}
+
+# classify <exit code>: status of a run. SnuPL programs do not set a meaningful exit code, so any
+# regular exit is ok; the runtime limits are enforced with SIGKILL (timeout) and SIGXCPU (ulimit).
+classify() {
+  case "$1" in
+    124|137|152) echo timeout ;;
+    *) if [ "$1" -gt 128 ]; then echo "signal $(($1 - 128))"; else echo ok; fi ;;
+  esac
+}
+
+# build_and_run <configuration> <module> <prefix>: build and run the module in a fresh directory.
+# Writes the status and the output of the program to <prefix>.result.
+build_and_run() {
+  local c=$1 mod=$2 res=$3.result
+  local dir=$3.d
+  local st
+
+  rm -rf "$dir"
+  mkdir -p "$dir"
+  cp "$mod" "$dir/fuzz.mod"
+
+  case "$c" in
+    interp|interp-O2)
+      local opt=-O0
+      [ "$c" = interp-O2 ] && opt=-O2
+      sandbox "$dir" "$dir/out" "$dir/log" "$SNUPLC" --no-cache "$opt" --interpret fuzz.mod
+      st=$?
+      # the interpreter exits with EXIT_FAILURE if the module does not compile or aborts
+      if [ $st -eq 1 ]; then
+        st="runtime error"
+        grep -q " error at " "$dir/log" && st="compile error"
+      else
+        st=$(classify $st)
+      fi
+      ;;
+    *)
+      local cc=$SNUPLC opts=(--no-cache "-$c")
+      if [ "$c" = reference ]; then cc=$REFERENCE; opts=(); fi
+      sandbox "$dir" "$dir/log" "$dir/log.err" "$cc" "${opts[@]}" fuzz.mod
+      st=$(classify $?)
+      : > "$dir/out"
+      if [ ! -s "$dir/fuzz.mod.s" ]; then
+        # the reference compiler does not support all programs; it is then not compared
+        if [ "$c" = reference ]; then st="n/a"; elif [ "$st" = ok ]; then st="compile error"; fi
+      elif ! gcc -m64 -L"$ROOT/rte/$TARGET" -o "$dir/fuzz" "$dir/fuzz.mod.s" -l$RUNTIME \
+             > /dev/null 2>&1; then
+        st="link error"
+      else
+        sandbox "$dir" "$dir/out" /dev/null ./fuzz
+        st=$(classify $?)
+      fi
+      ;;
+  esac
+
+  { echo "status: $st"; cat "$dir/out"; } > "$res"
+  rm -rf "$dir"
+}
+
+# status <prefix>: the status of a result
+status() {
+  sed -n '1s/^status: //p' "$1.result"
+}
+
+# compare <dir>: the configurations whose results differ from the baseline
+compare() {
+  local c d=""
+  if [ "$(status "$1/interp")" != ok ]; then
+    echo interp
+    return
+  fi
+  for c in $CONFIGS; do
+    [ "$c" = interp ] && continue
+    [ "$(status "$1/$c")" = "n/a" ] && continue
+    cmp -s "$1/interp.result" "$1/$c.result" || d="$d $c"
+  done
+  echo $d
+}
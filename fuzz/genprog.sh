@@ -0,0 +1,456 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 random program generator
+#
+# Writes a random, well-typed SnuPL/2 module to standard output. The module is deterministic for a
+# given seed and set of parameters and consists of
+#  - global scalars of all base types, one- and two-dimensional global arrays, and loop counters,
+#  - a number of procedures and functions with scalar and open array parameters. Procedures may
+#    modify globals, print, and call earlier procedures and functions; functions are pure (they
+#    only modify their locals and parameters and only call earlier functions) so that the order
+#    in which operands are evaluated is not observable,
+#  - a module body that initializes the globals, runs a random statement sequence, and prints the
+#    final value of every global.
+#
+# Statements are assignments to scalars and array elements, output, nested if and while statements,
+# and calls. Expressions use all operators of the language; divisors have the form (e*e + 1) and are
+# thus never 0 or -1, array indices are constants or counters of enclosing loops and always in
+# bounds, and all loops are counted. The estimated number of executed statements is bounded, so
+# every generated program terminates quickly.
+#
+# Procedures, statements, and composite expressions are numbered. Elements listed with -x are
+# omitted (statements, calls, and procedures) or replaced by a constant (expressions) while the
+# rest of the module stays the same; reduce.sh uses this to minimize failing programs.
+#
+# usage: genprog.sh [-s SEED] [-p PROCEDURES] [-n STATEMENTS] [-d DEPTH] [-e DEPTH] [-l|-r] [-x IDS]
+#   -s SEED        random seed (default: 1)
+#   -p PROCEDURES  number of procedures and functions (default: 4)
+#   -n STATEMENTS  maximum number of statements per statement sequence (default: 5)
+#   -d DEPTH       maximum nesting depth of if and while statements (default: 3)
+#   -e DEPTH       maximum depth of expressions (default: 3)
+#   -l             mix integer and longint operands (not supported by the reference compiler)
+#   -r             do not divide (the reference compiler fails on negative dividends)
+#   -x IDS         comma-separated list of elements or ranges of elements (a-b) to omit
+#
+
+SEED=1
+PROCS=4
+STMTS=5
+DEPTH=3
+EDEPTH=3
+LONG=0
+DIVIDE=1
+OMIT=
+
+while getopts "s:p:n:d:e:lrx:" opt; do
+  case "$opt" in
+    s) SEED=$OPTARG ;;
+    p) PROCS=$OPTARG ;;
+    n) STMTS=$OPTARG ;;
+    d) DEPTH=$OPTARG ;;
+    e) EDEPTH=$OPTARG ;;
+    l) LONG=1 ;;
+    r) DIVIDE=0 ;;
+    x) OMIT=$OPTARG ;;
+    *) sed -n '/^# usage/,/^#$/p' "$0" | sed 's/^# \{0,1\}//' >&2; exit 1 ;;
+  esac
+done
+
+if [ "$PROCS" -lt 0 ] || [ "$STMTS" -lt 1 ] || [ "$DEPTH" -lt 1 ] || [ "$EDEPTH" -lt 0 ]; then
+  echo "genprog.sh: need at least 1 statement per sequence and a nesting depth of at least 1" >&2
+  exit 1
+fi
+
+awk -v seed="$SEED" -v procs="$PROCS" -v stmts="$STMTS" -v depth="$DEPTH" -v edepth="$EDEPTH" \
+    -v long="$LONG" -v divide="$DIVIDE" -v omit="$OMIT" '
+# upper bound on the estimated number of statements executed by one procedure or the module body
+function budget() { return 20000; }
+
+function pick(n) { return int(rand() * n); }
+
+function chance(p) { return rand() < p; }
+
+function tab(d) { return sprintf("%" (2*d) "s", ""); }
+
+# random scalar type: i(nteger), l(ongint), b(oolean), c(har)
+function rtype(  r) {
+  r = rand();
+  if (r < 0.45) return "i";
+  if (r < 0.65) return long ? "l" : "i";
+  if (r < 0.85) return "b";
+  return "c";
+}
+
+function tname(t) {
+  if (t == "i") return "integer";
+  if (t == "l") return "longint";
+  if (t == "b") return "boolean";
+  if (t == "c") return "char";
+  return "integer[]";
+}
+
+# numeric type that may stand in for t (integer and longint mix freely with -l)
+function ntype(t) {
+  if (long && (t == "i" || t == "l") && chance(0.25)) return t == "i" ? "l" : "i";
+  return t;
+}
+
+function literal(t,  r) {
+  r = rand();
+  if (t == "i") {
+    if (r < 0.1) return "2147483647";
+    if (r < 0.25) return "(-" pick(1000) ")";
+    return pick(100);
+  }
+  if (t == "l") {
+    if (r < 0.1) return "9223372036854775807L";
+    if (r < 0.2) return "3000000" sprintf("%03d", pick(1000)) "L";
+    if (r < 0.35) return "(-" pick(100000) "L)";
+    return pick(100000) "L";
+  }
+  if (t == "b") return r < 0.5 ? "true" : "false";
+  return "\x27" sprintf("%c", 97 + pick(26)) "\x27";
+}
+
+# the constant that replaces an omitted expression of type t
+function unit(t) {
+  if (t == "i") return "1";
+  if (t == "l") return "1L";
+  if (t == "b") return "true";
+  return "\x27x\x27";
+}
+
+function omitted(id) { return (id in drop); }
+
+# array index: a constant or the counter of an enclosing loop; bound is the dimension
+function subscript(bound,  k) {
+  if (active > 0 && chance(0.6)) {
+    k = pick(active);
+    if (cbound[k] <= bound) return cname[k];
+  }
+  return pick(bound < 4 ? bound : 4);
+}
+
+# element of array k
+function element(k) {
+  if (adims[k] == 2) return aname[k] "[" subscript(4) "][" subscript(6) "]";
+  return aname[k] "[" subscript(asize[k]) "]";
+}
+
+# a readable array of element type t, or -1
+function rarray(t,  n, k, c) {
+  n = 0;
+  for (k=0; k<narr; k++) if (atype[k] == t) c[n++] = k;
+  return n ? c[pick(n)] : -1;
+}
+
+# an assignable array of element type t, or -1
+function warray(t,  n, k, c) {
+  n = 0;
+  for (k=0; k<narr; k++) if (atype[k] == t && awrite[k]) c[n++] = k;
+  return n ? c[pick(n)] : -1;
+}
+
+function leaf(t,  k, r) {
+  r = rand();
+  if (r < 0.45 && nvar[t] > 0) return vname[t, pick(nvar[t])];
+  if (r < 0.6 && (k = rarray(t)) >= 0) return element(k);
+  return literal(t);
+}
+
+# call of an earlier function returning t (pure context) or procedure (statement), or ""
+function callable(ret,  n, j, c) {
+  n = 0;
+  for (j=0; j<cur; j++) {
+    if (ret == "" && pret[j] != "") continue;
+    if (ret != "" && pret[j] != ret) continue;
+    if (pure && !ppure[j]) continue;
+    if (cost + mult*pcost[j] > budget()) continue;
+    c[n++] = j;
+  }
+  return n ? c[pick(n)] : -1;
+}
+
+function args(j, d,  s, k, a) {
+  s = "";
+  for (k=0; k<pnpar[j]; k++) {
+    if (ptype[j, k] == "a") a = aname[rarray1()];
+    else a = expr(ntype(ptype[j, k]), d);
+    s = s (k ? ", " : "") a;
+  }
+  return s;
+}
+
+# a one-dimensional integer array that can be passed to an open array parameter
+function rarray1(  n, k, c) {
+  n = 0;
+  for (k=0; k<narr; k++) if (atype[k] == "i" && adims[k] == 1) c[n++] = k;
+  return c[pick(n)];
+}
+
+function call(j, d,  id, s) {
+  id = ++nid;
+  cost += mult*pcost[j];
+  s = pname[j] "(" args(j, d) ")";
+  if (omitted(id) || omitted(pid[j])) return "";
+  return s;
+}
+
+function binary(t, op, d,  a, b) {
+  a = expr(ntype(t), d-1);
+  b = expr(ntype(t), d-1);
+  return "(" a " " op " " b ")";
+}
+
+function expr(t, d,  id, s, r, a, b, j, op) {
+  if (d <= 0 || t == "c" || chance(0.3)) return leaf(t);
+
+  id = ++nid;
+  r = rand();
+  if (t == "i" || t == "l") {
+    if (r < 0.15) s = binary(t, "+", d);
+    else if (r < 0.3) s = binary(t, "-", d);
+    else if (r < 0.45) s = binary(t, "*", d);
+    else if (r < 0.6 && divide) {
+      a = expr(ntype(t), d-1);
+      b = expr(ntype(t), d-1);
+      s = "(" a " / ((" b " * " b ") + " (t == "l" ? "1L" : "1") "))";
+    }
+    else if (r < 0.7) s = "(-" expr(t, d-1) ")";
+    else if (r < 0.8 && (j = callable(t)) >= 0) {
+      s = call(j, d-1);
+      if (s == "") s = unit(t);
+    }
+    else s = leaf(t);
+  } else {
+    if (r < 0.4) {
+      op = pick(6);
+      op = op == 0 ? "=" : op == 1 ? "#" : op == 2 ? "<" : op == 3 ? "<=" : op == 4 ? ">" : ">=";
+      a = long && chance(0.4) ? "l" : "i";
+      s = binary(a, op, d);
+    }
+    else if (r < 0.55) s = binary("b", "&&", d);
+    else if (r < 0.7) s = binary("b", "||", d);
+    else if (r < 0.8) s = "(!(" expr("b", d-1) "))";
+    else if (r < 0.9 && (j = callable("b")) >= 0) {
+      s = call(j, d-1);
+      if (s == "") s = unit(t);
+    }
+    else s = leaf(t);
+  }
+  return omitted(id) ? unit(t) : s;
+}
+
+function write(t, e) {
+  if (t == "i") return "WriteInt(" e "); WriteLn()";
+  if (t == "l") return "WriteLong(" e "); WriteLn()";
+  if (t == "c") return "WriteChar(" e "); WriteLn()";
+  return "if (" e ") then WriteChar(\x27T\x27) else WriteChar(\x27F\x27) end; WriteLn()";
+}
+
+function assignment(  t, k, lhs) {
+  t = rtype();
+  if (chance(0.3) && (k = warray(t)) >= 0) lhs = element(k);
+  else if (nasg[t] > 0) lhs = wname[t, pick(nasg[t])];
+  else return "";
+  return lhs " := " expr(ntype(t), edepth);
+}
+
+# statement at nesting level d with indentation ind
+function statement(d, ind,  id, s, r, t, j, c, n, body, m) {
+  id = ++nid;
+  cost += mult;
+  r = rand();
+  if (r < 0.35) s = assignment();
+  else if (r < 0.5 && !pure) {
+    t = rtype();
+    s = write(t, expr(t, edepth));
+  }
+  else if (r < 0.65 && d < depth) {
+    s = "if (" expr("b", edepth) ") then\n";
+    body = sequence(d+1, ind+1);
+    if (body != "") s = s body "\n";
+    if (chance(0.5)) {
+      body = sequence(d+1, ind+1);
+      s = s tab(ind) "else\n" (body != "" ? body "\n" : "");
+    }
+    s = s tab(ind) "end";
+  }
+  else if (r < 0.8 && d < depth && active < depth) {
+    c = cname[active];
+    n = 1 + pick(4);
+    cbound[active++] = n;
+    m = mult; mult *= n;
+    body = sequence(d+1, ind+1);
+    mult = m; active--;
+    s = c " := 0;\n" tab(ind) "while (" c " < " n ") do\n";
+    if (body != "") s = s body ";\n";
+    s = s tab(ind+1) c " := " c " + 1\n" tab(ind) "end";
+  }
+  else if (!pure && (j = callable("")) >= 0) s = call(j, edepth);
+  else s = assignment();
+
+  return omitted(id) ? "" : s;
+}
+
+function sequence(d, ind,  n, k, s, r) {
+  n = 1 + pick(stmts);
+  r = "";
+  for (k=0; k<n; k++) {
+    s = statement(d, ind);
+    if (s != "") r = r (r != "" ? ";\n" : "") tab(ind) s;
+  }
+  return r;
+}
+
+# scope helpers: add a scalar variable (assignable or not) or an array
+function addvar(t, name, w) {
+  vname[t, nvar[t]++] = name;
+  if (w) wname[t, nasg[t]++] = name;
+}
+
+function addarray(name, t, dims, size, w) {
+  aname[narr] = name; atype[narr] = t; adims[narr] = dims; asize[narr] = size;
+  awrite[narr++] = w;
+}
+
+function clearscope(  t) {
+  split("i l b c", ts, " ");
+  for (t in ts) { nvar[ts[t]] = 0; nasg[ts[t]] = 0; }
+  narr = 0; active = 0; cost = 0; mult = 1;
+}
+
+# globals visible in procedure bodies (w: assignable)
+function globals(w) {
+  addvar("i", "gi0", w); addvar("i", "gi1", w); addvar("i", "gi2", w);
+  if (long) { addvar("l", "gl0", w); addvar("l", "gl1", w); }
+  addvar("b", "gb0", w); addvar("c", "gc0", w);
+  addarray("A", "i", 1, 8, w);
+  addarray("B", "i", 2, 0, w);
+  if (long) addarray("L", "l", 1, 8, w);
+}
+
+function procedure(j,  np, k, t, nl, decl, init, body, s, lt, cnts) {
+  pid[j] = ++nid;
+  pret[j] = chance(0.5) ? rtype() : "";
+  if (pret[j] == "c") pret[j] = "i";
+  ppure[j] = pret[j] != "";
+  pname[j] = (ppure[j] ? "f" : "p") j;
+
+  clearscope();
+  pure = ppure[j];
+  globals(!pure);
+  for (k=0; k<depth; k++) cname[k] = "i" k;
+
+  np = 1 + pick(3);
+  decl = "";
+  for (k=0; k<np; k++) {
+    t = rtype();
+    ptype[j, k] = t;
+    addvar(t, "x" k, 1);
+    decl = decl (k ? "; " : "") "x" k ": " tname(t);
+  }
+  if (chance(0.4)) {
+    ptype[j, np] = "a";
+    addarray("P", "i", 1, 4, !pure);
+    decl = decl "; P: integer[]";
+    np++;
+  }
+  pnpar[j] = np;
+
+  nl = 1 + pick(4);
+  s = ""; init = "";
+  for (k=0; k<nl; k++) {
+    t = rtype();
+    lt[t] = lt[t] (lt[t] != "" ? ", " : "") "v" k;
+    addvar(t, "v" k, 1);
+    init = init (k ? ";\n" : "") tab(1) "v" k " := " literal(t);
+  }
+  cnts = "";
+  for (k=0; k<depth; k++) {
+    cnts = cnts (k ? ", " : "") "i" k;
+    init = init ";\n" tab(1) "i" k " := 0";
+  }
+
+  body = sequence(0, 1);
+  if (ppure[j]) body = body (body != "" ? ";\n" : "") tab(1) "return " expr(pret[j], edepth);
+  pcost[j] = cost + 1;
+
+  if (omitted(pid[j])) return "";
+
+  s = (ppure[j] ? "function " : "procedure ") pname[j] "(" decl ")";
+  if (ppure[j]) s = s ": " tname(pret[j]);
+  s = s ";\nvar ";
+  for (t in lt) s = s lt[t] ": " tname(t) ";\n    ";
+  s = s cnts ": integer;\nbegin\n" init;
+  if (body != "") s = s ";\n" body;
+  return s "\nend " pname[j] ";\n\n";
+}
+
+function dump(  s, k) {
+  s = "";
+  for (k=0; k<3; k++) s = s "  WriteInt(gi" k "); WriteChar(\x27 \x27);\n";
+  if (long) for (k=0; k<2; k++) s = s "  WriteLong(gl" k "); WriteChar(\x27 \x27);\n";
+  s = s "  if (gb0) then WriteChar(\x27T\x27) else WriteChar(\x27F\x27) end;\n";
+  s = s "  WriteChar(gc0); WriteLn();\n";
+  s = s "  c0 := 0;\n  while (c0 < 8) do\n    WriteInt(A[c0]); WriteChar(\x27 \x27);\n";
+  if (long) s = s "    WriteLong(L[c0]); WriteChar(\x27 \x27);\n";
+  s = s "    c0 := c0 + 1\n  end;\n  WriteLn();\n";
+  s = s "  c0 := 0;\n  while (c0 < 4) do\n    c1 := 0;\n    while (c1 < 6) do\n";
+  s = s "      WriteInt(B[c0][c1]); WriteChar(\x27 \x27);\n      c1 := c1 + 1\n    end;\n";
+  s = s "    c0 := c0 + 1\n  end;\n  WriteLn()\n";
+  return s;
+}
+
+BEGIN {
+  srand(seed);
+  n = split(omit, ids, ",");
+  for (k=1; k<=n; k++) {
+    if (split(ids[k], r, "-") == 2) for (e=r[1]; e<=r[2]; e++) drop[e] = 1;
+    else drop[ids[k]] = 1;
+  }
+  nid = 0;
+
+  text = "";
+  for (cur=0; cur<procs; cur++) text = text procedure(cur);
+
+  clearscope();
+  pure = 0;
+  globals(1);
+  ncnt = depth < 2 ? 2 : depth;
+  for (k=0; k<ncnt; k++) cname[k] = "c" k;
+  init = "";
+  for (k=0; k<3; k++) init = init "  gi" k " := " literal("i") ";\n";
+  if (long) for (k=0; k<2; k++) init = init "  gl" k " := " literal("l") ";\n";
+  init = init "  gb0 := " literal("b") ";\n  gc0 := " literal("c") ";\n";
+  body = sequence(0, 1);
+
+  print "//";
+  print "// fuzz";
+  print "//";
+  printf "// random program: genprog.sh -s %d -p %d -n %d -d %d -e %d%s%s\n", \
+         seed, procs, stmts, depth, edepth, (long ? " -l" : ""), (divide ? "" : " -r");
+  if (omit != "") print "//   omitted: " omit;
+  print "// elements: " nid;
+  print "//";
+  print "";
+  print "module fuzz;";
+  print "";
+  print "var gi0, gi1, gi2: integer;";
+  if (long) print "    gl0, gl1: longint;";
+  print "    gb0: boolean;";
+  print "    gc0: char;";
+  print "    A: integer[8];";
+  print "    B: integer[4][6];";
+  if (long) print "    L: longint[8];";
+  s = "";
+  for (k=0; k<ncnt; k++) s = s (k ? ", " : "") "c" k;
+  print "    " s ": integer;";
+  print "";
+  printf "%s", text;
+  print "begin";
+  printf "%s", init;
+  if (body != "") print body ";";
+  printf "%s", dump();
+  print "end fuzz.";
+}'
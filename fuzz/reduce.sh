@@ -0,0 +1,102 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 test case reduction
+#
+# Minimizes a random program on which a configuration of run.sh disagrees with the baseline (the
+# IR interpreter without optimizations) and writes the minimized program to standard output.
+# The program is identified by its genprog.sh options; reduction removes elements of the program
+# with genprog.sh -x (first in large chunks, then one by one) as long as the disagreement persists.
+# If the baseline itself fails, the program is minimized as long as the baseline fails the same way.
+#
+# usage: reduce.sh CONFIGURATION [GENPROG OPTIONS]...
+#   CONFIGURATION  one of the configurations of run.sh (interp to reduce a failing baseline)
+#
+# The compilers can be overridden with the SNUPLC and REFERENCE environment variables.
+#
+
+FUZZ=$(cd "$(dirname "$0")" && pwd)
+ROOT=$FUZZ/../snuplc
+SNUPLC=${SNUPLC:-$ROOT/snuplc}
+REFERENCE=${REFERENCE:-$ROOT/reference/snuplc}
+LIMIT=${LIMIT:-10}
+
+if [ $# -lt 1 ]; then
+  sed -n '/^# usage/,/^#$/p' "$0" | sed 's/^# \{0,1\}//' >&2
+  exit 1
+fi
+CONFIG=$1
+shift
+GENFLAGS=("$@")
+
+. "$FUZZ/config.sh"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# generate <omitted elements> <file>
+generate() {
+  "$FUZZ/genprog.sh" "${GENFLAGS[@]}" ${1:+-x "$1"} > "$2"
+}
+
+# interesting <module>: does the module still show the failure?
+interesting() {
+  build_and_run interp "$1" "$WORK/interp"
+  if [ "$CONFIG" = interp ]; then
+    [ "$(status "$WORK/interp")" = "$EXPECT" ]
+    return
+  fi
+  [ "$(status "$WORK/interp")" = ok ] || return 1
+  build_and_run "$CONFIG" "$1" "$WORK/$CONFIG"
+  [ "$(status "$WORK/$CONFIG")" != "n/a" ] && ! cmp -s "$WORK/interp.result" "$WORK/$CONFIG.result"
+}
+
+generate "" "$WORK/best.mod" || exit 1
+build_and_run interp "$WORK/best.mod" "$WORK/interp"
+EXPECT=$(status "$WORK/interp")
+if ! interesting "$WORK/best.mod"; then
+  echo "reduce.sh: the program does not fail in configuration $CONFIG" >&2
+  exit 1
+fi
+
+n=$(sed -n 's|^// elements: ||p' "$WORK/best.mod")
+declare -A omitted
+tests=0
+
+# ranges <element>...: the elements as a sorted list of ranges for genprog.sh -x
+ranges() {
+  printf "%s\n" "$@" | sort -n | awk '
+    function flush() { if (n) s = s (s != "" ? "," : "") (lo == hi ? lo : lo "-" hi); }
+    n && $1 == hi + 1 { hi = $1; next }
+    { flush(); lo = hi = $1; n = 1 }
+    END { flush(); print s }'
+}
+
+# try <candidate elements>: omit them if the failure persists
+try() {
+  local e cand
+  cand=$(ranges "${!omitted[@]}" "$@")
+  generate "$cand" "$WORK/cand.mod"
+  # omitting elements nested in omitted ones does not change the program
+  cmp -s "$WORK/cand.mod" "$WORK/best.mod" && return 1
+  tests=$((tests + 1))
+  interesting "$WORK/cand.mod" || return 1
+  for e in "$@"; do omitted[$e]=1; done
+  mv "$WORK/cand.mod" "$WORK/best.mod"
+}
+
+chunk=$(( (n + 1) / 2 ))
+while [ $chunk -ge 1 ]; do
+  progress=0
+  for ((start=1; start<=n; start+=chunk)); do
+    elems=()
+    for ((e=start; e<start+chunk && e<=n; e++)); do
+      [ -n "${omitted[$e]}" ] || elems+=($e)
+    done
+    [ ${#elems[@]} -gt 0 ] && try "${elems[@]}" && progress=1
+  done
+  echo "chunk $chunk: $(grep -c '' "$WORK/best.mod") lines, $tests tests" >&2
+  # repeat single-element passes until nothing can be removed any more
+  if [ $chunk -gt 1 ]; then chunk=$((chunk / 2)); elif [ $progress -eq 0 ]; then break; fi
+done
+
+cat "$WORK/best.mod"
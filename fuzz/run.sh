@@ -0,0 +1,121 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 differential testing
+#
+# Generates random programs with genprog.sh and builds and runs each of them in several
+# configurations:
+#   interp     our snuplc, IR interpreter without optimizations (the baseline)
+#   interp-O2  our snuplc, IR interpreter after the -O2 passes
+#   O0 O1 O2   our snuplc, native code at the respective optimization level
+#   reference  the reference compiler (only if it accepts the program; it does not support
+#              mixing integer and longint operands)
+# Every compilation and run happens in a fresh directory in a child process with limited CPU time,
+# memory, and output size and, if unprivileged user namespaces are available, without network
+# access. A configuration fails if its status (ok, compile error, timeout, or signal) or its output
+# differs from the baseline. Failing programs are minimized with reduce.sh and saved together with
+# the outputs of all configurations. Programs on which only the reference compiler disagrees are
+# saved as well but do not count as failures (the reference compiler has known bugs of its own).
+#
+# Odd seeds mix integer and longint operands (genprog.sh -l); even seeds neither mix nor divide
+# (genprog.sh -r) and are therefore also compared against the reference compiler.
+#
+# usage: run.sh [-n PROGRAMS] [-s SEED] [-t SECONDS] [-o DIR] [-q] [GENPROG OPTIONS]...
+#   -n PROGRAMS  number of programs (default: 100)
+#   -s SEED      seed of the first program (default: 1)
+#   -t SECONDS   time limit for each compilation and run (default: 10)
+#   -o DIR       directory for failing programs (default: failures)
+#   -q           do not minimize failing programs
+#   remaining options are passed to genprog.sh (e.g., -p 8 -d 4)
+#
+# The compilers can be overridden with the SNUPLC and REFERENCE environment variables.
+#
+
+FUZZ=$(cd "$(dirname "$0")" && pwd)
+ROOT=$FUZZ/../snuplc
+export SNUPLC=${SNUPLC:-$ROOT/snuplc}
+export REFERENCE=${REFERENCE:-$ROOT/reference/snuplc}
+
+PROGRAMS=100
+SEED=1
+OUT=failures
+REDUCE=1
+export LIMIT=10
+while [ $# -gt 0 ]; do
+  case "$1" in
+    -n) PROGRAMS=$2; shift 2 ;;
+    -s) SEED=$2; shift 2 ;;
+    -t) LIMIT=$2; shift 2 ;;
+    -o) OUT=$2; shift 2 ;;
+    -q) REDUCE=0; shift ;;
+    -h) sed -n '/^# usage/,/^#$/p' "$0" | sed 's/^# \{0,1\}//' >&2; exit 1 ;;
+    *)  break ;;
+  esac
+done
+GENFLAGS=("$@")
+
+. "$FUZZ/config.sh"
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+echo "SnuPL/2 differential testing: $PROGRAMS programs from seed $SEED," \
+     "genprog.sh options: ${GENFLAGS[*]:-(none)}"
+[ -n "$UNSHARE" ] || echo "  (user namespaces not available: programs run with network access)"
+
+failed=0
+refonly=0
+unchecked=0
+for seed in $(seq "$SEED" $((SEED + PROGRAMS - 1))); do
+  flags=(-s "$seed" "${GENFLAGS[@]}")
+  if [ $((seed % 2)) -eq 1 ]; then flags+=(-l); else flags+=(-r); fi
+
+  dir=$WORK/$seed
+  mkdir -p "$dir"
+  "$FUZZ/genprog.sh" "${flags[@]}" > "$dir/fuzz.mod" || exit 1
+
+  for c in $CONFIGS; do
+    build_and_run "$c" "$dir/fuzz.mod" "$dir/$c"
+  done
+
+  diffs=$(compare "$dir")
+  [ "$(status "$dir/reference")" = "n/a" ] && unchecked=$((unchecked + 1))
+  if [ -z "$diffs" ]; then
+    rm -rf "$dir"
+    continue
+  fi
+
+  # the reference compiler has bugs of its own; disagreements with it alone are listed separately
+  if [ "$diffs" = reference ]; then
+    refonly=$((refonly + 1))
+  else
+    failed=$((failed + 1))
+  fi
+  mkdir -p "$OUT"
+  save=$OUT/fuzz-$seed
+  rm -rf "$save"
+  mkdir -p "$save"
+  cp "$dir/fuzz.mod" "$save/"
+  for c in $CONFIGS; do cp "$dir/$c.result" "$save/$c.result"; done
+
+  echo "  seed $seed: $diffs"
+  for c in $diffs; do
+    printf "    %-10s %s\n" "$c" "$(status "$dir/$c")"
+  done
+  printf "    %-10s %s\n" interp "$(status "$dir/interp")"
+
+  if [ $REDUCE -eq 1 ]; then
+    # minimize against the first failing configuration
+    set -- $diffs
+    if "$FUZZ/reduce.sh" "$1" "${flags[@]}" > "$save/fuzz.min.mod" 2> "$save/reduce.log"; then
+      echo "    minimized: $save/fuzz.min.mod ($(grep -c '' "$save/fuzz.min.mod") lines)"
+    else
+      echo "    minimization failed, see $save/reduce.log"
+      rm -f "$save/fuzz.min.mod"
+    fi
+  fi
+  rm -rf "$dir"
+done
+
+echo "$PROGRAMS programs, $failed failing, $refonly disagreeing with the reference compiler only," \
+     "$unchecked not compared against the reference compiler"
+[ $failed -eq 0 ]
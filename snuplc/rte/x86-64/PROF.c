@@ -0,0 +1,108 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL AMD64 profiling support
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "PROF.h"
+
+static SnuplProfile *profile = NULL;
+
+/// @brief return the name of the profile file
+static const char* ProfileFile(char *buf, size_t size)
+{
+  const char *fn = getenv("SNUPL_PROFILE");
+
+  if ((fn != NULL) && (fn[0] != '\0')) return fn;
+
+  snprintf(buf, size, "%s.prof", profile->module);
+  return buf;
+}
+
+/// @brief accumulate the counters of an existing profile with identical keys
+static void MergeProfile(const char *fn)
+{
+  FILE *f = fopen(fn, "r");
+  char line[1024], key[1024];
+  const char *k = profile->keys;
+  unsigned long long count, *acc;
+  long long i = 0;
+
+  if (f == NULL) return;
+
+  acc = calloc(profile->n, sizeof(unsigned long long));
+  if (acc == NULL) { fclose(f); return; }
+
+  while ((i < profile->n) && (fgets(line, sizeof(line), f) != NULL)) {
+    if (line[0] == '#') continue;
+    if ((sscanf(line, "%llu %1023s", &count, key) != 2) || (strcmp(key, k) != 0)) break;
+    acc[i++] = count;
+    k += strlen(k) + 1;
+  }
+
+  // only merge if the profile belongs to the same program
+  if ((i == profile->n) && (fgets(line, sizeof(line), f) == NULL)) {
+    for (i = 0; i < profile->n; i++) profile->counter[i] += acc[i];
+  }
+
+  free(acc);
+  fclose(f);
+}
+
+/// @brief write the profile at program exit
+static void DumpProfile(void)
+{
+  char buf[1024];
+  const char *fn = ProfileFile(buf, sizeof(buf));
+  const char *k = profile->keys;
+  long long i;
+  FILE *f;
+
+  MergeProfile(fn);
+
+  f = fopen(fn, "w");
+  if (f == NULL) {
+    fprintf(stderr, "cannot write profile '%s'.\n", fn);
+    return;
+  }
+
+  fprintf(f, "# SnuPL/2 execution profile: %s\n", profile->module);
+  for (i = 0; i < profile->n; i++) {
+    fprintf(f, "%llu %s\n", profile->counter[i], k);
+    k += strlen(k) + 1;
+  }
+
+  fclose(f);
+}
+
+void __snupl_profile_init(SnuplProfile *p)
+{
+  if (profile == NULL) atexit(DumpProfile);
+  profile = p;
+}
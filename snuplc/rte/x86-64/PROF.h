@@ -0,0 +1,45 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL AMD64 profiling support
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+/// @brief execution profile descriptor emitted by the compiler (--instrument)
+///
+/// @a keys contains @a n consecutive NUL-terminated counter keys, one for each
+/// element of @a counter.
+typedef struct {
+  long long n;                      ///< number of counters
+  unsigned long long *counter;      ///< counters
+  const char *keys;                 ///< counter keys
+  const char *module;               ///< module name
+} SnuplProfile;
+
+/// @brief register the profile @a p of the running program
+///
+/// The counters are written to the file named by the environment variable
+/// SNUPL_PROFILE (default: <module>.prof) when the program exits. Counters of
+/// an existing profile with identical keys are accumulated.
+void __snupl_profile_init(SnuplProfile *p);
@@ -0,0 +1,80 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL arena allocator
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <cstdint>
+
+#include "arena.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CArena
+//
+CArena::CArena(size_t blocksize)
+  : _blocksize(blocksize), _cur(NULL), _end(NULL), _size(0)
+{
+}
+
+CArena::~CArena(void)
+{
+  for (auto it = _finalizers.rbegin(); it != _finalizers.rend(); it++)
+    it->destroy(it->object);
+
+  for (char *b : _blocks) delete [] b;
+}
+
+void* CArena::Allocate(size_t size, size_t align)
+{
+  assert((align & (align-1)) == 0);
+
+  _size += size;
+
+  // large requests get a block of their own; the current block remains in use
+  if (size + align > _blocksize / 4) {
+    char *b = new char[size + align];
+    _blocks.push_back(b);
+    return Align(b, align);
+  }
+
+  char *p = _cur != NULL ? Align(_cur, align) : NULL;
+  if ((p == NULL) || (p + size > _end)) {
+    char *b = new char[_blocksize];
+    _blocks.push_back(b);
+    _end = b + _blocksize;
+    p = Align(b, align);
+  }
+
+  _cur = p + size;
+  return p;
+}
+
+char* CArena::Align(char *p, size_t align)
+{
+  return (char*)(((uintptr_t)p + align-1) & ~(uintptr_t)(align-1));
+}
@@ -0,0 +1,117 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL arena allocator
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_ARENA_H__
+#define __SnuPL_ARENA_H__
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief arena (bump) allocator
+///
+/// Hands out memory from large blocks by advancing a pointer. Individual objects are never freed;
+/// all memory is released at once when the arena is destroyed. Objects created with New() whose
+/// type has a non-trivial destructor are destroyed (in reverse order of creation) before the
+/// memory is released. Objects in an arena must therefore not delete each other.
+///
+class CArena {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    ///
+    /// @param blocksize size of the blocks requested from the system
+    CArena(size_t blocksize=64*1024);
+
+    /// @brief destructor; destroys all objects and releases all memory
+    ~CArena(void);
+
+    /// @}
+
+    /// @name allocation
+    /// @{
+
+    /// @brief allocate uninitialized memory
+    ///
+    /// @param size size in bytes
+    /// @param align alignment (a power of two)
+    /// @retval pointer to the memory
+    void* Allocate(size_t size, size_t align=alignof(max_align_t));
+
+    /// @brief construct an object in the arena
+    ///
+    /// @param args constructor arguments
+    /// @retval pointer to the new object; owned by the arena
+    template <typename T, typename... Args>
+    T* New(Args&&... args)
+    {
+      T *o = new (Allocate(sizeof(T), alignof(T))) T(forward<Args>(args)...);
+      if (!is_trivially_destructible<T>::value) _finalizers.push_back({ Destroy<T>, o });
+      return o;
+    }
+
+    /// @brief return the number of bytes handed out so far
+    size_t GetSize(void) const { return _size; };
+
+    /// @}
+
+  private:
+    /// @brief round @a p up to a multiple of @a align
+    static char* Align(char *p, size_t align);
+
+    /// @brief destroy an object of type @a T
+    template <typename T>
+    static void Destroy(void *o) { static_cast<T*>(o)->~T(); };
+
+    /// @brief pending destructor call
+    struct SFinalizer {
+      void (*destroy)(void*);       ///< destructor of the object
+      void *object;                 ///< object
+    };
+
+    size_t _blocksize;              ///< default block size
+    vector<char*> _blocks;          ///< allocated blocks
+    char *_cur;                     ///< next free byte in the current block
+    char *_end;                     ///< end of the current block
+    size_t _size;                   ///< bytes handed out
+    vector<SFinalizer> _finalizers; ///< objects to destroy, in order of creation
+
+    // arenas own their memory
+    CArena(const CArena&) = delete;
+    CArena& operator=(const CArena&) = delete;
+};
+
+
+#endif // __SnuPL_ARENA_H__
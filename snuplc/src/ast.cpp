@@ -48,7 +48,7 @@ using namespace std;
 //--------------------------------------------------------------------------------------------------
 // CAstNode
 //
-int CAstNode::_global_id = 0;
+thread_local int CAstNode::_global_id = 0;
 
 CAstNode::CAstNode(CToken token)
   : _token(token), _addr(NULL)
@@ -122,8 +122,8 @@ CAstScope::CAstScope(CToken t, const string name, CAstScope *parent)
 
 CAstScope::~CAstScope(void)
 {
+  // the statement sequence and subscopes are owned by the module's arena
   delete _symtab;
-  delete _statseq;
   delete _cb;
 }
 
@@ -263,6 +263,15 @@ CAstModule::CAstModule(CToken t, const string name)
   SetSymbolTable(new CSymtab());
 }
 
+CAstModule::~CAstModule(void)
+{
+}
+
+CArena* CAstModule::GetArena(void)
+{
+  return &_arena;
+}
+
 CSymbol* CAstModule::CreateVar(const string ident, const CType *type)
 {
   return new CSymGlobal(ident, type);
@@ -329,7 +338,6 @@ CAstStatement::CAstStatement(CToken token)
 
 CAstStatement::~CAstStatement(void)
 {
-  delete _next;
 }
 
 void CAstStatement::SetNext(CAstStatement *next)
@@ -655,7 +663,7 @@ void CAstStatWhile::toDot(ostream &out, int indent) const
 // CAstExpression
 //
 CAstExpression::CAstExpression(CToken t)
-  : CAstNode(t)
+  : CAstNode(t), _folded(-1)
 {
 }
 
@@ -868,11 +876,8 @@ const CSymProc* CAstFunctionCall::GetSymbol(void) const
 
 void CAstFunctionCall::AddArg(CAstExpression *arg)
 {
-  // Pass arrays only as pointers
-  if (arg->GetType()->IsArray()) {
-    AddArg(new CAstSpecialOp(arg->GetToken(), opAddress, arg));
-    return;
-  }
+  // arrays are passed as pointers
+  assert(!arg->GetType()->IsArray());
 
   _arg.push_back(arg);
 }
@@ -1121,7 +1126,7 @@ string CAstConstant::dotAttr(void) const
 //--------------------------------------------------------------------------------------------------
 // CAstStringConstant
 //
-int CAstStringConstant::_idx = 0;
+thread_local int CAstStringConstant::_idx = 0;
 
 CAstStringConstant::CAstStringConstant(CToken t, const string value, CAstScope *s)
   : CAstOperand(t)
@@ -1131,7 +1136,10 @@ CAstStringConstant::CAstStringConstant(CToken t, const string value, CAstScope *
 
   _type = tm->GetArray(strlen(CToken::unescape(value).c_str())+1,
                        tm->GetChar());
-  _value = new CDataInitString(value);
+  // the string data lives as long as the module
+  CAstScope *m = s;
+  while (m->GetParent() != NULL) m = m->GetParent();
+  _value = ((CAstModule*)m)->GetArena()->New<CDataInitString>(value);
 
   // in case of name clashes we simply iterate until we find a
   // name that has not yet been used
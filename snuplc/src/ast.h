@@ -42,6 +42,7 @@
 #include <map>
 #include <vector>
 
+#include "arena.h"
 #include "scanner.h"
 #include "type.h"
 #include "symtab.h"
@@ -57,10 +58,14 @@ class CAstDesignator;
 //--------------------------------------------------------------------------------------------------
 /// @brief AST base node
 ///
-/// base node class for all node types in the AST
+/// base node class for all node types in the AST. With the exception of the module node, nodes
+/// are allocated in the arena of their module (see CAstModule::GetArena()) and are destroyed
+/// together with the module; nodes thus never delete their children.
 ///
 
 class CAstNode {
+  friend class CContext;
+
   public:
     /// @name constructors/destructors
     /// @{
@@ -129,7 +134,7 @@ class CAstNode {
                                     ///< the creation of the node. Used for
                                     ///< error reporting purposes)
     int        _id;                 ///< id of the node
-    static int _global_id;          ///< holds the (global) next id
+    static thread_local int _global_id; ///< holds the next id (per thread)
 
   protected:
     CTacAddr   *_addr;              ///< result of this node in three-address
@@ -287,6 +292,17 @@ class CAstModule : public CAstScope {
     /// @param name module name
     CAstModule(CToken t, const string name);
 
+    /// @brief destructor; destroys all nodes in the module's arena
+    virtual ~CAstModule(void);
+
+    /// @}
+
+    /// @name memory management
+    /// @{
+
+    /// @brief return the arena holding the nodes of this module
+    CArena* GetArena(void);
+
     /// @}
 
     /// @name scope manipulation/querying
@@ -305,6 +321,9 @@ class CAstModule : public CAstScope {
     virtual string dotAttr(void) const;
 
     /// @}
+
+  private:
+    CArena _arena;                  ///< arena holding all other nodes of the module
 };
 
 
@@ -848,6 +867,19 @@ class CAstStatWhile : public CAstStatement {
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief value of a constant expression
+///
+/// The type tags the value: boolean, char, integer and longint constants are held in @a value,
+/// string constants refer to their data initializer.
+///
+struct SConstValue {
+  const CType *type;                ///< type of the value
+  long long value;                  ///< value of scalar constants
+  const CDataInitializer *data;     ///< data of string constants (NULL for scalars)
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief AST expression node
 ///
@@ -899,8 +931,19 @@ class CAstExpression : public CAstNode {
     /// @{
 
     /// @brief performs numerical evaluation of a symbolic constant.
-    /// @retval NULL catch-all for classes that do not support evaluation
-    virtual const CDataInitializer* Evaluate(void) const;
+    ///
+    /// The value is computed once (see Fold()) and cached in the node; subexpressions are thus
+    /// folded at most once no matter how often a constant expression is evaluated.
+    ///
+    /// @retval SConstValue* value of the expression (owned by the node)
+    /// @retval NULL if numerical evaluation cannot be performed
+    const SConstValue* Evaluate(void) const;
+
+    /// @brief compute the value of the expression (called by Evaluate())
+    /// @param v (out) value of the expression
+    /// @retval true if the expression is constant
+    /// @retval false catch-all for classes that do not support evaluation
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -915,6 +958,8 @@ class CAstExpression : public CAstNode {
 
   private:
     bool       _parenthesized;      ///< expression was parenthesized
+    mutable signed char _folded;    ///< evaluation state (-1: not yet, 0: not constant, 1: constant)
+    mutable SConstValue _value;     ///< cached value of the expression
 };
 
 
@@ -997,9 +1042,7 @@ class CAstBinaryOp : public CAstOperation {
     /// @{
 
     /// @brief performs numerical evaluation of a binary operation
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -1086,9 +1129,7 @@ class CAstUnaryOp : public CAstOperation {
     /// @{
 
     /// @brief performs numerical evaluation of a unary operation
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -1174,18 +1215,6 @@ class CAstSpecialOp : public CAstOperation {
     /// @}
 
 
-    /// @name numerical evaluation
-    /// @{
-
-    /// @brief performs numerical evaluation of special ops. Only widening
-    ///        is supported at the moment.
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
-
-    /// @}
-
-
     /// @name output
     /// @{
 
@@ -1243,7 +1272,7 @@ class CAstFunctionCall : public CAstExpression {
     const CSymProc* GetSymbol(void) const;
 
     /// @brief add an argument
-    /// @param arg argument
+    /// @param arg argument (arrays must be passed by address, see opAddress)
     void AddArg(CAstExpression *arg);
 
     /// @brief return the number of arguments
@@ -1378,10 +1407,8 @@ class CAstDesignator : public CAstOperand {
     /// @name numerical evaluation
     /// @{
 
-    /// @brief performs numerical evaluation of a designator
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    /// @brief performs numerical evaluation of a designator (symbolic constants)
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -1478,6 +1505,15 @@ class CAstArrayDesignator : public CAstDesignator {
     /// @}
 
 
+    /// @name numerical evaluation
+    /// @{
+
+    /// @brief array elements are not constant
+    virtual bool Fold(SConstValue *v) const;
+
+    /// @}
+
+
     /// @name output
     /// @{
 
@@ -1568,9 +1604,7 @@ class CAstConstant : public CAstOperand {
     /// @{
 
     /// @brief performs numerical evaluation of a constant
-    /// @retval CDataInitializer* result of evaluation. Delete after use.
-    /// @retval NULL if numerical evaluation cannot be performed
-    virtual const CDataInitializer* Evaluate(void) const;
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -1613,6 +1647,8 @@ class CAstConstant : public CAstOperand {
 ///
 
 class CAstStringConstant : public CAstOperand {
+  friend class CContext;
+
   public:
     /// @name constructors/destructors
     /// @{
@@ -1659,8 +1695,7 @@ class CAstStringConstant : public CAstOperand {
     /// @{
 
     /// @brief performs numerical evaluation of a string constant
-    /// @retval CDataInitializer* pointer to the internal data. Do not delete!
-    virtual const CDataInitializer* Evaluate(void) const;
+    virtual bool Fold(SConstValue *v) const;
 
     /// @}
 
@@ -1690,7 +1725,7 @@ class CAstStringConstant : public CAstOperand {
 
 
   private:
-    static int       _idx;          ///< static counter
+    static thread_local int _idx;   ///< static counter (per thread)
     const CType     *_type;         ///< constant type
     CDataInitString *_value;        ///< data initializer (holds string data)
     CSymGlobal      *_sym;          ///< symbol holding the string
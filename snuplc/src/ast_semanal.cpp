@@ -30,6 +30,7 @@
 
 #include <iostream>
 #include <cassert>
+#include <climits>
 #include <cstring>
 
 #include <typeinfo>
@@ -272,9 +273,15 @@ bool CAstStatWhile::TypeCheck(CToken *t, string *msg)
 //--------------------------------------------------------------------------------------------------
 // CAstExpression
 //
-const CDataInitializer* CAstExpression::Evaluate(void) const
+const SConstValue* CAstExpression::Evaluate(void) const
 {
-  return NULL;
+  if (_folded < 0) _folded = Fold(&_value) ? 1 : 0;
+  return _folded ? &_value : NULL;
+}
+
+bool CAstExpression::Fold(SConstValue *v) const
+{
+  return false;
 }
 
 
@@ -389,100 +396,63 @@ const CType* CAstBinaryOp::GetType(void) const
   }
 }
 
-const CDataInitializer* CAstBinaryOp::Evaluate(void) const
+bool CAstBinaryOp::Fold(SConstValue *v) const
 {
-  const CDataInitializer *left = GetLeft()->Evaluate();
-  const CDataInitializer *right = GetRight()->Evaluate();
-  if (!left || !right)
-    return NULL;
+  const SConstValue *left = GetLeft()->Evaluate();
+  const SConstValue *right = GetRight()->Evaluate();
+  if ((left == NULL) || (right == NULL))
+    return false;
+
+  CTypeManager *tm = CTypeManager::Get();
 
-  // pre-cast all possible values, nonmatching combinations will be NULL
-  const CDataInitBoolean *boolLeft = dynamic_cast<const CDataInitBoolean *>(left);
-  const CDataInitBoolean *boolRight = dynamic_cast<const CDataInitBoolean *>(right);
-  const CDataInitInteger *intLeft = dynamic_cast<const CDataInitInteger *>(left);
-  const CDataInitInteger *intRight = dynamic_cast<const CDataInitInteger *>(right);
-  const CDataInitLongint *longLeft = dynamic_cast<const CDataInitLongint *>(left);
-  const CDataInitLongint *longRight = dynamic_cast<const CDataInitLongint *>(right);
-  const CDataInitChar *charLeft = dynamic_cast<const CDataInitChar *>(left);
-  const CDataInitChar *charRight = dynamic_cast<const CDataInitChar *>(right);
+  // arithmetic is performed in 64 bits and truncated to 32 bits unless one of the
+  // operands is a longint; unsigned arithmetic keeps overflow well-defined
+  bool wide = left->type->IsLongint() || right->type->IsLongint();
+  unsigned long long l = left->value, r = right->value;
+  long long res;
 
-  long leftv, rightv;
-  if (intLeft) leftv = intLeft->GetData();
-  if (longLeft) leftv = longLeft->GetData();
-  if (intRight) rightv = intRight->GetData();
-  if (longRight) rightv = longRight->GetData();
+  v->data = NULL;
 
   switch (GetOperation()) {
-    case opAdd:
-      if (longLeft || longRight)
-        return new CDataInitLongint(leftv+rightv);
-      return new CDataInitInteger(leftv+rightv);
-    case opSub:
-      if (longLeft || longRight)
-        return new CDataInitLongint(leftv-rightv);
-      return new CDataInitInteger(leftv-rightv);
-    case opMul:
-      if (longLeft || longRight)
-        return new CDataInitLongint(leftv*rightv);
-      return new CDataInitInteger(leftv*rightv);
+    case opAdd: res = (long long)(l + r); break;
+    case opSub: res = (long long)(l - r); break;
+    case opMul: res = (long long)(l * r); break;
     case opDiv:
-      if (longLeft || longRight)
-        return new CDataInitLongint(leftv/rightv);
-      return new CDataInitInteger(leftv/rightv);
-
-    case opAnd:
-      return new CDataInitBoolean(boolLeft->GetData() && boolRight->GetData());
-    case opOr:
-      return new CDataInitBoolean(boolLeft->GetData() || boolRight->GetData());
-
-    case opEqual:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv == rightv);
-      if (boolLeft)
-        return new CDataInitBoolean(boolLeft->GetData() == boolRight->GetData());
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() == charRight->GetData());
-
-    case opNotEqual:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv != rightv);
-      if (boolLeft)
-        return new CDataInitBoolean(boolLeft->GetData() != boolRight->GetData());
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() != charRight->GetData());
+      // the minimum value divided by -1 overflows and traps at run time; leave it unfolded
+      if (right->value == 0)
+        return false;
+      if (right->value == -1) {
+        if (left->value == (wide ? LLONG_MIN : INT_MIN)) return false;
+        res = (long long)(0 - l);
+      }
+      else res = left->value / right->value;
       break;
 
-    case opLessThan:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv < rightv);
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() < charRight->GetData());
-      break;
-    case opLessEqual:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv <= rightv);
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() <= charRight->GetData());
-      break;
-    case opBiggerThan:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv > rightv);
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() > charRight->GetData());
-      break;
-    case opBiggerEqual:
-      if (intLeft || longLeft)
-        return new CDataInitBoolean(leftv >= rightv);
-      if (charLeft)
-        return new CDataInitBoolean(charLeft->GetData() >= charRight->GetData());
-      break;
+    case opAnd:           res = left->value && right->value; break;
+    case opOr:            res = left->value || right->value; break;
+    case opEqual:         res = left->value == right->value; break;
+    case opNotEqual:      res = left->value != right->value; break;
+    case opLessThan:      res = left->value <  right->value; break;
+    case opLessEqual:     res = left->value <= right->value; break;
+    case opBiggerThan:    res = left->value >  right->value; break;
+    case opBiggerEqual:   res = left->value >= right->value; break;
 
     default:
-      // Only above three operators are binary
-      break;
+      return false;
+  }
+
+  if (IsRelOp(GetOperation()) || (GetOperation() == opAnd) || (GetOperation() == opOr)) {
+    v->type = tm->GetBool();
+    v->value = res;
+  } else if (wide) {
+    v->type = tm->GetLongint();
+    v->value = res;
+  } else {
+    v->type = tm->GetInteger();
+    v->value = (int)res;
   }
-  // TODO(nevi): throw?
-  return NULL;
+
+  return true;
 }
 
 
@@ -528,37 +498,41 @@ const CType* CAstUnaryOp::GetType(void) const
   return GetOperand()->GetType();
 }
 
-const CDataInitializer* CAstUnaryOp::Evaluate(void) const
+bool CAstUnaryOp::Fold(SConstValue *v) const
 {
-  const CDataInitializer *v = GetOperand()->Evaluate();
-  if (!v)
-    return NULL;
+  const SConstValue *op = GetOperand()->Evaluate();
+  if (op == NULL)
+    return false;
+
+  *v = *op;
 
   switch (GetOperation()) {
     case opPos:
-      return v;
+      return true;
+
     case opNeg:
-      if (GetType()->IsInteger()) {
-        const CDataInitInteger *tv = dynamic_cast<const CDataInitInteger *>(v);
-        return new CDataInitInteger(-tv->GetData());
+      if (op->type->IsInteger()) {
+        v->value = (int)(0 - (unsigned long long)op->value);
+        return true;
       }
-      if (GetType()->IsLongint()) {
-        const CDataInitLongint *tv = dynamic_cast<const CDataInitLongint *>(v);
-        return new CDataInitLongint(-tv->GetData());
+      if (op->type->IsLongint()) {
+        v->value = (long long)(0 - (unsigned long long)op->value);
+        return true;
       }
       break;
 
-    case opNot: {
-      const CDataInitBoolean *bv = dynamic_cast<const CDataInitBoolean *>(v);
-      return new CDataInitBoolean(!bv->GetData());
-    }
+    case opNot:
+      if (op->type->IsBoolean()) {
+        v->value = !op->value;
+        return true;
+      }
+      break;
 
     default:
       break;
   }
 
-  // TODO(nevi): throw?
-  return NULL;
+  return false;
 }
 
 
@@ -581,11 +555,6 @@ const CType* CAstSpecialOp::GetType(void) const
   return (CTypeManager::Get())->GetPointer(GetOperand()->GetType());
 }
 
-const CDataInitializer* CAstSpecialOp::Evaluate(void) const
-{
-  return NULL;
-}
-
 
 //--------------------------------------------------------------------------------------------------
 // CAstFunctionCall
@@ -649,9 +618,24 @@ const CType* CAstDesignator::GetType(void) const
   return GetSymbol()->GetDataType();
 }
 
-const CDataInitializer* CAstDesignator::Evaluate(void) const
+bool CAstDesignator::Fold(SConstValue *v) const
 {
-  return GetSymbol()->GetData();
+  const CDataInitializer *data = GetSymbol()->GetData();
+  if ((GetSymbol()->GetSymbolType() != stConstant) || (data == NULL))
+    return false;
+
+  v->type = GetSymbol()->GetDataType();
+  v->value = 0;
+  v->data = NULL;
+
+  if (auto *d = dynamic_cast<const CDataInitBoolean*>(data)) v->value = d->GetData();
+  else if (auto *d = dynamic_cast<const CDataInitChar*>(data)) v->value = d->GetData();
+  else if (auto *d = dynamic_cast<const CDataInitInteger*>(data)) v->value = d->GetData();
+  else if (auto *d = dynamic_cast<const CDataInitLongint*>(data)) v->value = d->GetData();
+  else if (dynamic_cast<const CDataInitString*>(data)) v->data = data;
+  else return false;
+
+  return true;
 }
 
 
@@ -708,6 +692,11 @@ const CType* CAstArrayDesignator::GetType(void) const
   return dt;
 }
 
+bool CAstArrayDesignator::Fold(SConstValue *v) const
+{
+  return false;
+}
+
 
 //--------------------------------------------------------------------------------------------------
 // CAstConstant
@@ -722,17 +711,19 @@ const CType* CAstConstant::GetType(void) const
   return _type;
 }
 
-const CDataInitializer* CAstConstant::Evaluate(void) const
+bool CAstConstant::Fold(SConstValue *v) const
 {
-  if (_type->IsBoolean())
-    return new CDataInitBoolean(_value);
-  if (_type->IsChar())
-    return new CDataInitChar(_value);
-  if (_type->IsInteger())
-    return new CDataInitInteger(_value);
-  if (_type->IsLongint())
-    return new CDataInitLongint(_value);
-  return NULL;
+  v->type = _type;
+  v->data = NULL;
+
+  // normalize the value to the width of its type
+  if (_type->IsBoolean()) v->value = (bool)_value;
+  else if (_type->IsChar()) v->value = (char)_value;
+  else if (_type->IsInteger()) v->value = (int)_value;
+  else if (_type->IsLongint()) v->value = _value;
+  else return false;
+
+  return true;
 }
 
 
@@ -749,7 +740,10 @@ const CType* CAstStringConstant::GetType(void) const
   return _type;
 }
 
-const CDataInitializer* CAstStringConstant::Evaluate(void) const
+bool CAstStringConstant::Fold(SConstValue *v) const
 {
-  return _value;
+  v->type = _type;
+  v->value = 0;
+  v->data = _value;
+  return true;
 }
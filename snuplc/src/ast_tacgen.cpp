@@ -38,6 +38,36 @@
 using namespace std;
 
 
+/// @brief convert value @a val from type @a from to type @a to
+///
+/// Integer values whose size differs are converted by an explicit opWiden or
+/// opNarrow instruction, constants are converted at compile time. Offsets added
+/// to pointers are widened to longint.
+///
+/// @param cb code block
+/// @param val value to convert
+/// @param from type of @a val
+/// @param to target type
+/// @retval the converted value (@a val if no conversion is required)
+static CTacAddr* Convert(CCodeBlock *cb, CTacAddr *val, const CType *from, const CType *to)
+{
+  if ((val == NULL) || (from == NULL) || (to == NULL) || !from->IsInt()) return val;
+
+  if (to->IsPointer()) to = CTypeManager::Get()->GetLongint();
+  if (!to->IsInt() || (from->GetSize() == to->GetSize())) return val;
+
+  if (CTacConst *c = dynamic_cast<CTacConst*>(val)) {
+    long long v = c->GetValue();
+    if (to->GetSize() == 4) v = (int)v;
+    return cb->CreateConst(v, to);
+  }
+
+  CTacTemp *dst = cb->CreateTemp(to);
+  cb->AddInstr(from->GetSize() < to->GetSize() ? opWiden : opNarrow, dst, val);
+  return dst;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CAstNode
 //
@@ -95,9 +125,10 @@ CTacAddr* CAstStatement::ToTac(CCodeBlock *cb, CTacLabel *next)
 CTacAddr* CAstStatAssign::ToTac(CCodeBlock *cb, CTacLabel *next)
 {
   CTacAddr *rhs = GetRHS()->ToTac(cb);
+  rhs = Convert(cb, rhs, GetRHS()->GetType(), GetLHS()->GetType());
   CTacAddr *lhs = GetLHS()->ToTac(cb);
-  cb->AddInstr(new CTacInstr(opAssign, lhs, rhs));
-  cb->AddInstr(new CTacInstr(opGoto, next));
+  cb->AddInstr(opAssign, lhs, rhs);
+  cb->AddInstr(opGoto, next);
   return NULL;
 }
 
@@ -108,7 +139,7 @@ CTacAddr* CAstStatAssign::ToTac(CCodeBlock *cb, CTacLabel *next)
 CTacAddr* CAstStatCall::ToTac(CCodeBlock *cb, CTacLabel *next)
 {
   GetCall()->ToTac(cb);
-  cb->AddInstr(new CTacInstr(opGoto, next));
+  cb->AddInstr(opGoto, next);
   return NULL;
 }
 
@@ -119,9 +150,11 @@ CTacAddr* CAstStatCall::ToTac(CCodeBlock *cb, CTacLabel *next)
 CTacAddr* CAstStatReturn::ToTac(CCodeBlock *cb, CTacLabel *next)
 {
   CTacAddr *val = NULL;
-  if (GetExpression())
+  if (GetExpression()) {
      val = GetExpression()->ToTac(cb);
-  cb->AddInstr(new CTacInstr(opReturn, NULL, val));
+     val = Convert(cb, val, GetExpression()->GetType(), GetScope()->GetType());
+  }
+  cb->AddInstr(opReturn, NULL, val);
   return NULL;
 }
 
@@ -144,7 +177,7 @@ CTacAddr* CAstStatIf::ToTac(CCodeBlock *cb, CTacLabel *next)
     cb->AddInstr(next);
     ifbody = ifbody->GetNext();
   }
-  cb->AddInstr(new CTacInstr(opGoto, next));
+  cb->AddInstr(opGoto, next);
 
   cb->AddInstr(lfalse);
   CAstStatement *elsebody = GetElseBody();
@@ -154,7 +187,7 @@ CTacAddr* CAstStatIf::ToTac(CCodeBlock *cb, CTacLabel *next)
     cb->AddInstr(next);
     elsebody = elsebody->GetNext();
   }
-  cb->AddInstr(new CTacInstr(opGoto, next));
+  cb->AddInstr(opGoto, next);
 
   return NULL;
 }
@@ -179,7 +212,7 @@ CTacAddr* CAstStatWhile::ToTac(CCodeBlock *cb, CTacLabel *next)
     cb->AddInstr(next);
     body = body->GetNext();
   }
-  cb->AddInstr(new CTacInstr(opGoto, lcond));
+  cb->AddInstr(opGoto, lcond);
 
   return NULL;
 }
@@ -219,20 +252,21 @@ CTacAddr* CAstBinaryOp::ToTac(CCodeBlock *cb)
     CTacTemp *dst = cb->CreateTemp(GetType());
 
     cb->AddInstr(ltrue);
-    cb->AddInstr(new CTacInstr(opAssign, dst, new CTacConst(1, GetType())));
-    cb->AddInstr(new CTacInstr(opGoto, next));
+    cb->AddInstr(opAssign, dst, cb->CreateConst(1, GetType()));
+    cb->AddInstr(opGoto, next);
     cb->AddInstr(lfalse);
-    cb->AddInstr(new CTacInstr(opAssign, dst, new CTacConst(0, GetType())));
-    cb->AddInstr(new CTacInstr(opGoto, next));
+    cb->AddInstr(opAssign, dst, cb->CreateConst(0, GetType()));
+    cb->AddInstr(opGoto, next);
     cb->AddInstr(next);
 
     return dst;
   }
 
-  CTacAddr *left = GetLeft()->ToTac(cb);
-  CTacAddr *right = GetRight()->ToTac(cb);
+  // operands are converted to the type of the result
+  CTacAddr *left = Convert(cb, GetLeft()->ToTac(cb), GetLeft()->GetType(), GetType());
+  CTacAddr *right = Convert(cb, GetRight()->ToTac(cb), GetRight()->GetType(), GetType());
   CTacTemp *dst = cb->CreateTemp(GetType());
-  cb->AddInstr(new CTacInstr(GetOperation(), dst, left, right));
+  cb->AddInstr(GetOperation(), dst, left, right);
 
   return dst;
 }
@@ -258,10 +292,12 @@ CTacAddr* CAstBinaryOp::ToTac(CCodeBlock *cb, CTacLabel *ltrue, CTacLabel *lfals
       break;
 
     default:
-      CTacAddr *laddr = left->ToTac(cb);
-      CTacAddr *raddr = right->ToTac(cb);
-      cb->AddInstr(new CTacInstr(GetOperation(), ltrue, laddr, raddr));
-      cb->AddInstr(new CTacInstr(opGoto, lfalse));
+      // operands are compared in the wider of the two types
+      const CType *ct = left->GetType()->IsLongint() ? left->GetType() : right->GetType();
+      CTacAddr *laddr = Convert(cb, left->ToTac(cb), left->GetType(), ct);
+      CTacAddr *raddr = Convert(cb, right->ToTac(cb), right->GetType(), ct);
+      cb->AddInstr(GetOperation(), ltrue, laddr, raddr);
+      cb->AddInstr(opGoto, lfalse);
   }
 
   return NULL;
@@ -282,11 +318,11 @@ CTacAddr* CAstUnaryOp::ToTac(CCodeBlock *cb)
     CTacLabel *next = cb->CreateLabel();
 
     cb->AddInstr(ltrue);
-    cb->AddInstr(new CTacInstr(opAssign, dst, new CTacConst(1, GetType())));
-    cb->AddInstr(new CTacInstr(opGoto, next));
+    cb->AddInstr(opAssign, dst, cb->CreateConst(1, GetType()));
+    cb->AddInstr(opGoto, next);
     cb->AddInstr(lfalse);
-    cb->AddInstr(new CTacInstr(opAssign, dst, new CTacConst(0, GetType())));
-    cb->AddInstr(new CTacInstr(opGoto, next));
+    cb->AddInstr(opAssign, dst, cb->CreateConst(0, GetType()));
+    cb->AddInstr(opGoto, next);
     cb->AddInstr(next);
 
     return dst;
@@ -294,7 +330,7 @@ CTacAddr* CAstUnaryOp::ToTac(CCodeBlock *cb)
 
   CTacAddr *val = GetOperand()->ToTac(cb);
   CTacTemp *dst = cb->CreateTemp(GetType());
-  cb->AddInstr(new CTacInstr(GetOperation(), dst, val));
+  cb->AddInstr(GetOperation(), dst, val);
   return dst;
 }
 
@@ -314,7 +350,7 @@ CTacAddr* CAstSpecialOp::ToTac(CCodeBlock *cb)
 {
   CTacAddr *val = GetOperand()->ToTac(cb);
   CTacTemp *dst = cb->CreateTemp(GetType());
-  cb->AddInstr(new CTacInstr(opAddress, dst, val));
+  cb->AddInstr(GetOperation(), dst, val);
   return dst;
 }
 
@@ -326,20 +362,23 @@ CTacAddr* CAstFunctionCall::ToTac(CCodeBlock *cb)
 {
   vector<CTacAddr *> params;
 
-  for (unsigned int i = 0; i < GetNArgs(); i++)
-    params.push_back(GetArg(i)->ToTac(cb));
+  for (unsigned int i = 0; i < GetNArgs(); i++) {
+    CTacAddr *arg = GetArg(i)->ToTac(cb);
+    params.push_back(Convert(cb, arg, GetArg(i)->GetType(),
+                             GetSymbol()->GetParam(i)->GetDataType()));
+  }
 
   for (unsigned int i = 0; i < GetNArgs(); i++) {
-    CTacConst *index = new CTacConst(GetNArgs()-i-1, CTypeManager::Get()->GetInteger());
-    cb->AddInstr(new CTacInstr(opParam, index, params[GetNArgs()-i-1]));
+    CTacConst *index = cb->CreateConst(GetNArgs()-i-1, CTypeManager::Get()->GetInteger());
+    cb->AddInstr(opParam, index, params[GetNArgs()-i-1]);
   }
 
   CTacTemp *dst = NULL;
   if (!GetType()->IsNull())
     dst = cb->CreateTemp(GetType());
 
-  CTacAddr *func = new CTacName(GetSymbol());
-  cb->AddInstr(new CTacInstr(opCall, dst, func));
+  CTacAddr *func = cb->CreateName(GetSymbol());
+  cb->AddInstr(opCall, dst, func);
   return dst;
 }
 
@@ -347,8 +386,8 @@ CTacAddr* CAstFunctionCall::ToTac(CCodeBlock *cb,
                                   CTacLabel *ltrue, CTacLabel *lfalse)
 {
   CTacAddr *ret = ToTac(cb);
-  cb->AddInstr(new CTacInstr(opEqual, ltrue, ret, new CTacConst(true, ret->GetType())));
-  cb->AddInstr(new CTacInstr(opGoto, lfalse));
+  cb->AddInstr(opEqual, ltrue, ret, cb->CreateConst(true, ret->GetType()));
+  cb->AddInstr(opGoto, lfalse);
   return NULL;
 }
 
@@ -365,42 +404,23 @@ CTacAddr* CAstDesignator::ToTac(CCodeBlock *cb)
 {
   if (GetSymbol()->GetSymbolType() == ESymbolType::stConstant) {
     if (GetType()->IsArray()) {
-      // string, but unsure how to do this properly
-      // for now, scan the st for the symbol matching the string exactly
-      auto *data = (const CDataInitString *) Evaluate();
-      string str = data->GetData();
-      CSymtab *st = GetSymbol()->GetSymbolTable();
-      for (auto sym : st->GetSymbols()) {
-        if (sym->GetSymbolType() != ESymbolType::stGlobal)
-          continue;
-        if (sym->GetData() == data)
-          return new CTacName(sym);
-      }
+      // string constants refer to the global holding the string data
+      const CSymbol *sym = GetSymbol()->GetSymbolTable()->FindData(Evaluate()->data);
+      if (sym != NULL) return cb->CreateName(sym);
     } else {
-      auto *typ = GetType();
-      auto *data = Evaluate();
-      long long int val = 0;
-      if (typ->IsBoolean())
-        val = ((const CDataInitBoolean *) data)->GetData();
-      else if (typ->IsChar())
-        val = ((const CDataInitChar *) data)->GetData();
-      else if (typ->IsLongint())
-        val = ((const CDataInitInteger *) data)->GetData();
-      else if (typ->IsInt())
-        val = ((const CDataInitLongint *) data)->GetData();
-      CAstConstant *c = new CAstConstant(GetToken(), typ, val);
-      return c->ToTac(cb);
+      CAstConstant c(GetToken(), GetType(), Evaluate()->value);
+      return c.ToTac(cb);
     }
   }
-  return new CTacName(GetSymbol());
+  return cb->CreateName(GetSymbol());
 }
 
 CTacAddr* CAstDesignator::ToTac(CCodeBlock *cb,
                                 CTacLabel *ltrue, CTacLabel *lfalse)
 {
   CTacAddr *val = ToTac(cb);
-  cb->AddInstr(new CTacInstr(opEqual, ltrue, val, new CTacConst(true, val->GetType())));
-  cb->AddInstr(new CTacInstr(opGoto, lfalse));
+  cb->AddInstr(opEqual, ltrue, val, cb->CreateConst(true, val->GetType()));
+  cb->AddInstr(opGoto, lfalse);
   return NULL;
 }
 
@@ -413,60 +433,63 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock *cb)
   CTypeManager *cm = CTypeManager::Get();
   CToken tok = GetToken();
 
+  // the address computation is lowered through temporary nodes that are released on return
+  CArena tmp(4096);
+
   // Array pointer
-  CAstExpression *array = new CAstDesignator(tok, GetSymbol());
+  CAstExpression *array = tmp.New<CAstDesignator>(tok, GetSymbol());
   if (!GetSymbol()->GetDataType()->IsPointer())
-    array = new CAstSpecialOp(tok, opAddress, array, NULL);
+    array = tmp.New<CAstSpecialOp>(tok, opAddress, array);
   //array = new CAstSpecialOp(tok, opCast, array, cm->GetVoidPtr());
 
   // Number of elements, from the last index forward
   CAstExpression *elem = GetIndex(0);
   for (unsigned int i = 1; i < GetNIndices(); i++) {
-    CAstFunctionCall *dim = new CAstFunctionCall(
+    CAstFunctionCall *dim = tmp.New<CAstFunctionCall>(
       tok,
       (const CSymProc *) GetSymbol()->GetSymbolTable()->FindSymbol("DIM"));
     dim->AddArg(array);
-    dim->AddArg(new CAstConstant(tok, cm->GetInteger(), i+1));
+    dim->AddArg(tmp.New<CAstConstant>(tok, cm->GetInteger(), i+1));
 
-    elem = new CAstBinaryOp(
+    elem = tmp.New<CAstBinaryOp>(
       tok, opMul,
       elem, dim
     );
-    elem = new CAstBinaryOp(
+    elem = tmp.New<CAstBinaryOp>(
       tok, opAdd,
       elem, GetIndex(i));
   }
 
   // Calculate final offset: elem * size + dofs
-  CAstExpression *offset = new CAstBinaryOp(
+  CAstExpression *offset = tmp.New<CAstBinaryOp>(
     tok, opMul,
     elem,
-    new CAstConstant(tok, cm->GetInteger(), GetType()->GetSize()));
+    tmp.New<CAstConstant>(tok, cm->GetInteger(), GetType()->GetSize()));
 
-  CAstFunctionCall *dofs = new CAstFunctionCall(
+  CAstFunctionCall *dofs = tmp.New<CAstFunctionCall>(
     tok,
     (const CSymProc *) GetSymbol()->GetSymbolTable()->FindSymbol("DOFS"));
   dofs->AddArg(array);
 
-  offset = new CAstBinaryOp(
+  offset = tmp.New<CAstBinaryOp>(
     tok, opAdd,
     offset,
     dofs);
 
-  CAstExpression *val = new CAstBinaryOp(
+  CAstExpression *val = tmp.New<CAstBinaryOp>(
     tok, opAdd,
     array, offset);
 
   CTacName *ref = (CTacName *) val->ToTac(cb);
-  return new CTacReference(ref->GetSymbol(), GetSymbol());
+  return cb->CreateReference(ref->GetSymbol(), GetSymbol());
 }
 
 CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock *cb,
                                      CTacLabel *ltrue, CTacLabel *lfalse)
 {
   CTacAddr *val = ToTac(cb);
-  cb->AddInstr(new CTacInstr(opEqual, ltrue, val, new CTacConst(true, val->GetType())));
-  cb->AddInstr(new CTacInstr(opGoto, lfalse));
+  cb->AddInstr(opEqual, ltrue, val, cb->CreateConst(true, val->GetType()));
+  cb->AddInstr(opGoto, lfalse);
   return NULL;
 }
 
@@ -476,15 +499,15 @@ CTacAddr* CAstArrayDesignator::ToTac(CCodeBlock *cb,
 //
 CTacAddr* CAstConstant::ToTac(CCodeBlock *cb)
 {
-  return new CTacConst(GetValue(), GetType());
+  return cb->CreateConst(GetValue(), GetType());
 }
 CTacAddr* CAstConstant::ToTac(CCodeBlock *cb,
                                 CTacLabel *ltrue, CTacLabel *lfalse)
 {
   if (GetValue())
-    cb->AddInstr(new CTacInstr(opGoto, ltrue));
+    cb->AddInstr(opGoto, ltrue);
   else
-    cb->AddInstr(new CTacInstr(opGoto, lfalse));
+    cb->AddInstr(opGoto, lfalse);
   return NULL;
 }
 
@@ -494,7 +517,7 @@ CTacAddr* CAstConstant::ToTac(CCodeBlock *cb,
 //
 CTacAddr* CAstStringConstant::ToTac(CCodeBlock *cb)
 {
-  return new CTacName(_sym);
+  return cb->CreateName(_sym);
 }
 
 CTacAddr* CAstStringConstant::ToTac(CCodeBlock *cb,
@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL atom (interned string) table
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cstring>
+
+#include "atom.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CAtomTable
+//
+thread_local CAtomTable *CAtomTable::_global = NULL;
+
+CAtomTable::CAtomTable(void)
+  : _slots(1024, 0)
+{
+  // atom 0 is the empty string
+  Intern("", 0);
+}
+
+CAtomTable::~CAtomTable(void)
+{
+}
+
+CAtomTable* CAtomTable::Get(void)
+{
+  if (_global == NULL) _global = new CAtomTable();
+
+  return _global;
+}
+
+CAtomTable* CAtomTable::Set(CAtomTable *table)
+{
+  CAtomTable *prev = _global;
+  _global = table;
+  return prev;
+}
+
+TAtom CAtomTable::Intern(const char *s, size_t len)
+{
+  uint32_t hash = Hash(s, len);
+  size_t slot = Slot(s, len, hash);
+
+  if (_slots[slot] != 0) return _slots[slot] - 1;
+
+  TAtom atom = _strings.size();
+  _strings.push_back(string(s, len));
+  _hashes.push_back(hash);
+  _slots[slot] = atom + 1;
+
+  // keep the load factor below 1/2
+  if (2*_strings.size() > _slots.size()) Grow();
+
+  return atom;
+}
+
+bool CAtomTable::Find(const string &s, TAtom *atom) const
+{
+  size_t slot = Slot(s.data(), s.size(), Hash(s.data(), s.size()));
+
+  if (_slots[slot] == 0) return false;
+
+  *atom = _slots[slot] - 1;
+  return true;
+}
+
+uint32_t CAtomTable::Hash(const char *s, size_t len)
+{
+  // FNV-1a
+  uint32_t h = 2166136261u;
+  for (size_t i=0; i<len; i++) h = (h ^ (unsigned char)s[i]) * 16777619u;
+  return h;
+}
+
+size_t CAtomTable::Slot(const char *s, size_t len, uint32_t hash) const
+{
+  size_t mask = _slots.size() - 1;
+  size_t slot = hash & mask;
+
+  // linear probing
+  while (_slots[slot] != 0) {
+    TAtom a = _slots[slot] - 1;
+    if ((_hashes[a] == hash) && (_strings[a].size() == len) &&
+        (memcmp(_strings[a].data(), s, len) == 0)) break;
+    slot = (slot + 1) & mask;
+  }
+
+  return slot;
+}
+
+void CAtomTable::Grow(void)
+{
+  vector<TAtom> slots(2*_slots.size(), 0);
+  size_t mask = slots.size() - 1;
+
+  for (TAtom a=0; a<_strings.size(); a++) {
+    size_t slot = _hashes[a] & mask;
+    while (slots[slot] != 0) slot = (slot + 1) & mask;
+    slots[slot] = a + 1;
+  }
+
+  _slots.swap(slots);
+}
@@ -0,0 +1,128 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL atom (interned string) table
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_ATOM_H__
+#define __SnuPL_ATOM_H__
+
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief atom
+///
+/// An atom identifies an interned string. Two atoms of the same table are equal iff their strings
+/// are equal. Atom 0 denotes the empty string.
+///
+typedef uint32_t TAtom;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief atom table
+///
+/// Interns strings (identifiers, lexemes of tokens, symbol names). Each distinct string is stored
+/// once; lookups by hash use open addressing. Strings returned by GetString() remain valid for the
+/// lifetime of the table.
+///
+class CAtomTable {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    CAtomTable(void);
+
+    /// @brief destructor
+    ~CAtomTable(void);
+
+    /// @}
+
+    /// @brief return the atom table of the calling thread
+    static CAtomTable* Get(void);
+
+    /// @brief make @a table the atom table of the calling thread
+    ///
+    /// @param table atom table (NULL: create a new table on the next call to Get())
+    /// @retval the previous atom table of the calling thread
+    static CAtomTable* Set(CAtomTable *table);
+
+    /// @name interning
+    /// @{
+
+    /// @brief intern a string
+    ///
+    /// @param s string
+    /// @param len length of @a s
+    /// @retval atom of the string
+    TAtom Intern(const char *s, size_t len);
+
+    /// @brief intern a string
+    ///
+    /// @param s string
+    /// @retval atom of the string
+    TAtom Intern(const string &s) { return Intern(s.data(), s.size()); };
+
+    /// @brief look up a string without interning it
+    ///
+    /// @param s string
+    /// @param atom [out] atom of the string
+    /// @retval true if the string is interned
+    bool Find(const string &s, TAtom *atom) const;
+
+    /// @brief return the string of an atom
+    ///
+    /// @param atom atom
+    /// @retval string
+    const string& GetString(TAtom atom) const { return _strings[atom]; };
+
+    /// @brief return the number of interned strings
+    size_t GetSize(void) const { return _strings.size(); };
+
+    /// @}
+
+  private:
+    /// @brief hash a string
+    static uint32_t Hash(const char *s, size_t len);
+
+    /// @brief return the slot of a string (empty slot if the string is not interned)
+    size_t Slot(const char *s, size_t len, uint32_t hash) const;
+
+    /// @brief double the number of slots
+    void Grow(void);
+
+    deque<string> _strings;         ///< interned strings, indexed by atom
+    vector<uint32_t> _hashes;       ///< hashes of the interned strings
+    vector<TAtom> _slots;           ///< hash table; atom+1 (0: empty)
+
+    static thread_local CAtomTable *_global; ///< atom table of the current thread
+};
+
+
+#endif // __SnuPL_ATOM_H__
@@ -35,6 +35,8 @@
 #include <cassert>
 
 #include "backendAMD64.h"
+#include "environment.h"
+#include "profile.h"
 using namespace std;
 
 //#define DEBUG
@@ -50,10 +52,10 @@ struct {
   { "rcx",  "ecx",  "cx",   "cl"   },   // rCX       arg #4     caller
   { "rdx",  "edx",  "dx",   "dl"   },   // rDX       arg #3     caller
   { "rbx",  "ebx",  "bx",   "bl"   },   // rBX                  callee
-  { "rsi",  "esi",  "si",   NULL   },   // rSI       arg #2     caller
-  { "rdi",  "edi",  "di",   NULL   },   // rDI       arg #1     caller
-  { "rsp",  "esp",  "sp",   NULL   },   // rSP      stack ptr
-  { "rbp",  "ebp",  "bp",   NULL   },   // rBP                  callee
+  { "rsi",  "esi",  "si",   "sil"  },   // rSI       arg #2     caller
+  { "rdi",  "edi",  "di",   "dil"  },   // rDI       arg #1     caller
+  { "rsp",  "esp",  "sp",   "spl"  },   // rSP      stack ptr
+  { "rbp",  "ebp",  "bp",   "bpl"  },   // rBP                  callee
   { "r8",   "r8d",  "r8w",  "r8b"  },   // r8        arg #5     caller
   { "r9",   "r9d",  "r9w",  "r9b"  },   // r9        arg #6     caller
   { "r10",  "r10d", "r10w", "r10b" },   // r10                  caller
@@ -68,9 +70,11 @@ struct {
 // CBackendAMD64
 //
 CBackendAMD64::CBackendAMD64(ostream &out)
-  : CBackend(out), _curr_scope(NULL)
+  : CBackend(out), _curr_scope(NULL), _instrument(false), _modref(NULL)
 {
   _ind = string(4, ' ');
+
+  CEnvironment::Get()->GetFlag("instrument", _instrument);
 }
 
 CBackendAMD64::~CBackendAMD64(void)
@@ -118,9 +122,12 @@ void CBackendAMD64::EmitCode(void)
 
   // emit scope & subscopes
   // main scope must be emitted first so subscopes can use globals
+  _modref = new CModRef(_m);
   EmitScope(_m);
   for (auto scope : _m->GetSubscopes())
     EmitScope(scope);
+  delete _modref;
+  _modref = NULL;
 
   _out << _ind << "# end of text section" << endl
        << _ind << "#-----------------------------------------" << endl
@@ -137,6 +144,7 @@ void CBackendAMD64::EmitData(void)
        << endl;
 
   EmitGlobalData(_m);
+  if (_instrument) EmitProfileData();
 
   _out << _ind << "# end of global data section" << endl
        << _ind << "#-----------------------------------------" << endl
@@ -192,7 +200,9 @@ void CBackendAMD64::EmitScope(CScope *scope)
     .saved_parameters = 0,
     .local_variables  = 0,
     .argument_build   = 0,
-    .size             = 0
+    .size             = 0,
+    .argbuild         = {},
+    .free_regs        = { r12, r13, r14 }
   };
 
   ComputeStackOffsets(scope, paf);
@@ -218,16 +228,17 @@ void CBackendAMD64::EmitScope(CScope *scope)
   EmitInstruction("andq", "$-16, %rsp", "align to 16 bytes"); // reference compiler seems to do it?
 
   if (auto *sym = dynamic_cast<CSymProc *>(scope->GetDeclaration())) {
-    string cmt = "store parameters to stack";
-    switch (sym->GetNParams()) {
-      default: // fallthrough
-      case 6: Store(new CTacName(sym->GetParam(5)), EAMD64Register::r9, cmt); cmt = "";
-      case 5: Store(new CTacName(sym->GetParam(4)), EAMD64Register::r8, cmt); cmt = "";
-      case 4: Store(new CTacName(sym->GetParam(3)), EAMD64Register::rCX, cmt); cmt = "";
-      case 3: Store(new CTacName(sym->GetParam(2)), EAMD64Register::rDX, cmt); cmt = "";
-      case 2: Store(new CTacName(sym->GetParam(1)), EAMD64Register::rSI, cmt); cmt = "";
-      case 1: Store(new CTacName(sym->GetParam(0)), EAMD64Register::rDI, cmt); cmt = "";
-      case 0: break;
+    // parameters kept in registers are moved to their callee-saved register,
+    // all others are stored to their stack home
+    const EAMD64Register abi[] = { rDI, rSI, rDX, rCX, r8, r9 };
+    string cmt = "move parameters to their home";
+    for (unsigned int p=0; p<min(sym->GetNParams(), 6U); p++) {
+      const CSymParam *param = sym->GetParam(p);
+      EAMD64Register reg = SymbolReg(param);
+
+      if (reg != NUMREGS) EmitInstruction("movq", Reg(abi[p]) + ", " + Reg(reg), cmt);
+      else Store(scope->CreateName(param), abi[p], cmt);
+      cmt = "";
     }
   }
 
@@ -241,6 +252,25 @@ void CBackendAMD64::EmitScope(CScope *scope)
   }
 
   EmitLocalData(scope);
+
+  if (_instrument) {
+    if (scope->GetParent() == NULL) {
+      EmitInstruction("leaq", ".Lprof_desc(%rip), %rdi", "register execution profile");
+      EmitInstruction("call", "__snupl_profile_init", "");
+    }
+    EmitInstruction("incq", ProfileCounter(CProfile::EntryKey(scope)), "profile: invocations");
+
+    // recorded only by its key, the counter is never incremented
+    if (scope->GetProfileSignature() != "") {
+      ProfileCounter(CProfile::SignatureKey(scope, scope->GetProfileSignature()));
+    }
+  }
+
+  string gcmt = "load globals kept in registers";
+  for (const auto &g : _promoted) {
+    MoveGlobal(g.first, false, gcmt);
+    gcmt = "";
+  }
   _out << endl;
 
   // 3. emit code
@@ -251,6 +281,11 @@ void CBackendAMD64::EmitScope(CScope *scope)
   // 4. emit function epilogue
   _out << Label("exit") << ":" << endl;
   _out << _ind << "# epilogue" << endl;
+  gcmt = "write back globals kept in registers";
+  for (const CSymbol *g : _promoted_mod) {
+    MoveGlobal(g, true, gcmt);
+    gcmt = "";
+  }
   EmitInstruction("leave", "", "");
   EmitInstruction("popq", "%r15", "");
   EmitInstruction("popq", "%r14", "");
@@ -260,6 +295,8 @@ void CBackendAMD64::EmitScope(CScope *scope)
   EmitInstruction("ret", "", "");
 
   _out << endl;
+
+  EmitProfileTrampolines();
 }
 
 void CBackendAMD64::EmitGlobalData(CScope *scope)
@@ -388,10 +425,20 @@ void CBackendAMD64::EmitCodeBlock(CCodeBlock *cb, StackFrame &paf)
 {
   assert(cb != NULL);
 
-  const list<CTacInstr*> &instr = cb->GetInstr();
-  list<CTacInstr*>::const_iterator it = instr.begin();
+  const CTacInstrList &instr = cb->GetInstr();
+
+  // loop headers are labels targeted by a backward branch
+  set<const CTacLabel*> seen;
+  _loop_hdr.clear();
+  for (CTacInstr *i : instr) {
+    if (CTacLabel *l = dynamic_cast<CTacLabel*>(i)) seen.insert(l);
+    else if (i->IsBranch()) {
+      const CTacLabel *l = dynamic_cast<const CTacLabel*>(i->GetDest());
+      if (seen.find(l) != seen.end()) _loop_hdr.insert(l);
+    }
+  }
 
-  while (it != instr.end()) EmitInstruction(*it++, paf);
+  for (CTacInstr *i : instr) EmitInstruction(i, paf);
 }
 
 void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
@@ -408,40 +455,38 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
     // binary operators
     // dst = src1 op src2
     case opAdd:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      Load(EAMD64Register::rBX, i->GetSrc(2), "");
-      EmitInstruction("addq", "%rbx, %rax", "");
-      Store(i->GetDest(), EAMD64Register::rAX, "");
-      break;
     case opSub:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      Load(EAMD64Register::rBX, i->GetSrc(2), "");
-      EmitInstruction("subq", "%rbx, %rax", "");
-      Store(i->GetDest(), EAMD64Register::rAX, "");
-      break;
-    case opMul:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      Load(EAMD64Register::rBX, i->GetSrc(2), "");
-      EmitInstruction("imulq", "%rbx", "");
+    case opMul: {
+      int w = OpWidth(i->GetDest());
+      mnm = (op == opAdd) ? "add" : (op == opSub) ? "sub" : "imul";
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), w);
+      Load(EAMD64Register::rBX, i->GetSrc(2), "", w);
+      EmitInstruction(mnm + Suffix(w), Reg(EAMD64Register::rBX, w) + ", " +
+                      Reg(EAMD64Register::rAX, w), "");
       Store(i->GetDest(), EAMD64Register::rAX, "");
       break;
-    case opDiv:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      Load(EAMD64Register::rBX, i->GetSrc(2), "");
-      EmitInstruction("cdq", "", "");
-      EmitInstruction("idivq", "%rbx", "");
+    }
+    case opDiv: {
+      int w = OpWidth(i->GetDest());
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), w);
+      Load(EAMD64Register::rBX, i->GetSrc(2), "", w);
+      EmitInstruction(w == 8 ? "cqto" : "cltd", "", "");
+      EmitInstruction("idiv" + Suffix(w), Reg(EAMD64Register::rBX, w), "");
       Store(i->GetDest(), EAMD64Register::rAX, "");
       break;
+    }
     // opAnd and opOr never appear in TAC
 
     // unary operators
     // dst = src1
     // opNot never appears in TAC
-    case opNeg:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      EmitInstruction("negq", "%rax", "");
+    case opNeg: {
+      int w = OpWidth(i->GetDest());
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), w);
+      EmitInstruction("neg" + Suffix(w), Reg(EAMD64Register::rAX, w), "");
       Store(i->GetDest(), EAMD64Register::rAX, "");
       break;
+    }
     case opPos:
       // notably, bug on reference compiler
       // fallthrough to opAssign
@@ -449,7 +494,16 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
     // memory operations
     // dst = src1
     case opAssign:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), OpWidth(i->GetDest()));
+      Store(i->GetDest(), EAMD64Register::rAX, "");
+      break;
+
+    // type conversions
+    // dst = (type)src1
+    // the load sign-extends, the store truncates
+    case opWiden:
+    case opNarrow:
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), 8);
       Store(i->GetDest(), EAMD64Register::rAX, "");
       break;
 
@@ -475,43 +529,97 @@ void CBackendAMD64::EmitInstruction(CTacInstr *i, StackFrame &paf)
     case opLessThan:
     case opLessEqual:
     case opBiggerThan:
-    case opBiggerEqual:
-      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-      Load(EAMD64Register::rBX, i->GetSrc(2), "");
-      EmitInstruction("cmp", "%rbx, %rax", "");
-      EmitInstruction("j" + Condition(op), Operand(i->GetDest()), "");
+    case opBiggerEqual: {
+      // both operands have the same type (integer constants excepted)
+      int w = max(OpWidth(i->GetSrc(1)), OpWidth(i->GetSrc(2)));
+      if (dynamic_cast<CTacConst*>(i->GetSrc(1))) w = OpWidth(i->GetSrc(2));
+      else if (dynamic_cast<CTacConst*>(i->GetSrc(2))) w = OpWidth(i->GetSrc(1));
+
+      Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), w);
+      Load(EAMD64Register::rBX, i->GetSrc(2), "", w);
+      EmitInstruction("cmp" + Suffix(w), Reg(EAMD64Register::rBX, w) + ", " +
+                      Reg(EAMD64Register::rAX, w), "");
+
+      if (_instrument && (i->GetProfileId() >= 0)) {
+        // taken edges are counted in a trampoline emitted after the epilogue,
+        // fall-through edges directly after the branch
+        int pid = i->GetProfileId();
+        bool inv = i->IsProfileInverted();
+        string tramp = Label("prof_" + to_string(pid));
+
+        EmitInstruction("j" + Condition(op), tramp, "");
+        EmitInstruction("incq", ProfileCounter(CProfile::BranchKey(GetScope(), pid, inv)),
+                        "profile: fall-through");
+        _prof_tramp.push_back(make_tuple(tramp,
+                              ProfileCounter(CProfile::BranchKey(GetScope(), pid, !inv)),
+                              Operand(i->GetDest())));
+      } else {
+        EmitInstruction("j" + Condition(op), Operand(i->GetDest()), "");
+      }
       break;
+    }
 
     // function call-related operations
-    case opCall:
+    case opCall: {
+      // promoted globals the callee may access are passed through memory
+      const CSymbol *callee = ((CTacName*)i->GetSrc(1))->GetSymbol();
+      for (const CSymbol *g : _promoted_mod) {
+        if (_modref->MayRef(callee, g) || _modref->MayMod(callee, g)) MoveGlobal(g, true);
+      }
       EmitInstruction("call", Operand(i->GetSrc(1)), cmt.str());
+      for (const auto &g : _promoted) {
+        if (_modref->MayMod(callee, g.first)) MoveGlobal(g.first, false);
+      }
       if (i->GetDest())
         Store(i->GetDest(), EAMD64Register::rAX, "");
       break;
+    }
     case opReturn:
       if (i->GetSrc(1))
-        Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
+        Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1)));
       EmitInstruction("jmp", Label("exit"), "");
       break;
     case opParam:
       switch (long long int index = ((CTacConst *) i->GetDest())->GetValue()) {
-        case 0: Load(EAMD64Register::rDI, i->GetSrc(1), cmt.str()); break;
-        case 1: Load(EAMD64Register::rSI, i->GetSrc(1), cmt.str()); break;
-        case 2: Load(EAMD64Register::rDX, i->GetSrc(1), cmt.str()); break;
-        case 3: Load(EAMD64Register::rCX, i->GetSrc(1), cmt.str()); break;
-        case 4: Load(EAMD64Register::r8, i->GetSrc(1), cmt.str()); break;
-        case 5: Load(EAMD64Register::r9, i->GetSrc(1), cmt.str()); break;
-        default:
-          Load(EAMD64Register::rAX, i->GetSrc(1), cmt.str());
-          Store(paf.argbuild[index-6], EAMD64Register::rAX, "");
+        case 0: Load(EAMD64Register::rDI, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        case 1: Load(EAMD64Register::rSI, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        case 2: Load(EAMD64Register::rDX, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        case 3: Load(EAMD64Register::rCX, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        case 4: Load(EAMD64Register::r8, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        case 5: Load(EAMD64Register::r9, i->GetSrc(1), cmt.str(), OpWidth(i->GetSrc(1))); break;
+        default: {
+          // constants and values kept in registers are stored directly to the argument build area
+          CTacAddr *src = i->GetSrc(1);
+          CTacConst *c = dynamic_cast<CTacConst*>(src);
+          CTacName *n = dynamic_cast<CTacName*>(src);
+          EAMD64Register reg = (n != NULL) && (dynamic_cast<CTacReference*>(n) == NULL)
+                               ? SymbolReg(n->GetSymbol()) : NUMREGS;
+
+          if ((c != NULL) && (c->GetValue() == (int)c->GetValue())) {
+            EmitInstruction("movq", Imm(c->GetValue()) + ", " + Operand(paf.argbuild[index-6]),
+                            cmt.str());
+          } else if (reg != NUMREGS) {
+            EmitInstruction("movq", Reg(reg) + ", " + Operand(paf.argbuild[index-6]), cmt.str());
+          } else {
+            Load(EAMD64Register::rAX, src, cmt.str());
+            Store(paf.argbuild[index-6], EAMD64Register::rAX, "");
+          }
           break;
+        }
       }
       break;
 
     // special
-    case opLabel:
-      _out << Label(dynamic_cast<CTacLabel*>(i)) << ":" << endl;
+    case opLabel: {
+      CTacLabel *l = dynamic_cast<CTacLabel*>(i);
+      if (IsHotLoopHeader(l)) EmitInstruction(".p2align", "4,,10", "hot loop");
+      _out << Label(l) << ":" << endl;
+      if (_instrument) {
+        EmitInstruction("incq", ProfileCounter(CProfile::LabelKey(GetScope(), l)),
+                        "profile: block entry");
+      }
       break;
+    }
 
     case opNop:
       EmitInstruction("nop", "", cmt.str());
@@ -537,42 +645,42 @@ void CBackendAMD64::EmitInstruction(string mnemonic, string args, string comment
   _out << endl;
 }
 
-void CBackendAMD64::Load(EAMD64Register dst, CTacAddr *src, string comment)
+void CBackendAMD64::Load(EAMD64Register dst, CTacAddr *src, string comment, int width)
 {
   assert(src != NULL);
+  assert((width == 4) || (width == 8));
   int size = OperandSize(src);
-  string mnm = "mov", mod, reg = Reg(dst);
-
-  // set operator modifier based on operand size
-  switch (size) {
-    case 1: mod = "zbq"; break;
-    case 2: mod = "zwq"; break;
-    case 4: mod = "slq"; break;
-    case 8: mod = "q"; break;
-    default: SetError("Data type not supported by this backend.");
+  string mnm, reg = Reg(dst, width);
+
+  if (CTacConst *c = dynamic_cast<CTacConst*>(src)) {
+    // 64-bit immediates that do not fit into a sign-extended 32-bit value require movabs
+    mnm = ((width == 8) && (c->GetValue() != (int)c->GetValue())) ? "movabsq" : "mov" + Suffix(width);
+  } else {
+    // narrow operands are zero- or sign-extended to the width of the operation
+    switch (size) {
+      case 1: mnm = "movzb" + Suffix(width); break;
+      case 2: mnm = "movzw" + Suffix(width); break;
+      case 4: mnm = (width == 8) ? "movslq" : "movl"; break;
+      case 8: mnm = "movq"; reg = Reg(dst, 8); break;
+      default: SetError("Data type not supported by this backend.");
+    }
   }
 
   // emit a load instruction
-  EmitInstruction(mnm + mod, Operand(src) + ", " + reg, comment);
+  EmitInstruction(mnm, Operand(src) + ", " + reg, comment);
 }
 
 void CBackendAMD64::Store(CTac *dst, EAMD64Register src, string comment)
 {
   assert(dst != NULL);
   int size = OperandSize(dst);
-  string mod, reg = Reg(src, size);
 
-  // set operator modifier based on operand size
-  switch (size) {
-    case 1: mod = "b"; break;
-    case 2: mod = "w"; break;
-    case 4: mod = "l"; break;
-    case 8: mod = "q"; break;
-    default: SetError("Data type not supported by this backend.");
+  if ((size != 1) && (size != 2) && (size != 4) && (size != 8)) {
+    SetError("Data type not supported by this backend.");
   }
 
   // emit a store instruction
-  EmitInstruction("mov" + mod, reg + ", " + Operand(dst), comment);
+  EmitInstruction("mov" + Suffix(size), Reg(src, size) + ", " + Operand(dst), comment);
 }
 
 string CBackendAMD64::Operand(const CTac *op)
@@ -588,6 +696,10 @@ string CBackendAMD64::Operand(const CTac *op)
     EmitInstruction("movq", Location(r->GetSymbol(), 0) + ", " + Reg(EAMD64Register::r15, 8));
     return "(" + Reg(EAMD64Register::r15, 8) + ")";
   } else if (auto *n = dynamic_cast<const CTacName *>(op)) {
+    // variables kept in registers are accessed with the register name matching their size
+    EAMD64Register reg = SymbolReg(n->GetSymbol());
+    if (reg != NUMREGS) return Reg(reg, OperandSize(const_cast<CTac*>(op)));
+
     // named (temporary) variables
     return Location(n->GetSymbol(), 0);
   } else if (auto *l = dynamic_cast<const CTacLabel *>(op)) {
@@ -598,7 +710,7 @@ string CBackendAMD64::Operand(const CTac *op)
   return "?";
 }
 
-string CBackendAMD64::Imm(int value) const
+string CBackendAMD64::Imm(long long value) const
 {
   ostringstream o;
   o << "$" << dec << value;
@@ -664,6 +776,27 @@ int CBackendAMD64::OperandSize(CTac *t) const
   return addr->GetType()->GetSize();
 }
 
+int CBackendAMD64::OpWidth(CTac *t) const
+{
+  // constants are as wide as their type, operands narrower than 32 bits are
+  // computed in 32-bit registers
+  CTacConst *c = dynamic_cast<CTacConst*>(t);
+  int size = (c != NULL) && (c->GetType() != NULL) ? c->GetType()->GetSize() : OperandSize(t);
+
+  return size <= 4 ? 4 : 8;
+}
+
+string CBackendAMD64::Suffix(int size) const
+{
+  switch (size) {
+    case 1: return "b";
+    case 2: return "w";
+    case 4: return "l";
+    case 8: return "q";
+  }
+  return "?";
+}
+
 string CBackendAMD64::Location(const CSymbol *s, long long ofs)
 {
   // return a string denoting the location of a symbol
@@ -703,6 +836,154 @@ string CBackendAMD64::Reg(EAMD64Register reg, int size)
   return "%" + rn;
 }
 
+EAMD64Register CBackendAMD64::RegByName(const string name) const
+{
+  for (int r=0; r<NUMREGS; r++) {
+    if (name == EAMD64RegisterName[r].n64) return (EAMD64Register)r;
+  }
+  return NUMREGS;
+}
+
+EAMD64Register CBackendAMD64::SymbolReg(const CSymbol *s) const
+{
+  auto p = _promoted.find(s);
+  if (p != _promoted.end()) return p->second;
+
+  const CStorage *st = s->GetLocation();
+
+  if ((st == NULL) || (st->GetLocation() != slRegister)) return NUMREGS;
+  return RegByName(st->GetBase());
+}
+
+void CBackendAMD64::AllocateParamRegisters(CScope *scope, StackFrame &paf)
+{
+  // count the uses of parameters passed in registers and find those whose address is taken
+  map<const CSymbol*, unsigned int> uses;
+  set<const CSymbol*> addr;
+
+  for (CSymbol *sym : scope->GetSymbolTable()->GetSymbols()) {
+    if ((sym->GetSymbolType() == stParam) && (((CSymParam*)sym)->GetIndex() < 6)) uses[sym] = 0;
+  }
+
+  for (CTacInstr *i : scope->GetCodeBlock()->GetInstr()) {
+    CTac *ops[] = { i->GetDest(), i->GetSrc(1), i->GetSrc(2) };
+
+    for (CTac *op : ops) {
+      CTacName *n = dynamic_cast<CTacName*>(op);
+      if (n == NULL) continue;
+
+      auto u = uses.find(n->GetSymbol());
+      if (u != uses.end()) u->second++;
+    }
+
+    if (i->GetOperation() == opAddress) {
+      if (CTacName *n = dynamic_cast<CTacName*>(i->GetSrc(1))) addr.insert(n->GetSymbol());
+    }
+  }
+
+  // most frequently used parameters first
+  vector<pair<const CSymbol*, unsigned int>> cand;
+  for (const auto &u : uses) {
+    if ((u.second > 0) && (addr.find(u.first) == addr.end())) cand.push_back(u);
+  }
+  stable_sort(cand.begin(), cand.end(),
+    [](const pair<const CSymbol*, unsigned int> &a, const pair<const CSymbol*, unsigned int> &b) {
+      if (a.second != b.second) return a.second > b.second;
+      return ((CSymParam*)a.first)->GetIndex() < ((CSymParam*)b.first)->GetIndex();
+    });
+
+  for (const auto &c : cand) {
+    if (paf.free_regs.empty()) break;
+
+    EAMD64Register reg = paf.free_regs.front();
+    paf.free_regs.erase(paf.free_regs.begin());
+    const_cast<CSymbol*>(c.first)->SetLocation(
+      new CStorage(EStorageLocation::slRegister, EAMD64RegisterName[reg].n64, 0));
+  }
+
+}
+
+void CBackendAMD64::PromoteGlobals(CScope *scope, StackFrame &paf)
+{
+  _promoted.clear();
+  _promoted_mod.clear();
+  if ((_modref == NULL) || paf.free_regs.empty()) return;
+
+  // weigh accesses and calls by their estimated execution frequency
+  CControlFlowGraph cfg(scope->GetCodeBlock());
+  map<const CSymbol*, double, SSymbolNameLess> uses;
+  set<const CSymbol*> mod;
+  vector<pair<const CSymbol*, double>> calls;
+
+  for (CBasicBlock *b : cfg.GetBlocks()) {
+    double w = 1.0;
+    for (unsigned int d=0; d<min(cfg.GetLoopDepth(b), 4U); d++) w *= 8.0;
+
+    for (CTacInstr *i : b->GetInstr()) {
+      if (i->GetOperation() == opCall) {
+        calls.push_back(make_pair(((CTacName*)i->GetSrc(1))->GetSymbol(), w));
+        continue;
+      }
+
+      CTac *ops[] = { i->GetDest(), i->GetSrc(1), i->GetSrc(2) };
+      for (CTac *op : ops) {
+        CTacName *n = dynamic_cast<CTacName*>(op);
+        if ((n == NULL) || (dynamic_cast<CTacReference*>(n) != NULL)) continue;
+
+        const CSymbol *g = n->GetSymbol();
+        if ((g->GetSymbolType() != stGlobal) || !g->GetDataType()->IsScalar() ||
+            _modref->IsAddressTaken(g)) continue;
+
+        uses[g] += w;
+        if (op == i->GetDest()) mod.insert(g);
+      }
+    }
+  }
+
+  // benefit: accesses turned into register operands
+  // cost: load at entry, write back at exit, spills and reloads around calls
+  vector<pair<const CSymbol*, double>> cand;
+  for (const auto &u : uses) {
+    const CSymbol *g = u.first;
+    bool m = mod.find(g) != mod.end();
+    double cost = 1.0 + (m ? 1.0 : 0.0);
+
+    for (const auto &c : calls) {
+      bool cmod = _modref->MayMod(c.first, g);
+      if (m && (cmod || _modref->MayRef(c.first, g))) cost += c.second;
+      if (cmod) cost += c.second;
+    }
+
+    if (u.second > cost) cand.push_back(make_pair(g, u.second - cost));
+  }
+  stable_sort(cand.begin(), cand.end(),
+    [](const pair<const CSymbol*, double> &a, const pair<const CSymbol*, double> &b) {
+      return a.second > b.second;
+    });
+
+  for (const auto &c : cand) {
+    if (paf.free_regs.empty()) break;
+
+    _promoted[c.first] = paf.free_regs.front();
+    paf.free_regs.erase(paf.free_regs.begin());
+    if (mod.find(c.first) != mod.end()) _promoted_mod.insert(c.first);
+  }
+}
+
+void CBackendAMD64::MoveGlobal(const CSymbol *g, bool store, string comment)
+{
+  EAMD64Register reg = _promoted.at(g);
+  int size = g->GetDataType()->GetSize();
+
+  if (store) {
+    EmitInstruction("mov" + Suffix(size), Reg(reg, size) + ", " + Location(g), comment);
+  } else if (size == 1) {
+    EmitInstruction("movzbl", Location(g) + ", " + Reg(reg, 4), comment);
+  } else {
+    EmitInstruction("mov" + Suffix(size), Location(g) + ", " + Reg(reg, size), comment);
+  }
+}
+
 void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
 {
   // compute the location of local variables, temporaries and arguments on the stack
@@ -755,9 +1036,9 @@ void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
       case stParam: {
         int index = ((CSymParam *) sym)->GetIndex() + 1; // 0->1-indexed
         if (index <= 6) {
-          // unspilled params are rbp - offset
+          // register parameters are kept in registers (see AllocateParamRegisters) or
+          // spilled to rbp - offset
           sym->SetLocation(new CStorage(EStorageLocation::slMemoryRel, "rbp", -index*8));
-          paf.saved_parameters += 8; // all parameters are padded to 8 bytes
         } else {
           // spilled params are rbp + (7*8) + offset
           // conveniently, index starts at 7
@@ -766,7 +1047,6 @@ void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
         break;
       }
       case stProcedure: {
-        maxParams = max(maxParams, ((CSymProc *) sym)->GetNParams());
         // procedures are absolute
         sym->SetLocation(new CStorage(EStorageLocation::slMemoryAbs, sym->GetName(), 0));
         break;
@@ -777,6 +1057,25 @@ void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
     }
   }
 
+  // keep register parameters and frequently used globals in registers;
+  // the spilled parameters need a stack home
+  AllocateParamRegisters(scope, paf);
+  PromoteGlobals(scope, paf);
+  for (auto sym : scope->GetSymbolTable()->GetSymbols()) {
+    if ((sym->GetSymbolType() == stParam) && (SymbolReg(sym) == NUMREGS)) {
+      int index = ((CSymParam *) sym)->GetIndex() + 1;
+      if (index <= 6) paf.saved_parameters = max(paf.saved_parameters, (size_t)index*8);
+    }
+  }
+
+  // the argument build area must hold the stack arguments of all calls in this scope
+  for (CTacInstr *i : scope->GetCodeBlock()->GetInstr()) {
+    if (i->GetOperation() == opParam) {
+      unsigned int index = ((CTacConst *) i->GetDest())->GetValue();
+      maxParams = max(maxParams, index+1);
+    }
+  }
+
   // compute argument_build. argbuild is initialized later, to avoid offsetting locals
   if (maxParams > 6)
     paf.argument_build = (maxParams - 6) * 8;
@@ -805,3 +1104,66 @@ void CBackendAMD64::ComputeStackOffsets(CScope *scope, StackFrame &paf)
     paf.padding + paf.saved_parameters +
     paf.local_variables + paf.argument_build;
 }
+
+string CBackendAMD64::ProfileCounter(const string key)
+{
+  auto it = _prof_idx.find(key);
+  size_t idx;
+
+  if (it == _prof_idx.end()) {
+    idx = _prof_keys.size();
+    _prof_keys.push_back(key);
+    _prof_idx[key] = idx;
+  } else {
+    idx = it->second;
+  }
+
+  return ".Lprof_cnt+" + to_string(idx*8) + "(%rip)";
+}
+
+void CBackendAMD64::EmitProfileTrampolines(void)
+{
+  if (_prof_tramp.empty()) return;
+
+  _out << _ind << "# profile: taken branches" << endl;
+  for (const auto &t : _prof_tramp) {
+    _out << get<0>(t) << ":" << endl;
+    EmitInstruction("incq", get<1>(t), "");
+    EmitInstruction("jmp", get<2>(t), "");
+  }
+  _out << endl;
+
+  _prof_tramp.clear();
+}
+
+void CBackendAMD64::EmitProfileData(void)
+{
+  // layout must match SnuplProfile in rte/x86-64/PROF.h
+  _out << _ind << "# execution profile" << endl
+       << _ind << ".align 8" << endl
+       << left << setw(36) << ".Lprof_desc:" << "# profile descriptor" << endl;
+  EmitInstruction(".quad", to_string(_prof_keys.size()), "number of counters");
+  EmitInstruction(".quad", ".Lprof_cnt", "counters");
+  EmitInstruction(".quad", ".Lprof_keys", "counter keys");
+  EmitInstruction(".quad", ".Lprof_name", "module name");
+
+  _out << left << setw(36) << ".Lprof_cnt:" << "# counters" << endl;
+  EmitInstruction(".skip", to_string(_prof_keys.size()*8), "");
+
+  _out << ".Lprof_keys:" << endl;
+  for (const string &k : _prof_keys) EmitInstruction(".asciz", "\"" + k + "\"", "");
+
+  _out << ".Lprof_name:" << endl;
+  EmitInstruction(".asciz", "\"" + _m->GetName() + "\"", "");
+  _out << endl;
+}
+
+bool CBackendAMD64::IsHotLoopHeader(const CTacLabel *label) const
+{
+  const CProfile *p = GetScope()->GetProfile();
+  if ((p == NULL) || (_loop_hdr.find(label) == _loop_hdr.end())) return false;
+
+  // a loop is hot if its header executes at least twice per invocation on average
+  unsigned long long entry = max(p->GetEntryCount(GetScope()), 1ULL);
+  return p->GetLabelCount(GetScope(), label) >= 2*entry;
+}
@@ -31,7 +31,12 @@
 #ifndef __SnuPL_BACKEND_AMD64_H__
 #define __SnuPL_BACKEND_AMD64_H__
 
+#include <map>
+#include <set>
+#include <tuple>
+
 #include "backend.h"
+#include "opt.h"
 
 using namespace std;
 
@@ -70,8 +75,22 @@ typedef struct {
   size_t argument_build;            ///< size of argument build area
   size_t size;                      ///< total size
   vector<CTacTemp*> argbuild;       ///< CTacTemp pointing to argument build area
+  vector<EAMD64Register> free_regs; ///< unused callee-saved registers
 } StackFrame;
 
+//--------------------------------------------------------------------------------------------------
+/// @brief orders symbols by name
+///
+/// Unlike ordering by address, the order does not depend on the heap layout and thus yields the
+/// same code no matter which (or how many) modules are compiled in the same process.
+///
+struct SSymbolNameLess {
+  bool operator()(const CSymbol *a, const CSymbol *b) const
+  {
+    return a->GetName() < b->GetName();
+  }
+};
+
 //--------------------------------------------------------------------------------------------------
 /// @brief AMD64 backend
 ///
@@ -130,7 +149,9 @@ class CBackendAMD64 : public CBackend {
                                  string comment="");
 
     /// @brief emit a load instruction
-    void Load(EAMD64Register dst, CTacAddr *src, string comment="");
+    /// @param width width of the destination register (4 or 8 bytes). Narrower
+    ///        operands are zero- (char, boolean) or sign-extended (integer)
+    void Load(EAMD64Register dst, CTacAddr *src, string comment="", int width=8);
 
     /// @brief emit a store instruction
     void Store(CTac *dst, EAMD64Register src, string comment="");
@@ -140,7 +161,7 @@ class CBackendAMD64 : public CBackend {
     string Operand(const CTac *op);
 
     /// @brief return an immediate for @a value
-    string Imm(int value) const;
+    string Imm(long long value) const;
 
     /// @brief return a x86-label for CTaclabel @a label
     string Label(const CTacLabel *label) const;
@@ -154,6 +175,12 @@ class CBackendAMD64 : public CBackend {
     /// @brief compute the size of operator @t
     int OperandSize(CTac *t) const;
 
+    /// @brief compute the width (4 or 8 bytes) of an operation on operand @a t
+    int OpWidth(CTac *t) const;
+
+    /// @brief return the instruction suffix for an operand of @a size bytes
+    string Suffix(int size) const;
+
     /// @brief return a string denoting the location of a symbol
     /// @param s the symbol
     /// @param ofs optional offset to add/subtract from location
@@ -164,6 +191,32 @@ class CBackendAMD64 : public CBackend {
     /// @param size size of data type in bytes
     string Reg(EAMD64Register reg, int size=8);
 
+    /// @brief return the register with the 64-bit name @a name (NUMREGS if none)
+    EAMD64Register RegByName(const string name) const;
+
+    /// @brief return the register a symbol is kept in (NUMREGS if it lives in memory)
+    EAMD64Register SymbolReg(const CSymbol *s) const;
+
+    /// @brief keep register parameters whose address is not taken in callee-saved registers
+    /// @param scope scope
+    /// @param paf [in/out] StackFrame (free_regs must be set)
+    void AllocateParamRegisters(CScope *scope, StackFrame &paf);
+
+    /// @brief keep scalar globals in the remaining callee-saved registers
+    ///
+    /// Globals are loaded at the entry of the scope and written back before calls to procedures
+    /// that may access them and at the exit; they are reloaded after calls that may modify them.
+    /// Only globals whose accesses outweigh these moves (weighted by loop depth) are promoted.
+    /// @param scope scope
+    /// @param paf [in/out] StackFrame (free_regs must be set)
+    void PromoteGlobals(CScope *scope, StackFrame &paf);
+
+    /// @brief move promoted global @a g between its register and memory
+    /// @param g global
+    /// @param store store the register to memory (true) or load it (false)
+    /// @param comment comment
+    void MoveGlobal(const CSymbol *g, bool store, string comment="");
+
     /// @brief compute the location of local variables, temporaries and arguments on the stack
     /// @param scope scope
     /// @param paf [in/out] StackFrame (return_address and saved_register must be set)
@@ -171,8 +224,41 @@ class CBackendAMD64 : public CBackend {
 
     /// @}
 
+    /// @name profiling
+    /// @{
+
+    /// @brief return the memory operand of the profile counter for @a key
+    ///
+    /// Counters are allocated on first use.
+    /// @param key counter key (see CProfile)
+    string ProfileCounter(const string key);
+
+    /// @brief emit the trampolines counting taken branches of the current scope
+    void EmitProfileTrampolines(void);
+
+    /// @brief emit the profile counters and the descriptor passed to the runtime
+    void EmitProfileData(void);
+
+    /// @brief return true if @a label heads a loop that is hot according to the profile
+    bool IsHotLoopHeader(const CTacLabel *label) const;
+
+    /// @}
+
     string _ind;                    ///< indentation
     CScope *_curr_scope;            ///< current scope
+
+    bool _instrument;               ///< emit profiling instrumentation
+    vector<string> _prof_keys;      ///< profile counter keys
+    map<string, size_t> _prof_idx;  ///< profile counter key -> index
+    vector<tuple<string, string, string>>
+                   _prof_tramp;     ///< pending trampolines (label, counter, target)
+    set<const CTacLabel*> _loop_hdr;///< loop headers of the current code block
+
+    CModRef *_modref;               ///< mod/ref summaries of the module
+    map<const CSymbol*, EAMD64Register, SSymbolNameLess>
+                   _promoted;       ///< globals kept in registers in the current scope
+    set<const CSymbol*, SSymbolNameLess>
+                   _promoted_mod;   ///< promoted globals modified in the current scope
 };
 
 
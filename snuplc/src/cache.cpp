@@ -0,0 +1,259 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation cache
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <dirent.h>
+#include <fcntl.h>
+#include <link.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "cache.h"
+#include "sha256.h"
+using namespace std;
+
+#define KEY_LENGTH            64      ///< length of a key (hexadecimal SHA-256 digest)
+#define EVICT_FRACTION        16      ///< scan after 1/EVICT_FRACTION of the limit on average
+
+/// @brief create directory @a dir and its parents
+static bool MakeDirectory(const string &dir)
+{
+  for (size_t p = dir.find('/', 1); ; p = dir.find('/', p+1)) {
+    string d = dir.substr(0, p);
+    if ((mkdir(d.c_str(), 0755) < 0) && (errno != EEXIST)) return false;
+    if (p == string::npos) break;
+  }
+
+  struct stat st;
+  return (stat(dir.c_str(), &st) == 0) && S_ISDIR(st.st_mode);
+}
+
+/// @brief read file @a path into @a data
+static bool ReadFile(const string &path, string &data)
+{
+  ifstream in(path, ios::binary);
+  if (!in.good()) return false;
+
+  ostringstream o;
+  o << in.rdbuf();
+  data = o.str();
+
+  return !in.bad();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CCache
+//
+CCache::CCache(const string dir, unsigned long long limit)
+  : _dir(dir), _limit(limit), _valid(false), _random(random_device()())
+{
+  _valid = (_dir != "") && (_limit > 0) && MakeDirectory(_dir);
+}
+
+bool CCache::IsValid(void) const
+{
+  return _valid;
+}
+
+bool CCache::Lookup(const string &key, string &entry)
+{
+  if (!_valid) return false;
+
+  string path = _dir + "/" + key;
+  if (!ReadFile(path, entry)) return false;
+
+  // mark as recently used
+  utimensat(AT_FDCWD, path.c_str(), NULL, 0);
+
+  return true;
+}
+
+void CCache::Store(const string &key, const string &entry)
+{
+  if (!_valid) return;
+
+  static atomic<unsigned long> seq(0);
+  ostringstream tmp;
+  tmp << _dir << "/.tmp-" << getpid() << "-" << seq++;
+
+  {
+    ofstream out(tmp.str(), ios::binary);
+    out << entry;
+    out.close();
+    if (out.fail()) {
+      unlink(tmp.str().c_str());
+      return;
+    }
+  }
+
+  if (rename(tmp.str().c_str(), (_dir + "/" + key).c_str()) < 0) {
+    unlink(tmp.str().c_str());
+    return;
+  }
+
+  if (ScanAfterStore(entry.size())) Evict();
+}
+
+bool CCache::IsEntry(const string &name)
+{
+  if (name.size() != KEY_LENGTH) return false;
+
+  for (char c : name) {
+    if (!(((c >= '0') && (c <= '9')) || ((c >= 'a') && (c <= 'f')))) return false;
+  }
+
+  return true;
+}
+
+bool CCache::ScanAfterStore(unsigned long long size)
+{
+  lock_guard<mutex> guard(_lock);
+
+  // probability size / (limit / EVICT_FRACTION), at least 1 for entries of that size or larger
+  double p = (double)size * EVICT_FRACTION / _limit;
+  return uniform_real_distribution<double>(0.0, 1.0)(_random) < p;
+}
+
+void CCache::Evict(void)
+{
+  lock_guard<mutex> guard(_lock);
+
+  DIR *d = opendir(_dir.c_str());
+  if (d == NULL) return;
+
+  struct SEntry {
+    string path;
+    struct timespec used;
+    unsigned long long size;
+  };
+  vector<SEntry> entries;
+  unsigned long long total = 0;
+
+  struct dirent *e;
+  while ((e = readdir(d)) != NULL) {
+    // skip unrelated files and the temporary files of entries being written
+    if (!IsEntry(e->d_name)) continue;
+
+    string path = _dir + "/" + e->d_name;
+    struct stat st;
+    if ((stat(path.c_str(), &st) < 0) || !S_ISREG(st.st_mode)) continue;
+
+    entries.push_back(SEntry { path, st.st_mtim, (unsigned long long)st.st_size });
+    total += st.st_size;
+  }
+  closedir(d);
+
+  if (total <= _limit) return;
+
+  // least recently used first
+  sort(entries.begin(), entries.end(), [](const SEntry &a, const SEntry &b) {
+    if (a.used.tv_sec != b.used.tv_sec) return a.used.tv_sec < b.used.tv_sec;
+    return a.used.tv_nsec < b.used.tv_nsec;
+  });
+
+  for (const SEntry &e : entries) {
+    if (total <= _limit) break;
+    if (unlink(e.path.c_str()) == 0) total -= e.size;
+  }
+}
+
+string CCache::GetDefaultDir(void)
+{
+  const char *xdg = getenv("XDG_CACHE_HOME");
+  if ((xdg != NULL) && (xdg[0] == '/')) return string(xdg) + "/snuplc";
+
+  const char *home = getenv("HOME");
+  if ((home != NULL) && (home[0] == '/')) return string(home) + "/.cache/snuplc";
+
+  return "";
+}
+
+/// @brief return the GNU build ID of the running executable ("" if it has none)
+static string GetBuildId(void)
+{
+  string id;
+
+  // the first object reported is the executable; its notes are mapped into memory
+  dl_iterate_phdr([](struct dl_phdr_info *info, size_t, void *data) -> int {
+    string *id = (string*)data;
+
+    for (int i=0; i<info->dlpi_phnum; i++) {
+      const ElfW(Phdr) &ph = info->dlpi_phdr[i];
+      if (ph.p_type != PT_NOTE) continue;
+
+      const char *p = (const char*)(info->dlpi_addr + ph.p_vaddr), *end = p + ph.p_memsz;
+      while (p + sizeof(ElfW(Nhdr)) <= end) {
+        const ElfW(Nhdr) *n = (const ElfW(Nhdr)*)p;
+        const char *name = p + sizeof(*n);
+        const char *desc = name + ((n->n_namesz + 3) & ~3);
+        if ((n->n_type == NT_GNU_BUILD_ID) && (n->n_namesz == 4) && !memcmp(name, "GNU", 4)) {
+          id->assign(desc, n->n_descsz);
+          return 1;
+        }
+        p = desc + ((n->n_descsz + 3) & ~3);
+      }
+    }
+
+    return 1;
+  }, &id);
+
+  return id;
+}
+
+const string& CCache::GetCompilerDigest(void)
+{
+  // the build ID is a digest of the executable computed by the linker; hashing the executable
+  // here would cost more than most compilations and is only a fallback
+  static const string digest = []() {
+    CSHA256 h;
+    string id = GetBuildId(), exe;
+
+    if (id != "") {
+      h.Update(string("build-id"));
+      h.Update(id);
+    } else if (ReadFile("/proc/self/exe", exe)) {
+      h.Update(string("exe"));
+      h.Update(exe);
+    } else {
+      h.Update(string(__DATE__ " " __TIME__));
+    }
+
+    return h.GetDigest();
+  }();
+
+  return digest;
+}
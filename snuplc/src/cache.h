@@ -0,0 +1,116 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation cache
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_CACHE_H__
+#define __SnuPL_CACHE_H__
+
+#include <mutex>
+#include <random>
+#include <string>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief on-disk compilation cache
+///
+/// Content-addressed store mapping keys (hexadecimal digests of everything that determines the
+/// result of a compilation) to entries (the encoded result). Each entry is a file named after its
+/// key in the cache directory. Entries are written to a temporary file and renamed into place, so
+/// that concurrent compilers (threads or processes) never observe partially written entries.
+/// When the total size of the entries exceeds the limit, the least recently used entries are
+/// evicted; a hit marks an entry as used by updating its modification time. Only files named
+/// like entries are counted and evicted, other files in the directory are never touched.
+///
+/// Computing the total size requires a scan of the directory. Since the entries are written by
+/// many (mostly short-lived) processes, none of which knows the total, a store triggers a scan
+/// with a probability proportional to the size of the entry; on average, the directory is scanned
+/// once every 1/EVICT_FRACTION of the limit written by all processes together.
+///
+/// The cache is safe to be used by several threads at once.
+///
+class CCache {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor
+    /// @param dir cache directory (created if necessary)
+    /// @param limit maximal total size of the entries in bytes
+    CCache(const string dir, unsigned long long limit);
+
+    /// @}
+
+    /// @brief return true if the cache directory exists or could be created
+    bool IsValid(void) const;
+
+    /// @name entries
+    /// @{
+
+    /// @brief look up the entry of @a key
+    /// @param key key
+    /// @param entry [out] entry
+    /// @retval true on a hit
+    /// @retval false on a miss
+    bool Lookup(const string &key, string &entry);
+
+    /// @brief store @a entry under @a key, evicting old entries if necessary
+    /// @param key key
+    /// @param entry entry
+    void Store(const string &key, const string &entry);
+
+    /// @}
+
+    /// @brief return the default cache directory ($XDG_CACHE_HOME/snuplc or ~/.cache/snuplc)
+    static string GetDefaultDir(void);
+
+    /// @brief return a digest identifying the running compiler
+    ///
+    /// Derived from the contents of the compiler executable: the build ID the linker computes from
+    /// them or, if the executable has none, a digest of the file. Rebuilding the compiler thus
+    /// invalidates all entries created by a different version, copies share their entries.
+    static const string& GetCompilerDigest(void);
+
+  private:
+    /// @brief return true if @a name is the file name of an entry (a key)
+    static bool IsEntry(const string &name);
+
+    /// @brief decide whether storing an entry of @a size bytes triggers an eviction scan
+    bool ScanAfterStore(unsigned long long size);
+
+    /// @brief evict least recently used entries until the limit is met
+    void Evict(void);
+
+    string _dir;                    ///< cache directory
+    unsigned long long _limit;      ///< max. total size of entries
+    bool _valid;                    ///< cache directory is usable
+    mutex _lock;                    ///< serializes evictions
+    mt19937_64 _random;             ///< random numbers for ScanAfterStore()
+};
+
+
+#endif // __SnuPL_CACHE_H__
@@ -0,0 +1,442 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL control flow graph
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+
+#include "cfg.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CBasicBlock
+//
+CBasicBlock::CBasicBlock(unsigned int id)
+  : _id(id), _taken(NULL), _fall(NULL)
+{
+}
+
+CBasicBlock::~CBasicBlock(void)
+{
+}
+
+unsigned int CBasicBlock::GetId(void) const
+{
+  return _id;
+}
+
+CTacLabel* CBasicBlock::GetLabel(void) const
+{
+  if (_instr.empty()) return NULL;
+  return dynamic_cast<CTacLabel*>(_instr.front());
+}
+
+const vector<CTacInstr*>& CBasicBlock::GetInstr(void) const
+{
+  return _instr;
+}
+
+CTacInstr* CBasicBlock::GetTerminator(void) const
+{
+  if (_instr.empty()) return NULL;
+
+  CTacInstr *last = _instr.back();
+  if (last->IsBranch() || (last->GetOperation() == opReturn)) return last;
+  return NULL;
+}
+
+CBasicBlock* CBasicBlock::GetTaken(void) const
+{
+  return _taken;
+}
+
+CBasicBlock* CBasicBlock::GetFallthrough(void) const
+{
+  return _fall;
+}
+
+bool CBasicBlock::IsExit(void) const
+{
+  CTacInstr *t = GetTerminator();
+
+  if ((t != NULL) && (t->GetOperation() == opReturn)) return true;
+  return (_fall == NULL) && (_taken == NULL);
+}
+
+const vector<CBasicBlock*>& CBasicBlock::GetSuccessors(void) const
+{
+  return _succ;
+}
+
+const vector<CBasicBlock*>& CBasicBlock::GetPredecessors(void) const
+{
+  return _pred;
+}
+
+ostream& CBasicBlock::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ BB" << _id << "  preds:";
+  for (CBasicBlock *p : _pred) out << " BB" << p->GetId();
+  out << "  succs:";
+  for (CBasicBlock *s : _succ) out << " BB" << s->GetId();
+  out << endl;
+
+  for (CTacInstr *i : _instr) {
+    i->print(out, indent+2);
+    out << endl;
+  }
+
+  out << ind << "]]" << endl;
+
+  return out;
+}
+
+ostream& operator<<(ostream &out, const CBasicBlock &b)
+{
+  return b.print(out);
+}
+
+ostream& operator<<(ostream &out, const CBasicBlock *b)
+{
+  return b->print(out);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CControlFlowGraph
+//
+CControlFlowGraph::CControlFlowGraph(CCodeBlock *cb)
+  : _cb(cb)
+{
+  assert(cb != NULL);
+
+  BuildBlocks();
+  BuildEdges();
+  FindLoops();
+}
+
+CControlFlowGraph::~CControlFlowGraph(void)
+{
+  for (CBasicBlock *b : _blocks) delete b;
+}
+
+CCodeBlock* CControlFlowGraph::GetCodeBlock(void) const
+{
+  return _cb;
+}
+
+const vector<CBasicBlock*>& CControlFlowGraph::GetBlocks(void) const
+{
+  return _blocks;
+}
+
+CBasicBlock* CControlFlowGraph::GetEntry(void) const
+{
+  return _blocks.front();
+}
+
+CBasicBlock* CControlFlowGraph::GetBlock(const CTacLabel *l) const
+{
+  auto it = _label.find(l);
+  return it != _label.end() ? it->second : NULL;
+}
+
+const vector<CBasicBlock*>& CControlFlowGraph::GetReversePostorder(void) const
+{
+  return _rpo;
+}
+
+bool CControlFlowGraph::IsBackEdge(const CBasicBlock *from, const CBasicBlock *to) const
+{
+  return _back.find(make_pair(from, to)) != _back.end();
+}
+
+bool CControlFlowGraph::IsLoopHeader(const CBasicBlock *b) const
+{
+  return _loops.find(b) != _loops.end();
+}
+
+unsigned int CControlFlowGraph::GetLoopDepth(const CBasicBlock *b) const
+{
+  unsigned int depth = 0;
+
+  for (const auto &l : _loops) {
+    if (l.second.find(b) != l.second.end()) depth++;
+  }
+
+  return depth;
+}
+
+CBasicBlock* CControlFlowGraph::GetLoopHeader(const CBasicBlock *b) const
+{
+  const CBasicBlock *header = NULL;
+  size_t size = 0;
+
+  // the innermost loop is the smallest loop containing b
+  for (const auto &l : _loops) {
+    if ((l.second.find(b) != l.second.end()) && ((header == NULL) || (l.second.size() < size))) {
+      header = l.first;
+      size = l.second.size();
+    }
+  }
+
+  return const_cast<CBasicBlock*>(header);
+}
+
+bool CControlFlowGraph::InLoop(const CBasicBlock *b, const CBasicBlock *header) const
+{
+  auto it = _loops.find(header);
+  return (it != _loops.end()) && (it->second.find(b) != it->second.end());
+}
+
+void CControlFlowGraph::RemoveInstr(CBasicBlock *b, CTacInstr *instr)
+{
+  assert((b != NULL) && (instr != NULL));
+  assert(!instr->IsBranch() && (instr->GetOperation() != opReturn) &&
+         (dynamic_cast<CTacLabel*>(instr) == NULL));
+
+  auto it = find(b->_instr.begin(), b->_instr.end(), instr);
+  assert(it != b->_instr.end());
+
+  b->_instr.erase(it);
+  _cb->RemoveInstr(instr);
+}
+
+void CControlFlowGraph::BuildBlocks(void)
+{
+  CBasicBlock *bb = NULL;
+
+  for (CTacInstr *i : _cb->GetInstr()) {
+    // labels start a new block
+    if ((bb == NULL) || ((dynamic_cast<CTacLabel*>(i) != NULL) && !bb->_instr.empty())) {
+      bb = new CBasicBlock(_blocks.size());
+      _blocks.push_back(bb);
+    }
+
+    bb->_instr.push_back(i);
+    if (CTacLabel *l = dynamic_cast<CTacLabel*>(i)) _label[l] = bb;
+
+    // branches and returns end a block
+    if (i->IsBranch() || (i->GetOperation() == opReturn)) bb = NULL;
+  }
+
+  // an empty code block still has an (empty) entry block
+  if (_blocks.empty()) _blocks.push_back(new CBasicBlock(0));
+}
+
+void CControlFlowGraph::BuildEdges(void)
+{
+  for (size_t i=0; i<_blocks.size(); i++) {
+    CBasicBlock *bb = _blocks[i];
+    CBasicBlock *next = i+1 < _blocks.size() ? _blocks[i+1] : NULL;
+    CTacInstr *t = bb->GetTerminator();
+
+    if (t == NULL) {
+      bb->_fall = next;
+    } else if (t->IsBranch()) {
+      bb->_taken = GetBlock(dynamic_cast<CTacLabel*>(t->GetDest()));
+      assert(bb->_taken != NULL);
+      if (t->GetOperation() != opGoto) bb->_fall = next;
+    }
+
+    if (bb->_taken != NULL) bb->_succ.push_back(bb->_taken);
+    if ((bb->_fall != NULL) && (bb->_fall != bb->_taken)) bb->_succ.push_back(bb->_fall);
+
+    for (CBasicBlock *s : bb->_succ) s->_pred.push_back(bb);
+  }
+}
+
+void CControlFlowGraph::FindLoops(void)
+{
+  // iterative depth-first search; an edge to a block on the DFS stack is a back edge
+  enum { white, grey, black };
+  map<const CBasicBlock*, int> color;
+  vector<pair<CBasicBlock*, size_t>> stack;
+  vector<CBasicBlock*> postorder;
+
+  stack.push_back(make_pair(GetEntry(), 0));
+  color[GetEntry()] = grey;
+
+  while (!stack.empty()) {
+    CBasicBlock *b = stack.back().first;
+    size_t &next = stack.back().second;
+
+    if (next < b->_succ.size()) {
+      CBasicBlock *s = b->_succ[next++];
+      if (color[s] == white) {
+        color[s] = grey;
+        stack.push_back(make_pair(s, 0));
+      } else if (color[s] == grey) {
+        _back.insert(make_pair(b, s));
+      }
+    } else {
+      color[b] = black;
+      postorder.push_back(b);
+      stack.pop_back();
+    }
+  }
+
+  _rpo.assign(postorder.rbegin(), postorder.rend());
+
+  // natural loop of back edge t -> h: h plus all blocks that reach t without passing h
+  for (const auto &e : _back) {
+    const CBasicBlock *h = e.second;
+    set<const CBasicBlock*> &body = _loops[h];
+    vector<const CBasicBlock*> work;
+
+    body.insert(h);
+    if (body.insert(e.first).second) work.push_back(e.first);
+
+    while (!work.empty()) {
+      const CBasicBlock *b = work.back();
+      work.pop_back();
+
+      for (const CBasicBlock *p : b->_pred) {
+        if ((color[p] != white) && body.insert(p).second) work.push_back(p);
+      }
+    }
+  }
+}
+
+ostream& CControlFlowGraph::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ CFG " << _cb->GetName() << endl;
+  for (CBasicBlock *b : _blocks) {
+    b->print(out, indent+2);
+    if (IsLoopHeader(b)) {
+      out << ind << "  (loop header, depth " << GetLoopDepth(b) << ")" << endl;
+    }
+  }
+  out << ind << "]]" << endl;
+
+  return out;
+}
+
+ostream& operator<<(ostream &out, const CControlFlowGraph &g)
+{
+  return g.print(out);
+}
+
+ostream& operator<<(ostream &out, const CControlFlowGraph *g)
+{
+  return g->print(out);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CDominatorTree
+//
+CDominatorTree::CDominatorTree(const CControlFlowGraph *cfg)
+  : _cfg(cfg)
+{
+  assert(cfg != NULL);
+
+  const vector<CBasicBlock*> &rpo = cfg->GetReversePostorder();
+  for (size_t i=0; i<rpo.size(); i++) _rpo[rpo[i]] = i;
+  if (rpo.empty()) return;
+
+  // intersect two dominators by walking up the tree in reverse postorder
+  auto intersect = [&](CBasicBlock *a, CBasicBlock *b) {
+    while (a != b) {
+      while (_rpo[a] > _rpo[b]) a = _idom[a];
+      while (_rpo[b] > _rpo[a]) b = _idom[b];
+    }
+    return a;
+  };
+
+  CBasicBlock *entry = rpo.front();
+  _idom[entry] = entry;
+
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    for (size_t i=1; i<rpo.size(); i++) {
+      CBasicBlock *b = rpo[i], *idom = NULL;
+
+      for (CBasicBlock *p : b->GetPredecessors()) {
+        if (_idom.find(p) == _idom.end()) continue;
+        idom = idom == NULL ? p : intersect(p, idom);
+      }
+
+      auto it = _idom.find(b);
+      if ((it == _idom.end()) || (it->second != idom)) {
+        _idom[b] = idom;
+        changed = true;
+      }
+    }
+  }
+}
+
+CDominatorTree::~CDominatorTree(void)
+{
+}
+
+CBasicBlock* CDominatorTree::GetIdom(const CBasicBlock *b) const
+{
+  auto it = _idom.find(b);
+  if ((it == _idom.end()) || (it->second == b)) return NULL;
+  return it->second;
+}
+
+bool CDominatorTree::Dominates(const CBasicBlock *a, const CBasicBlock *b) const
+{
+  if (!IsReachable(a) || !IsReachable(b)) return false;
+
+  size_t ra = _rpo.at(a);
+  while ((b != NULL) && (_rpo.at(b) > ra)) b = GetIdom(b);
+
+  return b == a;
+}
+
+bool CDominatorTree::IsReachable(const CBasicBlock *b) const
+{
+  return _rpo.find(b) != _rpo.end();
+}
+
+ostream& CDominatorTree::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ dominators " << _cfg->GetCodeBlock()->GetName() << endl;
+  for (CBasicBlock *b : _cfg->GetBlocks()) {
+    out << ind << "  BB" << b->GetId() << ": ";
+    if (!IsReachable(b)) out << "unreachable";
+    else if (GetIdom(b) == NULL) out << "entry";
+    else out << "idom BB" << GetIdom(b)->GetId();
+    out << endl;
+  }
+  out << ind << "]]" << endl;
+
+  return out;
+}
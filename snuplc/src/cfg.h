@@ -0,0 +1,314 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL control flow graph
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_CFG_H__
+#define __SnuPL_CFG_H__
+
+#include <iostream>
+#include <map>
+#include <set>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief basic block
+///
+/// A basic block is a maximal sequence of TAC instructions that starts with an optional label
+/// and ends with a branch, a return, or right before the next label.
+///
+class CBasicBlock {
+  friend class CControlFlowGraph;
+
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param id block id (position in the code block)
+    CBasicBlock(unsigned int id);
+
+    /// @brief destructor
+    virtual ~CBasicBlock(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the block id
+    unsigned int GetId(void) const;
+
+    /// @brief return the leading label of this block (NULL if none)
+    CTacLabel* GetLabel(void) const;
+
+    /// @brief return the instructions of this block (including the leading label)
+    const vector<CTacInstr*>& GetInstr(void) const;
+
+    /// @brief return the terminating branch or return instruction (NULL if none)
+    CTacInstr* GetTerminator(void) const;
+
+    /// @brief return the block targeted by the terminating branch (NULL if none)
+    CBasicBlock* GetTaken(void) const;
+
+    /// @brief return the block control falls through to (NULL if none)
+    CBasicBlock* GetFallthrough(void) const;
+
+    /// @brief returns true if control leaves the scope at the end of this block
+    bool IsExit(void) const;
+
+    /// @brief return the successors of this block
+    const vector<CBasicBlock*>& GetSuccessors(void) const;
+
+    /// @brief return the predecessors of this block
+    const vector<CBasicBlock*>& GetPredecessors(void) const;
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the block to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  protected:
+    unsigned int _id;                ///< block id
+    vector<CTacInstr*> _instr;       ///< instructions
+    CBasicBlock *_taken;             ///< branch target
+    CBasicBlock *_fall;              ///< fall-through successor
+    vector<CBasicBlock*> _succ;      ///< successors
+    vector<CBasicBlock*> _pred;      ///< predecessors
+};
+
+/// @name CBasicBlock output operators
+/// @{
+
+/// @brief CBasicBlock output operator
+///
+/// @param out output stream
+/// @param b reference to CBasicBlock
+/// @retval output stream
+ostream& operator<<(ostream &out, const CBasicBlock &b);
+
+/// @brief CBasicBlock output operator
+///
+/// @param out output stream
+/// @param b reference to CBasicBlock
+/// @retval output stream
+ostream& operator<<(ostream &out, const CBasicBlock *b);
+
+/// @}
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief control flow graph
+///
+/// control flow graph of a code block including the natural loops. The graph is a snapshot;
+/// it has to be rebuilt after the instruction list of the code block has been modified.
+///
+class CControlFlowGraph {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param cb code block
+    CControlFlowGraph(CCodeBlock *cb);
+
+    /// @brief destructor
+    virtual ~CControlFlowGraph(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the code block
+    CCodeBlock* GetCodeBlock(void) const;
+
+    /// @brief return the basic blocks in instruction order
+    const vector<CBasicBlock*>& GetBlocks(void) const;
+
+    /// @brief return the entry block
+    CBasicBlock* GetEntry(void) const;
+
+    /// @brief return the block starting with label @a l (NULL if none)
+    CBasicBlock* GetBlock(const CTacLabel *l) const;
+
+    /// @brief return the reachable blocks in reverse postorder
+    const vector<CBasicBlock*>& GetReversePostorder(void) const;
+
+    /// @}
+
+
+    /// @name loops
+    /// @{
+
+    /// @brief returns true if @a from -> @a to is a back edge
+    bool IsBackEdge(const CBasicBlock *from, const CBasicBlock *to) const;
+
+    /// @brief returns true if @a b is the header of a natural loop
+    bool IsLoopHeader(const CBasicBlock *b) const;
+
+    /// @brief return the number of natural loops containing @a b
+    unsigned int GetLoopDepth(const CBasicBlock *b) const;
+
+    /// @brief return the header of the innermost loop containing @a b (NULL if none)
+    CBasicBlock* GetLoopHeader(const CBasicBlock *b) const;
+
+    /// @brief returns true if @a b is part of the loop headed by @a header
+    bool InLoop(const CBasicBlock *b, const CBasicBlock *header) const;
+
+    /// @}
+
+
+    /// @name modification
+    /// @{
+
+    /// @brief remove instruction @a instr from block @a b and the code block
+    ///
+    /// Only instructions that do not affect the control flow (no labels, branches, or returns)
+    /// can be removed; the graph remains valid.
+    ///
+    /// @param b basic block containing @a instr
+    /// @param instr instruction
+    void RemoveInstr(CBasicBlock *b, CTacInstr *instr);
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the graph to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  private:
+    /// @brief split the instructions of the code block into basic blocks
+    void BuildBlocks(void);
+
+    /// @brief connect the basic blocks
+    void BuildEdges(void);
+
+    /// @brief compute the reverse postorder, back edges, and natural loops
+    void FindLoops(void);
+
+    CCodeBlock *_cb;                 ///< code block
+    vector<CBasicBlock*> _blocks;    ///< basic blocks in instruction order
+    map<const CTacLabel*, CBasicBlock*> _label; ///< label -> block
+    vector<CBasicBlock*> _rpo;       ///< reverse postorder
+    set<pair<const CBasicBlock*, const CBasicBlock*>> _back; ///< back edges
+    map<const CBasicBlock*, set<const CBasicBlock*>> _loops; ///< loop header -> loop body
+};
+
+/// @name CControlFlowGraph output operators
+/// @{
+
+/// @brief CControlFlowGraph output operator
+///
+/// @param out output stream
+/// @param g reference to CControlFlowGraph
+/// @retval output stream
+ostream& operator<<(ostream &out, const CControlFlowGraph &g);
+
+/// @brief CControlFlowGraph output operator
+///
+/// @param out output stream
+/// @param g reference to CControlFlowGraph
+/// @retval output stream
+ostream& operator<<(ostream &out, const CControlFlowGraph *g);
+
+/// @}
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief dominator tree
+///
+/// immediate dominators of the reachable blocks of a control flow graph (Cooper, Harvey, Kennedy:
+/// "A Simple, Fast Dominance Algorithm"). Like the graph, the tree is a snapshot.
+///
+class CDominatorTree {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param cfg control flow graph
+    CDominatorTree(const CControlFlowGraph *cfg);
+
+    /// @brief destructor
+    virtual ~CDominatorTree(void);
+
+    /// @}
+
+
+    /// @name properties
+    /// @{
+
+    /// @brief return the immediate dominator of @a b (NULL for the entry and unreachable blocks)
+    CBasicBlock* GetIdom(const CBasicBlock *b) const;
+
+    /// @brief returns true if @a a dominates @a b (every block dominates itself)
+    bool Dominates(const CBasicBlock *a, const CBasicBlock *b) const;
+
+    /// @brief returns true if @a b is reachable from the entry block
+    bool IsReachable(const CBasicBlock *b) const;
+
+    /// @}
+
+
+    /// @name output
+    /// @{
+
+    /// @brief print the tree to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  private:
+    const CControlFlowGraph *_cfg;   ///< control flow graph
+    map<const CBasicBlock*, size_t> _rpo;        ///< block -> reverse postorder number
+    map<const CBasicBlock*, CBasicBlock*> _idom; ///< block -> immediate dominator
+};
+
+
+#endif // __SnuPL_CFG_H__
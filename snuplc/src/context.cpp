@@ -0,0 +1,55 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation context
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include "ast.h"
+#include "context.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CContext
+//
+CContext::CContext(void)
+{
+  _prev_atoms = CAtomTable::Set(&_atoms);
+  _prev_types = CTypeManager::Set(&_types);
+
+  _prev_node_id = CAstNode::_global_id;
+  _prev_str_idx = CAstStringConstant::_idx;
+  CAstNode::_global_id = 0;
+  CAstStringConstant::_idx = 0;
+}
+
+CContext::~CContext(void)
+{
+  CAtomTable::Set(_prev_atoms);
+  CTypeManager::Set(_prev_types);
+
+  CAstNode::_global_id = _prev_node_id;
+  CAstStringConstant::_idx = _prev_str_idx;
+}
@@ -0,0 +1,76 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation context
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_CONTEXT_H__
+#define __SnuPL_CONTEXT_H__
+
+#include "atom.h"
+#include "type.h"
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief compilation context
+///
+/// Holds the state that is shared by all phases of the compilation of one module: the atom table,
+/// the type manager and the counters used to number AST nodes and string constants. Creating a
+/// context makes it the active context of the calling thread; destroying it restores the previous
+/// one. Compilations running on different threads thus never share any mutable state, and the
+/// output of a compilation does not depend on the modules compiled before it.
+///
+/// All objects created during the compilation (tokens, AST, TAC) must be destroyed before the
+/// context.
+///
+class CContext {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor; activate the new context on the calling thread
+    CContext(void);
+
+    /// @brief destructor; re-activate the previous context
+    ~CContext(void);
+
+    /// @}
+
+  private:
+    CContext(const CContext&) = delete;
+    CContext& operator=(const CContext&) = delete;
+
+    CAtomTable    _atoms;         ///< atom table
+    CTypeManager  _types;         ///< type manager
+
+    CAtomTable   *_prev_atoms;    ///< atom table of the previous context
+    CTypeManager *_prev_types;    ///< type manager of the previous context
+    int           _prev_node_id;  ///< next AST node id of the previous context
+    int           _prev_str_idx;  ///< string constant counter of the previous context
+};
+
+
+#endif // __SnuPL_CONTEXT_H__
@@ -55,7 +55,24 @@ struct {
   { "run-dot", ptFlag,   "(do not) run the dot command automatically.",         "0" },
   { "console", ptFlag,   "output assembly code to console (instead of a file).","0" },
   { "exe",     ptFlag,   "(do not) run assembler on generated assembly code.",  "0" },
+  { "interpret",ptFlag,  "(do not) run the IR directly instead of generating code.","0" },
   { "lib-path",ptSetting,"path to SnuPL/2 libraries.",                       "rte/" },
+  { "opt-level",ptSetting,"optimization level 0-2 (also -O0, -O1, -O2).",         "1" },
+  { "passes",  ptSetting,"comma-separated list of optimization passes to run.",   "" },
+  { "print-after",ptSetting,"output the IR after the given passes (or 'all').",   "" },
+  { "emit-ir", ptFlag,   "(do not) output the optimized IR in binary form.",    "0" },
+  { "emit-ir-after",ptSetting,"output the binary IR after the given passes (or 'all').", "" },
+  { "layout",  ptFlag,   "(do not) optimize the basic block layout.",         "1" },
+  { "instrument",ptFlag, "(do not) instrument code with edge and call counters.","0" },
+  { "profile-use",ptSetting,"use execution profile in file for optimizations.",   "" },
+  { "jobs",    ptSetting,"number of files to compile in parallel (also -j N).", "1" },
+  { "server",  ptSetting,"run as compile server listening on the given socket.",  "" },
+  { "connect", ptSetting,"compile on the server listening on the given socket.", "" },
+  { "cache",   ptFlag,   "(do not) reuse results of earlier compilations.",     "0" },
+  { "cache-dir",ptSetting,"compilation cache directory (default: ~/.cache/snuplc).", "" },
+  { "cache-size",ptSetting,"max. size of the compilation cache in MiB.",         "256" },
+  { "time-report",ptFlag, "(do not) print the time and memory used per phase.",  "0" },
+  { "time-report-json",ptSetting,"write the time and memory report to file (JSON).", "" },
   { "target",  ptTarget, "target architecture.",                           "x86-64" },
   { "help",    ptSwitch, "print this help.",                                    "0" },
   { NULL }
@@ -66,6 +83,7 @@ struct {
 //
 
 CEnvironment* CEnvironment::_globenv= NULL;
+thread_local CEnvironment* CEnvironment::_curenv = NULL;
 
 CEnvironment::CEnvironment(void)
   : _active_target(NULL), _active_file("")
@@ -103,14 +121,28 @@ void CEnvironment::InitDefaultConfig(void)
 
 CEnvironment* CEnvironment::Get(void)
 {
-  if (_globenv == NULL) {
-    _globenv = new CEnvironment();
-    RegisterTargets(_globenv);
-  }
+  if (_curenv != NULL) return _curenv;
+
+  if (_globenv == NULL) _globenv = Create();
 
   return _globenv;
 }
 
+CEnvironment* CEnvironment::Create(void)
+{
+  CEnvironment *env = new CEnvironment();
+  RegisterTargets(env);
+
+  return env;
+}
+
+CEnvironment* CEnvironment::Set(CEnvironment *env)
+{
+  CEnvironment *prev = _curenv;
+  _curenv = env;
+  return prev;
+}
+
 void CEnvironment::Syntax(string msg)
 {
   if (msg != "") cout << msg << endl << endl;
@@ -212,19 +244,75 @@ void CEnvironment::Syntax(string msg)
        << "  compile fibonacci.mod and also output the IR in textual and graphical form" << endl
        << "  The IR is saved in fibonacci.mod.tac (textual) and fibonacci.mod.tac.dot (graphical form)" << endl
        << "  $ snuplc --tac fibonacci.mod" << endl
+       << endl
+       << "  profile-guided optimization: build an instrumented executable, run it on a" << endl
+       << "  representative input (writes fibonacci.prof), then recompile using the profile" << endl
+       << "  and the same optimization options" << endl
+       << "  $ snuplc --exe --instrument fibonacci.mod && ./fibonacci < input" << endl
+       << "  $ snuplc --exe --profile-use=fibonacci.prof fibonacci.mod" << endl
+       << endl
+       << "  compile all modules in the current directory using four threads" << endl
+       << "  $ snuplc -j 4 *.mod" << endl
+       << endl
+       << "  start a compile server, then compile fibonacci.mod on it" << endl
+       << "  $ snuplc --server=/tmp/snuplc.sock &" << endl
+       << "  $ snuplc --connect=/tmp/snuplc.sock --exe fibonacci.mod" << endl
+       << endl
+       << "  compile fibonacci.mod with all optimizations and output the IR after each pass" << endl
+       << "  $ snuplc -O2 --print-after=all fibonacci.mod" << endl
+       << endl
+       << "  print the time and memory used by each compilation phase" << endl
+       << "  $ snuplc --time-report fibonacci.mod" << endl
+       << endl
+       << "  reuse the results of earlier compilations stored in the compilation cache" << endl
+       << "  (~/.cache/snuplc unless --cache-dir is given)" << endl
+       << "  $ snuplc --cache *.mod" << endl
+       << endl
+       << "  run fibonacci.mod in the IR interpreter (compiler messages go to stderr)" << endl
+       << "  $ snuplc --interpret fibonacci.mod < input" << endl
+       << endl
+       << "  save the optimized IR in binary form to fibonacci.mod.ir, then generate code from it" << endl
+       << "  (IR files are accepted wherever source files are)" << endl
+       << "  $ snuplc --emit-ir fibonacci.mod" << endl
+       << "  $ snuplc -O0 fibonacci.mod.ir" << endl
        << endl;
 
   exit(EXIT_FAILURE);
 }
 
 void CEnvironment::ParseArguments(int argc, char *argv[])
+{
+  string error;
+  if (!ParseArguments(argc, argv, error)) Syntax(error);
+
+  bool b = false;
+  if (GetSwitch("help", b) && b) Syntax("");
+}
+
+bool CEnvironment::ParseArguments(int argc, char *argv[], string &error)
 {
   int i = 1;
 
   while (i < argc) {
     char *str = argv[i];
 
-    if ((strlen(str) > 2) && !strncmp(str, "--", 2)) {
+    if (!strncmp(str, "-j", 2)) {
+      // -j N or -jN is a shorthand for --jobs=N
+      auto c = _config.find("jobs");
+      if (str[2] != '\0') get<2>(c->second) = string(str+2);
+      else {
+        if (i+1 == argc) {
+          error = "Missing argument after " + string(argv[i]);
+          return false;
+        }
+        get<2>(c->second) = string(argv[++i]);
+      }
+    }
+    else if (!strncmp(str, "-O", 2)) {
+      // -O<level> is a shorthand for --opt-level=<level>; -O means -O1
+      get<2>(_config.find("opt-level")->second) = str[2] != '\0' ? string(str+2) : "1";
+    }
+    else if ((strlen(str) > 2) && !strncmp(str, "--", 2)) {
       str += 2;
 
       bool bval = true;
@@ -233,12 +321,26 @@ void CEnvironment::ParseArguments(int argc, char *argv[])
         bval = false;
       }
 
-      string key = string(str);
+      // settings may also be given as --key=value
+      string key = string(str), value;
+      bool has_value = false;
+      size_t eq = key.find('=');
+      if (eq != string::npos) {
+        value = key.substr(eq+1);
+        key.erase(eq);
+        has_value = true;
+      }
 
       auto c = _config.find(key);
 
       if (c == _config.end()) {
-        Syntax("Unknown command line option '" + string(argv[i]) + "'.");
+        error = "Unknown command line option '" + string(argv[i]) + "'.";
+        return false;
+
+      } else if (has_value &&
+                 (get<0>(c->second) != ptSetting) && (get<0>(c->second) != ptTarget)) {
+        error = "Option '--" + key + "' does not take an argument.";
+        return false;
 
       } else if (get<0>(c->second) == ptFlag) {
         // flags can be turned on or off
@@ -250,36 +352,47 @@ void CEnvironment::ParseArguments(int argc, char *argv[])
 
       } else if (get<0>(c->second) == ptSetting) {
         // settings take the following argument as a parameter
-        if (i+1 == argc) Syntax("Missing argument after " + string(argv[i]));
-        get<2>(c->second) = string(argv[++i]);
+        if (has_value) get<2>(c->second) = value;
+        else {
+          if (i+1 == argc) {
+            error = "Missing argument after " + string(argv[i]);
+            return false;
+          }
+          get<2>(c->second) = string(argv[++i]);
+        }
 
       } else if (get<0>(c->second) == ptTarget) {
         // target takes the following argument as a parameter
-        if (i+1 == argc) Syntax("Missing argument after " + string(argv[i]));
-        get<2>(c->second) = string(argv[++i]);
+        if (has_value) get<2>(c->second) = value;
+        else {
+          if (i+1 == argc) {
+            error = "Missing argument after " + string(argv[i]);
+            return false;
+          }
+          get<2>(c->second) = string(argv[++i]);
+        }
 
       } else {
-        cerr << "Internal error in " << __FILE__ << ":" << __LINE__ 
-             << " (" << __FUNCTION__ << ")" << endl;
-        exit(EXIT_FAILURE);
+        error = "Internal error in " + string(__FILE__) + ":" + to_string(__LINE__) +
+                " (" + __FUNCTION__ + ")";
+        return false;
       }
     }
     else AddFile(argv[i]);
     i++;
   }
 
-  bool b = false;
-  if (GetSwitch("help", b) && b) Syntax("");
-
   string t;
   if (GetConfig("target", t)) {
     if (!SetTarget(t)) {
-      Syntax("Unsupported target: '" + t + "'.");
+      error = "Unsupported target: '" + t + "'.";
+      return false;
     }
   }
+
+  return true;
 }
 
-/*
 bool CEnvironment::SetConfig(const string key, const string value)
 {
   auto it = _config.find(key);
@@ -288,7 +401,6 @@ bool CEnvironment::SetConfig(const string key, const string value)
 
   return (it != _config.end());
 }
-*/
 
 bool CEnvironment::GetFlag(const string key, bool &value) const
 {
@@ -332,6 +444,15 @@ bool CEnvironment::GetConfig(const string key, string &value) const
   return (it != _config.end());
 }
 
+map<string, string> CEnvironment::GetConfiguration(void) const
+{
+  map<string, string> config;
+
+  for (const auto &c : _config) config[c.first] = get<2>(c.second);
+
+  return config;
+}
+
 void CEnvironment::AddTarget(CTarget *t, bool active)
 {
   assert(t != NULL);
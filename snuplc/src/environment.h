@@ -57,9 +57,24 @@ class CEnvironment {
   friend void RegisterTargets(CEnvironment*);  // from target.cpp
 
   public:
-    /// @brief return the global type manager
+    /// @brief return the environment of the calling thread (the global environment unless another
+    ///        one has been activated with Set())
     static CEnvironment* Get(void);
 
+    /// @brief create a new environment with default settings
+    ///
+    /// Used by the compile server to compile each request with the options of its client.
+    static CEnvironment* Create(void);
+
+    /// @brief make @a env the environment of the calling thread
+    ///
+    /// @param env environment (NULL: use the global environment)
+    /// @retval the previously active environment of the calling thread (or NULL)
+    static CEnvironment* Set(CEnvironment *env);
+
+    /// @brief destructor
+    virtual ~CEnvironment(void);
+
 
     /// @name command line argument parsing and help
     /// @{
@@ -69,11 +84,23 @@ class CEnvironment {
     void Syntax(string msg);
 
 
-    /// @brief parse command line arguments
+    /// @brief parse command line arguments; prints the syntax and exits on errors or --help
     /// @parm argc number of arguments
     /// @parm argv argument aray
     void ParseArguments(int argc, char *argv[]);
 
+    /// @brief parse command line arguments without exiting on errors
+    ///
+    /// Used by the compile server to parse the arguments of a request. --help is recorded but
+    /// not acted upon.
+    ///
+    /// @param argc number of arguments
+    /// @param argv argument array
+    /// @param error [out] error message if the arguments are invalid
+    /// @retval true on success
+    /// @retval false if an argument is invalid (see @a error)
+    bool ParseArguments(int argc, char *argv[], string &error);
+
     /// @e}
 
 
@@ -86,6 +113,13 @@ class CEnvironment {
     bool GetSetting(const string key, string &value) const;
     bool GetConfig(const string key, string &value) const;
 
+    /// @brief set the value of the configuration setting @a key to @a value
+    /// @retval true if @a key exists
+    bool SetConfig(const string key, const string value);
+
+    /// @brief return all configuration settings (key, value)
+    map<string, string> GetConfiguration(void) const;
+
 
     /// @}
 
@@ -131,7 +165,6 @@ class CEnvironment {
     /// @{
 
     CEnvironment(void);
-    virtual ~CEnvironment(void);
 
     /// @}
 
@@ -152,6 +185,8 @@ class CEnvironment {
     string            _active_file; ///< active file (currently being compiled)
 
     static CEnvironment  *_globenv; ///< global CEnvironment instance
+    static thread_local CEnvironment
+                         *_curenv;  ///< environment activated on the current thread
 };
 
 /// @name CEnvironment output operators
@@ -0,0 +1,721 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL/2 TAC interpreter
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <climits>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <sstream>
+
+#include "interpreter.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// array layout
+//
+// The header of an array holds the number of dimensions and the size of each dimension as
+// 4-byte integers; the data follows 8-byte aligned (see rte/x86-64/ARRAY.s).
+//
+
+/// @brief return the header of an array of type @a t
+static vector<int> ArrayHeader(const CArrayType *t)
+{
+  vector<int> h(1, t->GetNDim());
+
+  const CType *e = t;
+  while (e->IsArray()) {
+    const CArrayType *a = dynamic_cast<const CArrayType*>(e);
+    h.push_back(a->GetNElem());
+    e = a->GetInnerType();
+  }
+
+  return h;
+}
+
+/// @brief return the offset of the data of an array with @a ndim dimensions (DOFS)
+static size_t DataOffset(long long ndim)
+{
+  return 4 + 4*ndim + (ndim % 2 == 0 ? 4 : 0);
+}
+
+//--------------------------------------------------------------------------------------------------
+// CInterpreter
+//
+CInterpreter::CInterpreter(const CModule *m, size_t stack_size)
+  : _gmem(NULL), _gsize(0), _stack(NULL), _ssize(stack_size / sizeof(long long)), _sp(NULL),
+    _in(NULL), _out(NULL)
+{
+  assert(m != NULL);
+  Decode(m);
+}
+
+CInterpreter::~CInterpreter(void)
+{
+  delete [] _gmem;
+  delete [] _stack;
+}
+
+bool CInterpreter::Run(istream &in, ostream &out)
+{
+  if (_error != "") return false;
+
+  _in = &in;
+  _out = &out;
+  if (_stack == NULL) _stack = new long long[_ssize];
+  _sp = _stack;
+  _frames.clear();
+  _obuf.clear();
+
+  bool ok = Call(NULL, 0, 0) && Execute();
+  Flush();
+
+  return ok;
+}
+
+string CInterpreter::GetErrorMessage(void) const
+{
+  return _error;
+}
+
+inline long long CInterpreter::Normalize(long long v, EValueType type)
+{
+  switch (type) {
+    case vtInt:  return (int)v;
+    case vtByte: return (unsigned char)v;
+    default:     return v;
+  }
+}
+
+void CInterpreter::Decode(const CModule *m)
+{
+  // arguments of the built-in routines
+  _args.resize(2);
+
+  // the module comes first, followed by all (nested) subscopes
+  vector<const CScope*> scopes(1, m);
+  for (size_t i=0; i<scopes.size(); i++) {
+    for (const CScope *s : scopes[i]->GetSubscopes()) scopes.push_back(s);
+  }
+
+  for (size_t i=0; i<scopes.size(); i++) {
+    SProcedure p;
+    p.scope = scopes[i];
+    p.entry = p.arrays = p.frame = 0;
+    _procs.push_back(p);
+
+    if (const CSymbol *d = scopes[i]->GetDeclaration()) _procidx[d] = i;
+  }
+
+  // global scalars get a global slot, global arrays and strings are laid out in global memory
+  vector<pair<const CSymbol*, size_t> > arrays;
+  for (const CScope *s : scopes) DecodeGlobals(s, arrays);
+
+  _gmem = new char[_gsize]();
+  for (const auto &a : arrays) {
+    const CArrayType *t = dynamic_cast<const CArrayType*>(a.first->GetDataType());
+    vector<int> h = ArrayHeader(t);
+    char *data = _gmem + a.second + DataOffset(t->GetNDim());
+
+    memcpy(_gmem + a.second, h.data(), h.size()*sizeof(int));
+
+    const CDataInitString *di = dynamic_cast<const CDataInitString*>(a.first->GetData());
+    if (di != NULL) {
+      string s = di->GetData();
+      memcpy(data, s.data(), min(s.size(), (size_t)t->GetDataSize()));
+    }
+
+    SOperand o = { okConst, vtLong, (long long)(intptr_t)(_gmem + a.second) };
+    _globalops[a.first] = o;
+  }
+
+  for (size_t p=0; p<_procs.size(); p++) DecodeScope(p);
+}
+
+void CInterpreter::DecodeGlobals(const CScope *scope,
+                                 vector<pair<const CSymbol*, size_t> > &arrays)
+{
+  for (const CSymbol *s : scope->GetSymbolTable()->GetSymbols()) {
+    if (s->GetSymbolType() != stGlobal) continue;
+
+    const CType *t = s->GetDataType();
+    if (t->IsArray()) {
+      const CArrayType *a = dynamic_cast<const CArrayType*>(t);
+      _gsize = (_gsize + 7) & ~(size_t)7;
+      arrays.push_back(make_pair(s, _gsize));
+      _gsize += DataOffset(a->GetNDim()) + a->GetDataSize();
+    } else {
+      SOperand o = { okGlobal, ValueType(t), (long long)_globals.size() };
+      _globalops[s] = o;
+      _globals.push_back(0);
+    }
+  }
+}
+
+void CInterpreter::DecodeScope(size_t p)
+{
+  SProcedure &proc = _procs[p];
+  const vector<CSymbol*> &symbols = proc.scope->GetSymbolTable()->GetSymbols();
+
+  _localops.clear();
+
+  // local arrays come first in the frame
+  size_t ofs = 0;
+  for (const CSymbol *s : symbols) {
+    if ((s->GetSymbolType() != stLocal) || !s->GetDataType()->IsArray()) continue;
+
+    const CArrayType *a = dynamic_cast<const CArrayType*>(s->GetDataType());
+    SOperand o = { okFrame, vtLong, (long long)ofs };
+    _localops[s] = o;
+    proc.headers.push_back(make_pair(ofs, ArrayHeader(a)));
+    ofs += (DataOffset(a->GetNDim()) + a->GetDataSize() + 7) & ~(size_t)7;
+  }
+  proc.arrays = proc.frame = ofs / sizeof(long long);
+
+  // followed by the parameters in the order of their index and all other slots
+  const CSymProc *decl = dynamic_cast<const CSymProc*>(proc.scope->GetDeclaration());
+  if (decl != NULL) {
+    proc.params.resize(decl->GetNParams(), vtLong);
+    proc.frame += decl->GetNParams();
+    if (_args.size() < decl->GetNParams()) _args.resize(decl->GetNParams());
+  }
+
+  for (const CSymbol *s : symbols) {
+    if (s->GetSymbolType() != stParam) continue;
+
+    size_t index = dynamic_cast<const CSymParam*>(s)->GetIndex();
+    assert(index < proc.params.size());
+    SOperand o = { okLocal, ValueType(s->GetDataType()), (long long)(proc.arrays + index) };
+    _localops[s] = o;
+    proc.params[index] = o.type;
+  }
+
+  // instructions
+  map<const CTac*, size_t> labels;
+  vector<size_t> branches;
+
+  proc.entry = _code.size();
+  for (CTacInstr *t : proc.scope->GetCodeBlock()->GetInstr()) {
+    EOperation op = t->GetOperation();
+
+    if (op == opLabel) {
+      labels[t] = _code.size();
+      continue;
+    }
+    if (op == opNop) continue;
+
+    SInstr i;
+    i.op = op;
+    i.width = 8;
+    i.target = 0;
+    i.dst = i.src1 = i.src2 = DecodeOperand(NULL, p);
+    i.tac = t;
+
+    if (IsRelOp(op) || (op == opGoto)) {
+      branches.push_back(_code.size());
+      i.src1 = DecodeOperand(t->GetSrc(1), p);
+      i.src2 = DecodeOperand(t->GetSrc(2), p);
+
+      // like the backend, compare with the width of the non-constant operand
+      if (dynamic_cast<CTacConst*>(t->GetSrc(1))) i.width = Width(t->GetSrc(2));
+      else if (dynamic_cast<CTacConst*>(t->GetSrc(2))) i.width = Width(t->GetSrc(1));
+      else if (op != opGoto) i.width = max(Width(t->GetSrc(1)), Width(t->GetSrc(2)));
+    } else if (op == opCall) {
+      const CSymbol *callee = dynamic_cast<CTacName*>(t->GetSrc(1))->GetSymbol();
+      auto it = _procidx.find(callee);
+
+      if (it != _procidx.end()) {
+        i.target = it->second;
+      } else {
+        EBuiltin b = Builtin(callee->GetName());
+        if (b == biNone) DecodeError("unsupported external procedure '" + callee->GetName() + "'");
+        i.target = -1 - (long long)b;
+      }
+      i.dst = DecodeOperand(t->GetDest(), p);
+    } else if (op == opParam) {
+      i.target = dynamic_cast<CTacConst*>(t->GetDest())->GetValue();
+      i.src1 = DecodeOperand(t->GetSrc(1), p);
+      if (_args.size() <= (size_t)i.target) _args.resize(i.target + 1);
+    } else {
+      i.dst = DecodeOperand(t->GetDest(), p);
+      i.src1 = DecodeOperand(t->GetSrc(1), p);
+      i.src2 = DecodeOperand(t->GetSrc(2), p);
+      if (t->GetDest() != NULL) i.width = Width(t->GetDest());
+    }
+
+    _code.push_back(i);
+  }
+
+  // falling off the end of a scope returns to the caller
+  SInstr ret;
+  ret.op = opReturn;
+  ret.width = 8;
+  ret.target = 0;
+  ret.dst = ret.src1 = ret.src2 = DecodeOperand(NULL, p);
+  ret.tac = NULL;
+  _code.push_back(ret);
+
+  for (size_t b : branches) {
+    auto it = labels.find(_code[b].tac->GetDest());
+    if (it == labels.end()) {
+      DecodeError("undefined branch target in '" + proc.scope->GetName() + "'");
+    } else {
+      _code[b].target = it->second;
+    }
+  }
+}
+
+CInterpreter::SOperand CInterpreter::DecodeOperand(const CTac *op, size_t p)
+{
+  SOperand o = { okNone, vtLong, 0 };
+
+  if (op == NULL) return o;
+
+  if (const CTacConst *c = dynamic_cast<const CTacConst*>(op)) {
+    o.kind = okConst;
+    o.type = ValueType(c->GetType());
+    o.value = c->GetValue();
+  } else if (const CTacReference *r = dynamic_cast<const CTacReference*>(op)) {
+    SOperand ptr = Lookup(r->GetSymbol(), p);
+    if ((ptr.kind != okLocal) && (ptr.kind != okGlobal)) {
+      DecodeError("invalid reference '" + r->GetSymbol()->GetName() + "'");
+    }
+    o.kind = ptr.kind == okGlobal ? okDerefGlobal : okDerefLocal;
+    o.type = ValueType(ElementType(r->GetDerefSymbol()));
+    o.value = ptr.value;
+  } else if (const CTacName *n = dynamic_cast<const CTacName*>(op)) {
+    o = Lookup(n->GetSymbol(), p);
+  } else {
+    DecodeError("unsupported operand");
+  }
+
+  return o;
+}
+
+CInterpreter::SOperand CInterpreter::Lookup(const CSymbol *s, size_t p)
+{
+  auto it = _localops.find(s);
+  if (it != _localops.end()) return it->second;
+
+  it = _globalops.find(s);
+  if (it != _globalops.end()) return it->second;
+
+  // temporaries and local scalars get the next free slot
+  SOperand o = { okConst, vtLong, 0 };
+  if ((s->GetSymbolType() == stLocal) && !s->GetDataType()->IsArray()) {
+    o.kind = okLocal;
+    o.type = ValueType(s->GetDataType());
+    o.value = _procs[p].frame++;
+    _localops[s] = o;
+  } else {
+    DecodeError("unsupported operand '" + s->GetName() + "'");
+  }
+
+  return o;
+}
+
+void CInterpreter::DecodeError(const string &msg)
+{
+  if (_error == "") _error = msg;
+}
+
+CInterpreter::EValueType CInterpreter::ValueType(const CType *t)
+{
+  if (t == NULL) return vtLong;
+  if (t->IsInteger()) return vtInt;
+  if (t->IsChar() || t->IsBoolean()) return vtByte;
+  return vtLong;
+}
+
+const CType* CInterpreter::ElementType(const CSymbol *s)
+{
+  // references point to elements of arrays or of arrays passed by pointer
+  const CType *t = s->GetDataType();
+  if (t->IsPointer()) t = dynamic_cast<const CPointerType*>(t)->GetBaseType();
+
+  const CArrayType *a = dynamic_cast<const CArrayType*>(t);
+  return a != NULL ? a->GetBaseType() : t;
+}
+
+int CInterpreter::Width(const CTac *t)
+{
+  int size = 8;
+
+  if (const CTacConst *c = dynamic_cast<const CTacConst*>(t)) {
+    if (c->GetType() != NULL) size = c->GetType()->GetSize();
+  } else if (const CTacReference *r = dynamic_cast<const CTacReference*>(t)) {
+    size = ElementType(r->GetDerefSymbol())->GetDataSize();
+  } else if (const CTacAddr *a = dynamic_cast<const CTacAddr*>(t)) {
+    size = a->GetType()->GetSize();
+  }
+
+  return size <= 4 ? 4 : 8;
+}
+
+CInterpreter::EBuiltin CInterpreter::Builtin(const string &name)
+{
+  static const char *names[] = {
+    "DIM", "DOFS",
+    "ReadInt", "ReadLong",
+    "WriteInt", "WriteLong", "WriteStr", "WriteChar", "WriteLn",
+  };
+
+  for (int b=0; b<biNone; b++) {
+    if (name == names[b]) return (EBuiltin)b;
+  }
+  return biNone;
+}
+
+inline bool CInterpreter::Load(const SInstr *i, const SOperand &o, long long *fp, long long &v)
+{
+  switch (o.kind) {
+    case okLocal:  v = fp[o.value]; return true;
+    case okConst:  v = o.value; return true;
+    case okGlobal: v = _globals[o.value]; return true;
+    case okFrame:  v = (long long)(intptr_t)((char*)fp + o.value); return true;
+    default:       return LoadMemory(i, o, fp, v);
+  }
+}
+
+inline bool CInterpreter::Store(const SInstr *i, const SOperand &o, long long *fp, long long v)
+{
+  switch (o.kind) {
+    case okLocal:  fp[o.value] = Normalize(v, o.type); return true;
+    case okGlobal: _globals[o.value] = Normalize(v, o.type); return true;
+    default:       return StoreMemory(i, o, fp, v);
+  }
+}
+
+bool CInterpreter::LoadMemory(const SInstr *i, const SOperand &o, long long *fp, long long &v)
+{
+  char *a;
+
+  switch (o.kind) {
+    case okDerefLocal:  a = (char*)(intptr_t)fp[o.value]; break;
+    case okDerefGlobal: a = (char*)(intptr_t)_globals[o.value]; break;
+    default:            return Error(i, "invalid operand");
+  }
+
+  switch (o.type) {
+    case vtByte: {
+      if (!Valid(a, 1)) return Error(i, "invalid memory access");
+      v = *(unsigned char*)a;
+      break;
+    }
+    case vtInt: {
+      int x;
+      if (!Valid(a, 4)) return Error(i, "invalid memory access");
+      memcpy(&x, a, 4);
+      v = x;
+      break;
+    }
+    default:
+      if (!Valid(a, 8)) return Error(i, "invalid memory access");
+      memcpy(&v, a, 8);
+  }
+
+  return true;
+}
+
+bool CInterpreter::StoreMemory(const SInstr *i, const SOperand &o, long long *fp, long long v)
+{
+  char *a;
+
+  switch (o.kind) {
+    case okDerefLocal:  a = (char*)(intptr_t)fp[o.value]; break;
+    case okDerefGlobal: a = (char*)(intptr_t)_globals[o.value]; break;
+    default:            return Error(i, "invalid operand");
+  }
+
+  size_t size = o.type == vtByte ? 1 : o.type == vtInt ? 4 : 8;
+  if (!Valid(a, size)) return Error(i, "invalid memory access");
+  memcpy(a, &v, size);
+
+  return true;
+}
+
+bool CInterpreter::Execute(void)
+{
+  const SInstr *code = _code.data();
+  const SInstr *i = code + _procs[0].entry;
+  long long *fp = _frames.back().fp;
+  long long a = 0, b = 0;
+
+  while (true) {
+    switch (i->op) {
+      // binary operators; the destination truncates to its type
+      case opAdd:
+      case opSub:
+      case opMul:
+      case opAnd:
+      case opOr: {
+        if (!Load(i, i->src1, fp, a) || !Load(i, i->src2, fp, b)) return false;
+
+        unsigned long long r;
+        switch (i->op) {
+          case opAdd: r = (unsigned long long)a + (unsigned long long)b; break;
+          case opSub: r = (unsigned long long)a - (unsigned long long)b; break;
+          case opMul: r = (unsigned long long)a * (unsigned long long)b; break;
+          case opAnd: r = a & b; break;
+          default:    r = a | b; break;
+        }
+
+        if (!Store(i, i->dst, fp, r)) return false;
+        i++;
+        break;
+      }
+
+      case opDiv: {
+        if (!Load(i, i->src1, fp, a) || !Load(i, i->src2, fp, b)) return false;
+
+        if (i->width == 4) {
+          a = (int)a;
+          b = (int)b;
+        }
+        if (b == 0) return Error(i, "division by zero");
+        if ((b == -1) && (a == (i->width == 4 ? INT_MIN : LLONG_MIN))) {
+          return Error(i, "division overflow");
+        }
+
+        if (!Store(i, i->dst, fp, a / b)) return false;
+        i++;
+        break;
+      }
+
+      // unary operators, assignments, and type conversions
+      case opNeg:
+        if (!Load(i, i->src1, fp, a) || !Store(i, i->dst, fp, 0ULL - (unsigned long long)a)) {
+          return false;
+        }
+        i++;
+        break;
+
+      case opNot:
+        if (!Load(i, i->src1, fp, a) || !Store(i, i->dst, fp, !a)) return false;
+        i++;
+        break;
+
+      case opPos:
+      case opAssign:
+      case opAddress:
+      case opCast:
+      case opWiden:
+      case opNarrow:
+        if (!Load(i, i->src1, fp, a) || !Store(i, i->dst, fp, a)) return false;
+        i++;
+        break;
+
+      // branches
+      case opGoto:
+        i = code + i->target;
+        break;
+
+      case opEqual:
+      case opNotEqual:
+      case opLessThan:
+      case opLessEqual:
+      case opBiggerThan:
+      case opBiggerEqual: {
+        if (!Load(i, i->src1, fp, a) || !Load(i, i->src2, fp, b)) return false;
+
+        if (i->width == 4) {
+          a = (int)a;
+          b = (int)b;
+        }
+
+        bool taken;
+        switch (i->op) {
+          case opEqual:      taken = a == b; break;
+          case opNotEqual:   taken = a != b; break;
+          case opLessThan:   taken = a <  b; break;
+          case opLessEqual:  taken = a <= b; break;
+          case opBiggerThan: taken = a >  b; break;
+          default:           taken = a >= b; break;
+        }
+
+        i = taken ? code + i->target : i + 1;
+        break;
+      }
+
+      // calls
+      case opParam:
+        if (!Load(i, i->src1, fp, a)) return false;
+        _args[i->target] = a;
+        i++;
+        break;
+
+      case opCall:
+        if (i->target < 0) {
+          if (!CallBuiltin(i, fp, (EBuiltin)(-1 - i->target))) return false;
+          i++;
+        } else {
+          size_t p = i->target;
+          if (!Call(i, p, i - code)) return false;
+          fp = _frames.back().fp;
+          i = code + _procs[p].entry;
+        }
+        break;
+
+      case opReturn: {
+        a = 0;
+        if ((i->src1.kind != okNone) && !Load(i, i->src1, fp, a)) return false;
+
+        SFrame f = _frames.back();
+        _frames.pop_back();
+        _sp = f.fp;
+        if (_frames.empty()) return true;
+
+        // the caller stores the return value
+        i = code + f.ret;
+        fp = _frames.back().fp;
+        if ((i->dst.kind != okNone) && !Store(i, i->dst, fp, a)) return false;
+        i++;
+        break;
+      }
+
+      default:
+        return Error(i, "unsupported operation");
+    }
+  }
+}
+
+bool CInterpreter::Call(const SInstr *i, size_t p, size_t ret)
+{
+  const SProcedure &proc = _procs[p];
+
+  if ((size_t)(_stack + _ssize - _sp) < proc.frame) return Error(i, "stack overflow");
+
+  long long *fp = _sp;
+  memset(fp, 0, proc.frame * sizeof(long long));
+
+  for (const auto &h : proc.headers) {
+    memcpy((char*)fp + h.first, h.second.data(), h.second.size()*sizeof(int));
+  }
+
+  for (size_t a=0; a<proc.params.size(); a++) {
+    fp[proc.arrays + a] = Normalize(_args[a], proc.params[a]);
+  }
+
+  _sp += proc.frame;
+
+  SFrame f = { p, ret, fp };
+  _frames.push_back(f);
+
+  return true;
+}
+
+bool CInterpreter::CallBuiltin(const SInstr *i, long long *fp, EBuiltin b)
+{
+  long long r = 0;
+  char *a = (char*)(intptr_t)_args[0];
+  char buf[32];
+
+  switch (b) {
+    case biDIM:
+    case biDOFS: {
+      int v, d = b == biDIM ? (int)_args[1] : 0;
+      if (!Valid(a + 4*d, 4)) return Error(i, "invalid memory access");
+      memcpy(&v, a + 4*d, 4);
+      r = b == biDIM ? v : DataOffset(v);
+      break;
+    }
+
+    case biReadInt:
+    case biReadLong:
+      Flush();
+      if (!(*_in >> r)) r = 0;
+      if (b == biReadInt) r = (int)r;
+      break;
+
+    case biWriteInt:
+      snprintf(buf, sizeof(buf), "%d", (int)_args[0]);
+      _obuf += buf;
+      break;
+
+    case biWriteLong:
+      snprintf(buf, sizeof(buf), "%lld", _args[0]);
+      _obuf += buf;
+      break;
+
+    case biWriteStr: {
+      int ndim;
+      if (!Valid(a, 4)) return Error(i, "invalid memory access");
+      memcpy(&ndim, a, 4);
+
+      const char *s = a + DataOffset(ndim);
+      while (Valid(s, 1) && (*s != '\0')) _obuf += *s++;
+      if (!Valid(s, 1)) return Error(i, "invalid memory access");
+      break;
+    }
+
+    case biWriteChar:
+      _obuf += (char)_args[0];
+      break;
+
+    case biWriteLn:
+      _obuf += '\n';
+      break;
+
+    default:
+      return Error(i, "unsupported operation");
+  }
+
+  if (_obuf.size() >= 65536) Flush();
+
+  return (i->dst.kind == okNone) || Store(i, i->dst, fp, r);
+}
+
+bool CInterpreter::Error(const SInstr *i, const string &msg)
+{
+  ostringstream o;
+
+  o << msg;
+  if (!_frames.empty()) o << " in '" << _procs[_frames.back().proc].scope->GetName() << "'";
+  if ((i != NULL) && (i->tac != NULL)) o << " at instruction " << i->tac->GetId();
+  _error = o.str();
+
+  return false;
+}
+
+bool CInterpreter::Valid(const char *p, size_t size) const
+{
+  uintptr_t a = (uintptr_t)p, g = (uintptr_t)_gmem, s = (uintptr_t)_stack;
+
+  return ((a >= g) && (a + size <= g + _gsize)) ||
+         ((a >= s) && (a + size <= s + _ssize*sizeof(long long)));
+}
+
+void CInterpreter::Flush(void)
+{
+  if (_out == NULL) return;
+
+  _out->write(_obuf.data(), _obuf.size());
+  _out->flush();
+  _obuf.clear();
+}
@@ -0,0 +1,211 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL/2 TAC interpreter
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_INTERPRETER_H__
+#define __SnuPL_INTERPRETER_H__
+
+#include <iostream>
+#include <map>
+#include <string>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief TAC interpreter
+///
+/// Executes the TAC of a module directly, without generating code. Before execution, the
+/// instruction list of each scope is decoded into a dense array of instructions whose operands
+/// are resolved to frame slots, global slots, or constants and whose branch targets are resolved
+/// to instruction indices; labels and nops are dropped.
+///
+/// Each invocation of a scope gets a frame on the interpreter's stack. A frame holds the local
+/// arrays (with the SnuPL array header expected by DIM and DOFS) followed by one 64-bit slot per
+/// scalar parameter, local variable, and temporary. Global scalars live in global slots, global
+/// arrays and strings in a separate global memory block. Scalars are kept normalized to their
+/// type (sign-extended integers, zero-extended chars and booleans) and arithmetic follows the
+/// AMD64 backend, i.e., integer operations are performed on 32 bits. The routines of the SnuPL
+/// runtime (DIM, DOFS, and those of IO.h) are built in.
+///
+/// Invalid memory accesses, divisions by zero, and stack overflows stop the execution with an
+/// error instead of crashing the interpreter.
+///
+class CInterpreter {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor
+    ///
+    /// Decodes the TAC of @a m. The module (and its AST) must outlive the interpreter.
+    /// @param m module
+    /// @param stack_size size of the interpreter stack in bytes
+    CInterpreter(const CModule *m, size_t stack_size=DefaultStackSize);
+    virtual ~CInterpreter(void);
+
+    /// @}
+
+
+    /// @name execution
+    /// @{
+
+    /// @brief execute the module
+    /// @param in standard input of the program
+    /// @param out standard output of the program
+    /// @retval true if the program terminated normally
+    /// @retval false if the module cannot be interpreted or on a runtime error
+    bool Run(istream &in, ostream &out);
+
+    /// @brief return a human-readable message of the error that stopped the execution
+    string GetErrorMessage(void) const;
+
+    /// @}
+
+    const static size_t DefaultStackSize = 64 << 20;  ///< default stack size (bytes)
+
+  private:
+    /// @brief representation of a value in a slot or in memory
+    enum EValueType {
+      vtLong,                       ///< 64-bit value (longint, pointer)
+      vtInt,                        ///< sign-extended 32-bit value (integer)
+      vtByte,                       ///< zero-extended 8-bit value (char, boolean)
+    };
+
+    /// @brief kind of a decoded operand
+    enum EOperandKind {
+      okNone,                       ///< no operand
+      okConst,                      ///< constant (incl. addresses of global arrays)
+      okLocal,                      ///< frame slot
+      okGlobal,                     ///< global slot
+      okDerefLocal,                 ///< memory addressed by a frame slot
+      okDerefGlobal,                ///< memory addressed by a global slot
+      okFrame,                      ///< address of a local array (offset from frame)
+    };
+
+    /// @brief built-in routines of the SnuPL runtime
+    enum EBuiltin {
+      biDIM, biDOFS,
+      biReadInt, biReadLong,
+      biWriteInt, biWriteLong, biWriteStr, biWriteChar, biWriteLn,
+      biNone,
+    };
+
+    /// @brief decoded operand
+    struct SOperand {
+      EOperandKind kind;            ///< operand kind
+      EValueType type;              ///< value representation
+      long long value;              ///< constant, slot index, or frame offset
+    };
+
+    /// @brief decoded instruction
+    struct SInstr {
+      EOperation op;                ///< operation
+      int width;                    ///< operation width (4 or 8 bytes)
+      long long target;             ///< branch target, procedure index, or -1-builtin
+      SOperand dst;                 ///< destination
+      SOperand src1;                ///< source 1
+      SOperand src2;                ///< source 2
+      const CTacInstr *tac;         ///< original instruction (NULL if inserted)
+    };
+
+    /// @brief decoded scope
+    struct SProcedure {
+      const CScope *scope;          ///< scope
+      size_t entry;                 ///< index of the first instruction
+      size_t arrays;                ///< size of the local arrays (in slots)
+      size_t frame;                 ///< size of the frame (in slots)
+      vector<EValueType> params;    ///< parameter types
+      vector<pair<size_t, vector<int> > >
+             headers;               ///< offsets and headers of the local arrays
+    };
+
+    /// @brief activation record
+    struct SFrame {
+      size_t proc;                  ///< procedure index
+      size_t ret;                   ///< index of the calling instruction
+      long long *fp;                ///< frame pointer
+    };
+
+    /// @name decoding
+    /// @{
+
+    void Decode(const CModule *m);
+    void DecodeGlobals(const CScope *scope, vector<pair<const CSymbol*, size_t> > &arrays);
+    void DecodeScope(size_t p);
+    SOperand DecodeOperand(const CTac *op, size_t p);
+    SOperand Lookup(const CSymbol *s, size_t p);
+    void DecodeError(const string &msg);
+    static EValueType ValueType(const CType *t);
+    static const CType* ElementType(const CSymbol *s);
+    static int Width(const CTac *t);
+    static EBuiltin Builtin(const string &name);
+
+    /// @}
+
+    /// @name execution
+    /// @{
+
+    bool Execute(void);
+    bool Call(const SInstr *i, size_t p, size_t ret);
+    bool CallBuiltin(const SInstr *i, long long *fp, EBuiltin b);
+    static long long Normalize(long long v, EValueType type);
+    bool Load(const SInstr *i, const SOperand &o, long long *fp, long long &v);
+    bool Store(const SInstr *i, const SOperand &o, long long *fp, long long v);
+    bool LoadMemory(const SInstr *i, const SOperand &o, long long *fp, long long &v);
+    bool StoreMemory(const SInstr *i, const SOperand &o, long long *fp, long long v);
+    bool Error(const SInstr *i, const string &msg);
+    bool Valid(const char *p, size_t size) const;
+    void Flush(void);
+
+    /// @}
+
+    vector<SInstr>     _code;       ///< decoded instructions of all scopes
+    vector<SProcedure> _procs;      ///< decoded scopes (the module is at index 0)
+    vector<SFrame>     _frames;     ///< call stack
+    vector<long long>  _args;       ///< arguments of the next call
+    vector<long long>  _globals;    ///< global slots
+    char              *_gmem;       ///< global memory (arrays and strings)
+    size_t             _gsize;      ///< size of the global memory
+    long long         *_stack;      ///< stack
+    size_t             _ssize;      ///< size of the stack (in slots)
+    long long         *_sp;         ///< stack pointer
+    istream           *_in;         ///< standard input of the program
+    ostream           *_out;        ///< standard output of the program
+    string             _obuf;       ///< output buffer
+    string             _error;      ///< error message
+    map<const CSymbol*, SOperand>
+                       _globalops;  ///< decoded global variables
+    map<const CSymbol*, SOperand>
+                       _localops;   ///< decoded local variables of the current scope
+    map<const CSymbol*, size_t>
+                       _procidx;    ///< procedure indices
+};
+
+
+#endif // __SnuPL_INTERPRETER_H__
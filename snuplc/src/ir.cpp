@@ -34,6 +34,7 @@
 //--------------------------------------------------------------------------------------------------
 
 #include <iomanip>
+#include <algorithm>
 #include <cassert>
 
 #include "ir.h"
@@ -106,6 +107,22 @@ bool IsRelOp(EOperation t)
          (t == opBiggerEqual);
 }
 
+EOperation InvertRelOp(EOperation t)
+{
+  switch (t) {
+    case opEqual:       return opNotEqual;
+    case opNotEqual:    return opEqual;
+    case opLessThan:    return opBiggerEqual;
+    case opLessEqual:   return opBiggerThan;
+    case opBiggerThan:  return opLessEqual;
+    case opBiggerEqual: return opLessThan;
+    default:
+      assert(false);
+  }
+
+  return t;
+}
+
 ostream& operator<<(ostream &out, EOperation t)
 {
   out << EOperationName[t];
@@ -171,6 +188,11 @@ long long CTacConst::GetValue(void) const
   return _value;
 }
 
+const CType* CTacConst::GetType(void) const
+{
+  return _type;
+}
+
 ostream& CTacConst::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -242,12 +264,14 @@ ostream& CTacReference::print(ostream &out, int indent) const
 // CTacInstr
 //
 CTacInstr::CTacInstr(string name)
-  : _id(-1), _op(opNop), _name(name), _src1(NULL), _src2(NULL), _dst(NULL)
+  : _id(-1), _pid(-1), _pinv(false), _op(opNop), _name(name),
+    _src1(NULL), _src2(NULL), _dst(NULL), _prev(NULL), _next(NULL)
 {
 }
 
 CTacInstr::CTacInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
-  : _id(-1), _op(op), _src1(src1), _src2(src2), _dst(dst)
+  : _id(-1), _pid(-1), _pinv(false), _op(op), _src1(src1), _src2(src2), _dst(dst),
+    _prev(NULL), _next(NULL)
 {
   if (IsBranch()) {
     CTacLabel *lbl = dynamic_cast<CTacLabel*>(_dst);
@@ -258,11 +282,6 @@ CTacInstr::CTacInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
 
 CTacInstr::~CTacInstr(void)
 {
-  if (IsBranch()) {
-    CTacLabel *lbl = dynamic_cast<CTacLabel*>(_dst);
-    assert(lbl != NULL);
-    lbl->AddReference(-1);
-  }
 }
 
 unsigned int CTacInstr::GetId(void) const
@@ -304,11 +323,37 @@ CTac* CTacInstr::GetDest(void) const
   return _dst;
 }
 
+CTacInstr* CTacInstr::GetPrev(void) const
+{
+  return _prev;
+}
+
+CTacInstr* CTacInstr::GetNext(void) const
+{
+  return _next;
+}
+
 void CTacInstr::SetDest(CTac* dst)
 {
   _dst = dst;
 }
 
+int CTacInstr::GetProfileId(void) const
+{
+  return _pid;
+}
+
+bool CTacInstr::IsProfileInverted(void) const
+{
+  return _pinv;
+}
+
+void CTacInstr::SetProfileId(int pid, bool inverted)
+{
+  _pid = pid;
+  _pinv = inverted;
+}
+
 ostream& CTacInstr::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -387,11 +432,56 @@ ostream& CTacLabel::print(ostream &out, int indent) const
 }
 
 
+//--------------------------------------------------------------------------------------------------
+// CTacInstrList
+//
+CTacInstrList::CTacInstrList(void)
+  : _first(NULL), _last(NULL), _size(0)
+{
+}
+
+void CTacInstrList::push_back(CTacInstr *instr)
+{
+  assert((instr->_prev == NULL) && (instr->_next == NULL) && (instr != _first));
+
+  instr->_prev = _last;
+  if (_last != NULL) _last->_next = instr;
+  else _first = instr;
+  _last = instr;
+  _size++;
+}
+
+void CTacInstrList::erase(CTacInstr *instr)
+{
+  if (instr->_prev != NULL) instr->_prev->_next = instr->_next;
+  else _first = instr->_next;
+  if (instr->_next != NULL) instr->_next->_prev = instr->_prev;
+  else _last = instr->_prev;
+
+  instr->_prev = instr->_next = NULL;
+  _size--;
+}
+
+void CTacInstrList::clear(void)
+{
+  CTacInstr *i = _first;
+  while (i != NULL) {
+    CTacInstr *next = i->_next;
+    i->_prev = i->_next = NULL;
+    i = next;
+  }
+
+  _first = _last = NULL;
+  _size = 0;
+}
+
+
 //--------------------------------------------------------------------------------------------------
 // CScope
 //
 CScope::CScope(CAstNode *ast, CScope *parent)
-  : _ast(ast), _parent(parent), _temp_id(0), _label_id(0)
+  : _ast(ast), _parent(parent), _profile(NULL), _ignore_profile(false), _temp_id(0),
+    _label_id(0)
 {
   CAstScope *s = dynamic_cast<CAstScope*>(ast);
   assert(s != NULL);
@@ -400,6 +490,7 @@ CScope::CScope(CAstNode *ast, CScope *parent)
   _symtab = s->GetSymbolTable();
   _cb = new CCodeBlock(this);
   s->ToTac(_cb);
+  _cb->AssignProfileIds();
 
   for (size_t i=0; i<s->GetNumChildren(); i++) {
     CProcedure *p = new CProcedure(s->GetChild(i), this);
@@ -407,9 +498,21 @@ CScope::CScope(CAstNode *ast, CScope *parent)
   }
 }
 
+CScope::CScope(const string name, CSymtab *symtab, CScope *parent)
+  : _ast(NULL), _name(name), _symtab(symtab), _parent(parent), _profile(NULL),
+    _ignore_profile(false), _temp_id(0), _label_id(0)
+{
+  assert(_symtab != NULL);
+  _cb = new CCodeBlock(this);
+}
+
 CScope::~CScope(void)
 {
+  for (CScope *c : _children) delete c;
   delete _cb;
+
+  // without an AST, the scope owns its symbol table
+  if (_ast == NULL) delete _symtab;
 }
 
 string CScope::GetName(void) const
@@ -427,6 +530,15 @@ const vector<CScope*>& CScope::GetSubscopes(void) const
   return _children;
 }
 
+void CScope::RemoveSubscope(CScope *scope)
+{
+  auto it = find(_children.begin(), _children.end(), scope);
+  assert(it != _children.end());
+
+  _children.erase(it);
+  delete scope;
+}
+
 CSymtab* CScope::GetSymbolTable(void) const
 {
   return _symtab;
@@ -437,6 +549,35 @@ CCodeBlock* CScope::GetCodeBlock(void) const
   return _cb;
 }
 
+void CScope::SetProfile(const CProfile *profile)
+{
+  _profile = profile;
+}
+
+const CProfile* CScope::GetProfile(void) const
+{
+  if (_ignore_profile) return NULL;
+
+  const CScope *s = this;
+  while ((s->_profile == NULL) && (s->_parent != NULL)) s = s->_parent;
+  return s->_profile;
+}
+
+void CScope::IgnoreProfile(void)
+{
+  _ignore_profile = true;
+}
+
+void CScope::SetProfileSignature(const string sig)
+{
+  _prof_sig = sig;
+}
+
+string CScope::GetProfileSignature(void) const
+{
+  return _prof_sig;
+}
+
 CTacTemp* CScope::CreateTemp(const CType *type, string name, CStorage *store)
 {
   CSymtab *st = GetSymbolTable();
@@ -461,7 +602,10 @@ CTacTemp* CScope::CreateTemp(const CType *type, string name, CStorage *store)
   if (store != NULL) s->SetLocation(store);
   st->AddSymbol(s);
 
-  return new CTacTemp(s);
+  CTacTemp *t = _arena.New<CTacTemp>(s);
+  _names[s] = t;
+
+  return t;
 }
 
 CTacLabel* CScope::CreateLabel(const char *hint)
@@ -470,7 +614,38 @@ CTacLabel* CScope::CreateLabel(const char *hint)
   tmp << _label_id++;
   if (hint != NULL) tmp << "_" << hint;
 
-  return new CTacLabel(tmp.str());
+  return _arena.New<CTacLabel>(tmp.str());
+}
+
+CTacConst* CScope::CreateConst(long long value, const CType *type)
+{
+  CTacConst *&c = _consts[make_pair(value, type)];
+  if (c == NULL) c = _arena.New<CTacConst>(value, type);
+
+  return c;
+}
+
+CTacName* CScope::CreateName(const CSymbol *symbol)
+{
+  CTacName *&n = _names[symbol];
+  if (n == NULL) n = _arena.New<CTacName>(symbol);
+
+  return n;
+}
+
+CTacReference* CScope::CreateReference(const CSymbol *symbol, const CSymbol *deref)
+{
+  return _arena.New<CTacReference>(symbol, deref);
+}
+
+CTacInstr* CScope::CreateInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
+{
+  return _arena.New<CTacInstr>(op, dst, src1, src2);
+}
+
+CArena* CScope::GetArena(void)
+{
+  return &_arena;
 }
 
 ostream& CScope::print(ostream &out, int indent) const
@@ -515,6 +690,11 @@ CModule::CModule(CAstNode *ast)
 {
 }
 
+CModule::CModule(const string name, CSymtab *symtab)
+  : CScope(name, symtab, NULL)
+{
+}
+
 CModule::~CModule(void)
 {
 }
@@ -549,6 +729,16 @@ ostream& CModule::print(ostream &out, int indent) const
 CProcedure::CProcedure(CAstNode *ast, CScope *parent)
   : CScope(ast, parent)
 {
+  CAstProcedure *s = dynamic_cast<CAstProcedure*>(_ast);
+  assert(s != NULL);
+
+  _decl = s->GetSymbol();
+}
+
+CProcedure::CProcedure(const string name, CSymtab *symtab, CSymProc *decl, CScope *parent)
+  : CScope(name, symtab, parent), _decl(decl)
+{
+  assert(_decl != NULL);
 }
 
 CProcedure::~CProcedure(void)
@@ -557,10 +747,7 @@ CProcedure::~CProcedure(void)
 
 CSymbol* CProcedure::GetDeclaration(void) const
 {
-  CAstProcedure *s = dynamic_cast<CAstProcedure*>(_ast);
-  assert(s != NULL);
-
-  return s->GetSymbol();
+  return _decl;
 }
 
 ostream& CProcedure::print(ostream &out, int indent) const
@@ -585,7 +772,7 @@ ostream& CProcedure::print(ostream &out, int indent) const
 // CCodeBlock
 //
 CCodeBlock::CCodeBlock(CScope *owner)
-  : _owner(owner), _inst_id(0)
+  : _owner(owner), _inst_id(0), _prof_id(0)
 {
   assert(_owner != NULL);
 }
@@ -614,6 +801,21 @@ CTacLabel* CCodeBlock::CreateLabel(const char *hint)
   return _owner->CreateLabel(hint);
 }
 
+CTacConst* CCodeBlock::CreateConst(long long value, const CType *type)
+{
+  return _owner->CreateConst(value, type);
+}
+
+CTacName* CCodeBlock::CreateName(const CSymbol *symbol)
+{
+  return _owner->CreateName(symbol);
+}
+
+CTacReference* CCodeBlock::CreateReference(const CSymbol *symbol, const CSymbol *deref)
+{
+  return _owner->CreateReference(symbol, deref);
+}
+
 CTacInstr* CCodeBlock::AddInstr(CTacInstr *instr)
 {
   assert(instr != NULL);
@@ -623,49 +825,85 @@ CTacInstr* CCodeBlock::AddInstr(CTacInstr *instr)
   return instr;
 }
 
-const list<CTacInstr*>& CCodeBlock::GetInstr(void) const
+CTacInstr* CCodeBlock::AddInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
+{
+  return AddInstr(CreateInstr(op, dst, src1, src2));
+}
+
+CTacInstr* CCodeBlock::CreateInstr(EOperation op, CTac *dst, CTacAddr *src1, CTacAddr *src2)
+{
+  return _owner->CreateInstr(op, dst, src1, src2);
+}
+
+void CCodeBlock::RemoveInstr(CTacInstr *instr)
+{
+  assert(instr != NULL);
+
+  if ((instr->_prev != NULL) || (instr->_next != NULL) || (_ops.front() == instr)) {
+    _ops.erase(instr);
+  }
+
+  if (instr->IsBranch()) {
+    CTacLabel *lbl = dynamic_cast<CTacLabel*>(instr->GetDest());
+    assert(lbl != NULL);
+    lbl->AddReference(-1);
+  }
+}
+
+const CTacInstrList& CCodeBlock::GetInstr(void) const
 {
   return _ops;
 }
 
+void CCodeBlock::SetInstr(const vector<CTacInstr*> &instr)
+{
+  _ops.clear();
+  for (CTacInstr *i : instr) _ops.push_back(i);
+}
+
 void CCodeBlock::CleanupControlFlow(void)
 {
-  list<CTacInstr*>::iterator it = _ops.begin();
+  CTacInstr *instr = _ops.front();
 
-  // 1. pass: delete all branches (absolute/conditional) that jump to the
-  //          immediately next instruction. Deleting branch instruction will
-  //          automatically decrease the reference count of the target label.
-  while (it != _ops.end()) {
-    CTacInstr *instr = *it++;
+  // 1. pass: remove all branches (absolute/conditional) that jump to the
+  //          immediately next instruction. Removing a branch instruction will
+  //          decrease the reference count of the target label.
+  while (instr != NULL) {
+    CTacInstr *next = instr->GetNext();
 
     if (instr->IsBranch()) {
       CTacLabel *lbl = dynamic_cast<CTacLabel*>(instr->GetDest());
-      CTacInstr *next = (it == _ops.end() ? NULL : *it);
 
-      if ((lbl != NULL) && (lbl == next)) {
-        delete instr;
-        it = _ops.erase(--it);
-      }
+      if ((lbl != NULL) && (lbl == next)) RemoveInstr(instr);
     }
+
+    instr = next;
   }
 
   // 2. pass: remove all labels with reference count 0
-  it = _ops.begin();
-  while (it != _ops.end()) {
-    CTacInstr *instr = *it++;
+  instr = _ops.front();
+  while (instr != NULL) {
+    CTacInstr *next = instr->GetNext();
 
     CTacLabel *lbl = dynamic_cast<CTacLabel*>(instr);
 
-    if ((lbl != NULL) && (lbl->GetRefCnt() == 0)) {
-      delete lbl;
-      it = _ops.erase(--it);
-    }
+    if ((lbl != NULL) && (lbl->GetRefCnt() == 0)) RemoveInstr(lbl);
+
+    instr = next;
   }
 
   // 3. renumber instructions (we shouldn't do that really, but it's prettier)
   _inst_id = 0;
-  it = _ops.begin();
-  while (it != _ops.end()) (*it++)->SetId(_inst_id++);
+  for (CTacInstr *i : _ops) i->SetId(_inst_id++);
+}
+
+void CCodeBlock::AssignProfileIds(void)
+{
+  for (CTacInstr *instr : _ops) {
+    if (IsRelOp(instr->GetOperation()) && (instr->GetProfileId() < 0)) {
+      instr->SetProfileId(_prof_id++);
+    }
+  }
 }
 
 ostream& CCodeBlock::print(ostream &out, int indent) const
@@ -674,9 +912,8 @@ ostream& CCodeBlock::print(ostream &out, int indent) const
 
   out << ind << "[[ " << GetName() << endl;
 
-  list<CTacInstr*>::const_iterator it = _ops.begin();
-  while (it != _ops.end()) {
-    (*it++)->print(out, indent+2);
+  for (CTacInstr *i : _ops) {
+    i->print(out, indent+2);
     out << endl;
   }
 
@@ -698,9 +935,8 @@ string CCodeBlock::dotAttr(void) const
 
   o << " [label=\"" << GetName() << "\\r";
 
-  list<CTacInstr*>::const_iterator it = _ops.begin();
-  while (it != _ops.end()) {
-    (*it++)->print(o, 0);
+  for (CTacInstr *i : _ops) {
+    i->print(o, 0);
     o << "\\l";
   }
 
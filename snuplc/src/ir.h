@@ -37,9 +37,11 @@
 #define __SnuPL_IR_H__
 
 #include <iostream>
-#include <list>
+#include <map>
+#include <unordered_map>
 #include <vector>
 
+#include "arena.h"
 #include "symtab.h"
 
 
@@ -99,6 +101,9 @@ enum EOperation {
 /// @brief returns true if @a op is a relational operation
 bool IsRelOp(EOperation t);
 
+/// @brief return the negation of the relational operation @a t (e.g., < -> >=)
+EOperation InvertRelOp(EOperation t);
+
 /// @brief EOperation output operator
 ///
 /// @param out output stream
@@ -354,6 +359,9 @@ class CTacInstr : public CTac {
     CTacInstr(string name);
 
     /// @brief destructor
+    ///
+    /// Instructions live in the arena of their scope and are destroyed with it. Instructions
+    /// removed from a code block must be passed to CCodeBlock::RemoveInstr().
     virtual ~CTacInstr(void);
 
     /// @}
@@ -381,6 +389,36 @@ class CTacInstr : public CTac {
 
     /// @}
 
+    /// @name instruction list
+    /// @{
+
+    /// @brief return the previous instruction in the code block (NULL if first)
+    CTacInstr* GetPrev(void) const;
+
+    /// @brief return the next instruction in the code block (NULL if last)
+    CTacInstr* GetNext(void) const;
+
+    /// @}
+
+    /// @name profiling
+    /// @{
+
+    /// @brief return the profile id of a conditional branch
+    ///
+    /// Profile ids are assigned once right after TAC generation and identify
+    /// a branch across the instrumented and the optimized compilation.
+    /// @retval int profile id or -1 if the instruction carries none
+    int GetProfileId(void) const;
+
+    /// @brief returns true if the branch condition was inverted after
+    ///        the profile id had been assigned (taken/fall-through swapped)
+    bool IsProfileInverted(void) const;
+
+    /// @brief set the profile id to @a pid
+    void SetProfileId(int pid, bool inverted=false);
+
+    /// @}
+
     /// @name output
     /// @{
 
@@ -399,6 +437,8 @@ class CTacInstr : public CTac {
     void SetDest(CTac *dst);
 
     unsigned int   _id;              ///< unique instruction id
+    int            _pid;             ///< profile id
+    bool           _pinv;            ///< profile id refers to inverted condition
     EOperation     _op;              ///< opcode
     string         _name;            ///< name (for debugging purposes)
 
@@ -406,7 +446,12 @@ class CTacInstr : public CTac {
     CTacAddr      *_src2;            ///< source operand 2
     CTac          *_dst;             ///< destination operand
 
+    CTacInstr     *_prev;            ///< previous instruction in the code block
+    CTacInstr     *_next;            ///< next instruction in the code block
+
     friend class CCodeBlock;
+    friend class CTacInstrList;
+    friend class CIRReader;
 };
 
 
@@ -462,6 +507,72 @@ class CTacLabel : public CTacInstr {
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief instruction list
+///
+/// Doubly linked list of instructions threaded through the instructions themselves (see
+/// CTacInstr::GetPrev()/GetNext()); an instruction is contained in at most one list. The list is
+/// modified through its CCodeBlock and provides (read-only) forward iteration.
+///
+
+class CTacInstrList {
+  public:
+    /// @brief forward iterator
+    class const_iterator {
+      public:
+        const_iterator(CTacInstr *i) : _i(i) {};
+        CTacInstr* operator*(void) const { return _i; };
+        const_iterator& operator++(void) { _i = _i->GetNext(); return *this; };
+        const_iterator operator++(int) { const_iterator r(*this); ++*this; return r; };
+        bool operator==(const const_iterator &o) const { return _i == o._i; };
+        bool operator!=(const const_iterator &o) const { return _i != o._i; };
+      private:
+        CTacInstr *_i;              ///< current instruction
+    };
+
+    /// @name constructors/destructors
+    /// @{
+
+    CTacInstrList(void);
+
+    /// @}
+
+    /// @name iteration
+    /// @{
+
+    const_iterator begin(void) const { return const_iterator(_first); };
+    const_iterator end(void) const { return const_iterator(NULL); };
+
+    /// @brief return the first/last instruction (NULL if empty)
+    CTacInstr* front(void) const { return _first; };
+    CTacInstr* back(void) const { return _last; };
+
+    /// @brief return the number of instructions
+    size_t size(void) const { return _size; };
+
+    /// @brief returns true if the list is empty
+    bool empty(void) const { return _size == 0; };
+
+    /// @}
+
+  private:
+    /// @brief append @a instr to the list
+    void push_back(CTacInstr *instr);
+
+    /// @brief remove @a instr from the list
+    void erase(CTacInstr *instr);
+
+    /// @brief remove all instructions from the list
+    void clear(void);
+
+    CTacInstr *_first;               ///< first instruction
+    CTacInstr *_last;                ///< last instruction
+    size_t _size;                    ///< number of instructions
+
+    friend class CCodeBlock;
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief scope class
 ///
@@ -469,6 +580,7 @@ class CTacLabel : public CTacInstr {
 ///
 class CAstNode;
 class CCodeBlock;
+class CProfile;
 
 class CScope {
   public:
@@ -480,6 +592,14 @@ class CScope {
     /// @param parent superordinate scope, or NULL if none
     CScope(CAstNode *ast, CScope *parent=NULL);
 
+    /// @brief constructor for a scope without abstract syntax tree (e.g., loaded from a file)
+    ///
+    /// The scope takes ownership of @a symtab. Its code block is initially empty.
+    /// @param name name of the scope
+    /// @param symtab symbol table
+    /// @param parent superordinate scope, or NULL if none
+    CScope(const string name, CSymtab *symtab, CScope *parent=NULL);
+
     /// @brief destructor
     virtual ~CScope(void);
 
@@ -498,6 +618,9 @@ class CScope {
     /// @brief return a reference to the list of subscopes
     const vector<CScope*>& GetSubscopes(void) const;
 
+    /// @brief remove and delete the subscope @a scope
+    void RemoveSubscope(CScope *scope);
+
     /// @brief return a reference to the symbol table
     CSymtab* GetSymbolTable(void) const;
 
@@ -518,6 +641,29 @@ class CScope {
     /// @}
 
 
+    /// @name profile management
+    /// @{
+
+    /// @brief set the execution profile for this scope and its subscopes
+    /// @param profile profile or NULL to clear
+    void SetProfile(const CProfile *profile);
+
+    /// @brief return the execution profile (NULL if none available or ignored)
+    const CProfile* GetProfile(void) const;
+
+    /// @brief ignore the execution profile in this scope (but not in its subscopes)
+    void IgnoreProfile(void);
+
+    /// @brief set the signature of the code the profile counters of this scope refer to
+    ///        (see CProfile::Signature())
+    void SetProfileSignature(const string sig);
+
+    /// @brief return the signature of the code the profile counters refer to ("" if not set)
+    string GetProfileSignature(void) const;
+
+    /// @}
+
+
     /// @name address management
     /// @{
 
@@ -531,6 +677,26 @@ class CScope {
     /// @param hint optional descriptive string
     CTacLabel* CreateLabel(const char *hint=NULL);
 
+    /// @brief return the constant operand @a value of type @a type
+    ///
+    /// Constant and name operands are interned per scope; operands with equal values are
+    /// represented by the same object.
+    CTacConst* CreateConst(long long value, const CType *type);
+
+    /// @brief return the name operand of @a symbol
+    CTacName* CreateName(const CSymbol *symbol);
+
+    /// @brief create a new reference operand
+    /// @param symbol symbol holding the reference
+    /// @param deref symbol behind the reference
+    CTacReference* CreateReference(const CSymbol *symbol, const CSymbol *deref);
+
+    /// @brief create a new instruction (see CTacInstr::CTacInstr())
+    CTacInstr* CreateInstr(EOperation op, CTac *dst, CTacAddr *src1=NULL, CTacAddr *src2=NULL);
+
+    /// @brief return the arena holding the instructions and operands of this scope
+    CArena* GetArena(void);
+
     /// @}
 
 
@@ -558,15 +724,26 @@ class CScope {
     /// @}
 
   protected:
+    CArena _arena;                   ///< instructions and operands of this scope
+    map<pair<long long, const CType*>, CTacConst*>
+           _consts;                  ///< interned constant operands
+    unordered_map<const CSymbol*, CTacName*>
+           _names;                   ///< interned name operands
     CAstNode *_ast;                  ///< abstract syntax tree
     string _name;                    ///< name
     CSymtab *_symtab;                ///< symbol table
     CScope *_parent;                 ///< superordinate scope
     vector<CScope*> _children;       ///< list of functions
     CCodeBlock* _cb;                 ///< list of code blocks
+    const CProfile *_profile;        ///< execution profile
+    bool _ignore_profile;            ///< profile does not apply to this scope
+    string _prof_sig;                ///< signature of the profiled code
 
     unsigned int _temp_id;           ///< next id for temporaries
     unsigned int _label_id;          ///< next id for labels
+
+    friend class CIRWriter;
+    friend class CIRReader;
 };
 
 /// @name CScope output operators
@@ -605,6 +782,11 @@ class CModule : public CScope {
     /// @param ast abstract syntax tree (must be a CAstModule instance)
     CModule(CAstNode *ast);
 
+    /// @brief constructor for a module without abstract syntax tree (see CScope::CScope())
+    /// @param name module name
+    /// @param symtab global symbol table
+    CModule(const string name, CSymtab *symtab);
+
     /// @brief destructor
     virtual ~CModule(void);
 
@@ -646,6 +828,13 @@ class CProcedure : public CScope {
     /// @param ast abstract syntax tree (must be a CAstProcedure instance)
     CProcedure(CAstNode *ast, CScope *parent);
 
+    /// @brief constructor for a procedure without abstract syntax tree (see CScope::CScope())
+    /// @param name procedure name
+    /// @param symtab symbol table
+    /// @param decl symbol of the procedure's declaration
+    /// @param parent superordinate scope
+    CProcedure(const string name, CSymtab *symtab, CSymProc *decl, CScope *parent);
+
     /// @brief destructor
     virtual ~CProcedure(void);
 
@@ -669,6 +858,9 @@ class CProcedure : public CScope {
     virtual ostream&  print(ostream &out, int indent=0) const;
 
     /// @}
+
+  protected:
+    CSymProc *_decl;                 ///< symbol of the declaration
 };
 
 
@@ -716,6 +908,15 @@ class CCodeBlock {
     /// @param hint optional descriptive string
     CTacLabel* CreateLabel(const char *hint=NULL);
 
+    /// @brief return the (interned) constant operand @a value of type @a type
+    CTacConst* CreateConst(long long value, const CType *type);
+
+    /// @brief return the (interned) name operand of @a symbol
+    CTacName* CreateName(const CSymbol *symbol);
+
+    /// @brief create a new reference operand
+    CTacReference* CreateReference(const CSymbol *symbol, const CSymbol *deref);
+
     /// @}
 
 
@@ -726,12 +927,36 @@ class CCodeBlock {
     /// @retval CTacInstr* inserted instruction
     CTacInstr* AddInstr(CTacInstr *instr);
 
+    /// @brief create a new instruction and append it to the list of instructions
+    /// @retval CTacInstr* inserted instruction
+    CTacInstr* AddInstr(EOperation op, CTac *dst, CTacAddr *src1=NULL, CTacAddr *src2=NULL);
+
+    /// @brief create a new instruction (not added to the list of instructions)
+    CTacInstr* CreateInstr(EOperation op, CTac *dst, CTacAddr *src1=NULL, CTacAddr *src2=NULL);
+
+    /// @brief remove @a instr from the list of instructions
+    ///
+    /// A removed branch no longer counts as a reference to its target label.
+    void RemoveInstr(CTacInstr *instr);
+
     /// @brief return (a reference to) the list of instructions
-    const list<CTacInstr*>& GetInstr(void) const;
+    const CTacInstrList& GetInstr(void) const;
+
+    /// @brief replace the list of instructions by @a instr
+    ///
+    /// Used by optimizations that reorder instructions. Instructions no longer
+    /// contained in @a instr must have been removed with RemoveInstr().
+    void SetInstr(const vector<CTacInstr*> &instr);
 
     /// @brief remove unused/superfluous labels and goto instructions
     void CleanupControlFlow(void);
 
+    /// @brief assign profile ids to all conditional branches
+    ///
+    /// Ids are assigned in instruction order and only to branches that do
+    /// not have one yet.
+    void AssignProfileIds(void);
+
     /// @}
 
 
@@ -760,8 +985,12 @@ class CCodeBlock {
 
   protected:
     CScope *_owner;                  ///< block owner
-    list<CTacInstr*> _ops;           ///< operation list
+    CTacInstrList _ops;              ///< operation list
     unsigned int _inst_id;           ///< next id for instructions
+    int _prof_id;                    ///< next profile id for branches
+
+    friend class CIRWriter;
+    friend class CIRReader;
 };
 
 /// @name CCodeBlock output operators
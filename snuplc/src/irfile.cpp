@@ -0,0 +1,1056 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL binary IR files
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <cctype>
+#include <climits>
+#include <cstring>
+
+#include "irfile.h"
+#include "scanner.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// file layout
+//
+static const char IRMagic[8] = { 'S', 'n', 'u', 'P', 'L', '/', 'I', 'R' };
+
+/// @brief size of the header: magic and seven u32 fields
+static const size_t IRHeaderSize = sizeof(IRMagic) + 7*4;
+
+/// @brief operand kinds in the body
+enum EOperandKind {
+  okNone=0,                         ///< no operand
+  okConst,                          ///< constant: value, type
+  okName,                           ///< name: symbol
+  okTemp,                           ///< temporary: symbol
+  okReference,                      ///< reference: symbol, dereferenced symbol
+  okLabel,                          ///< label: label index
+};
+
+/// @brief data initializer kinds in the body
+enum EDataKind {
+  dkNone=0,                         ///< no data initializer
+  dkLongint,                        ///< longint: value
+  dkInteger,                        ///< integer: value
+  dkBoolean,                        ///< boolean: value
+  dkChar,                           ///< char: value
+  dkString,                         ///< string: string index
+};
+
+/// @brief number of predefined types (NULL and the base types)
+static const unsigned int NBaseTypes = 7;
+
+static void PutU32(string &out, unsigned int v)
+{
+  for (int i=0; i<4; i++) out.push_back((char)((v >> (8*i)) & 0xff));
+}
+
+static unsigned int GetU32(const unsigned char *p)
+{
+  return p[0] | (p[1] << 8) | (p[2] << 16) | ((unsigned int)p[3] << 24);
+}
+
+/// @brief return true if @a dst, @a src1, and @a src2 have the form required by operation @a op
+static bool ValidOperands(EOperation op, const CTac *dst, const CTac *src1, const CTac *src2)
+{
+  bool name = dynamic_cast<const CTacName*>(dst) != NULL;
+
+  if ((src1 != NULL) && (dynamic_cast<const CTacAddr*>(src1) == NULL)) return false;
+  if ((src2 != NULL) && (dynamic_cast<const CTacAddr*>(src2) == NULL)) return false;
+
+  switch (op) {
+    case opAdd: case opSub: case opMul: case opDiv: case opAnd: case opOr:
+      return name && (src1 != NULL) && (src2 != NULL);
+
+    case opNeg: case opPos: case opNot: case opAssign: case opAddress: case opDeref:
+    case opCast: case opWiden: case opNarrow:
+      return name && (src1 != NULL) && (src2 == NULL);
+
+    case opGoto:
+      return (dynamic_cast<const CTacLabel*>(dst) != NULL) && (src1 == NULL) && (src2 == NULL);
+
+    case opEqual: case opNotEqual: case opLessThan: case opLessEqual: case opBiggerThan:
+    case opBiggerEqual:
+      return (dynamic_cast<const CTacLabel*>(dst) != NULL) && (src1 != NULL) && (src2 != NULL);
+
+    case opCall:
+      return ((dst == NULL) || name) && (dynamic_cast<const CTacName*>(src1) != NULL) &&
+             (src2 == NULL);
+
+    case opReturn:
+      return (dst == NULL) && (src2 == NULL);
+
+    case opParam:
+      return (dynamic_cast<const CTacConst*>(dst) != NULL) && (src1 != NULL) && (src2 == NULL);
+
+    case opNop:
+      return true;
+
+    default:
+      return false;
+  }
+}
+
+/// @brief return true if @a data is a valid initializer of a symbol of type @a stype and @a type
+///
+/// Constants must carry a value of their type; globals may only be initialized with strings.
+static bool ValidData(ESymbolType stype, const CType *type, const CDataInitializer *data)
+{
+  bool str = (dynamic_cast<const CDataInitString*>(data) != NULL) && type->IsArray();
+
+  switch (stype) {
+    case stConstant:
+      if (dynamic_cast<const CDataInitBoolean*>(data) != NULL) return type->IsBoolean();
+      if (dynamic_cast<const CDataInitChar*>(data) != NULL) return type->IsChar();
+      if (dynamic_cast<const CDataInitInteger*>(data) != NULL) return type->IsInteger();
+      if (dynamic_cast<const CDataInitLongint*>(data) != NULL) return type->IsLongint();
+      return str;
+
+    case stGlobal:
+      return (data == NULL) || str;
+
+    default:
+      return data == NULL;
+  }
+}
+
+/// @brief return the number of label @a name created by CScope::CreateLabel() ("<id>[_hint]")
+/// @retval -1 if the label was not created by CreateLabel()
+static long long LabelId(const string &name)
+{
+  size_t n = 0;
+  long long id = 0;
+
+  while ((n < name.size()) && isdigit((unsigned char)name[n]) && (n < 10)) {
+    id = 10*id + (name[n++] - '0');
+  }
+
+  if ((n == 0) || ((n < name.size()) && (name[n] != '_'))) return -1;
+  return id;
+}
+
+/// @brief FNV-1a checksum of @a size bytes at @a data, continuing from @a h
+static unsigned int Checksum(const void *data, size_t size, unsigned int h=2166136261U)
+{
+  const unsigned char *p = (const unsigned char*)data;
+  for (size_t i=0; i<size; i++) h = (h ^ p[i]) * 16777619U;
+  return h;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CIRWriter
+//
+CIRWriter::CIRWriter(void)
+{
+}
+
+CIRWriter::~CIRWriter(void)
+{
+}
+
+bool CIRWriter::Write(const CModule *m, ostream &out)
+{
+  assert(m != NULL);
+
+  _body.clear();
+  _strings.clear();
+  _types.clear();
+  _string_idx.clear();
+  _type_idx.clear();
+  _symtab_idx.clear();
+  _symbol_idx.clear();
+  _message = "";
+
+  WriteTypes();
+
+  // symbol tables of all scopes (breadth-first, so that parents precede their children)
+  vector<const CScope*> scopes { m };
+  for (size_t i=0; i<scopes.size(); i++) {
+    const CSymtab *st = scopes[i]->GetSymbolTable();
+    if (!_symtab_idx.emplace(st, i).second) {
+      Error("scope '" + scopes[i]->GetName() + "' shares its symbol table.");
+    }
+    for (const CScope *c : scopes[i]->GetSubscopes()) scopes.push_back(c);
+  }
+
+  PutString(m->GetName());
+  Put(scopes.size());
+  for (size_t i=1; i<scopes.size(); i++) {
+    auto it = _symtab_idx.find(scopes[i]->GetSymbolTable()->GetParent());
+    if ((it == _symtab_idx.end()) || (it->second >= i)) {
+      Error("invalid parent symbol table in scope '" + scopes[i]->GetName() + "'.");
+    } else {
+      Put(it->second);
+    }
+  }
+
+  // number all symbols first so that parameter lists and operands can refer to them
+  vector<const CSymProc*> procs;
+  for (const CScope *s : scopes) {
+    for (const CSymbol *sym : s->GetSymbolTable()->GetSymbols()) {
+      _symbol_idx.emplace(sym, _symbol_idx.size());
+    }
+  }
+
+  for (const CScope *s : scopes) {
+    const vector<CSymbol*> &symbols = s->GetSymbolTable()->GetSymbols();
+    Put(symbols.size());
+    for (const CSymbol *sym : symbols) {
+      Put(sym->GetSymbolType());
+      PutString(sym->GetName());
+      PutType(sym->GetDataType());
+      PutData(sym->GetData());
+
+      if (sym->GetSymbolType() == stParam) {
+        const CSymParam *p = dynamic_cast<const CSymParam*>(sym);
+        if (p == NULL) Error("parameter '" + sym->GetName() + "' is not a CSymParam.");
+        else Put(p->GetIndex());
+      } else if (sym->GetSymbolType() == stProcedure) {
+        const CSymProc *p = dynamic_cast<const CSymProc*>(sym);
+        if (p == NULL) Error("procedure '" + sym->GetName() + "' is not a CSymProc.");
+        else {
+          Put(p->IsExternal());
+          procs.push_back(p);
+        }
+      }
+    }
+  }
+
+  // parameter lists; parameters of external procedures are not part of any symbol table
+  for (const CSymProc *p : procs) {
+    Put(p->GetNParams());
+    for (unsigned int i=0; i<p->GetNParams(); i++) {
+      const CSymParam *param = p->GetParam(i);
+      auto it = _symbol_idx.find(param);
+      if (it != _symbol_idx.end()) {
+        Put(it->second + 1);
+      } else {
+        Put(0);
+        Put(param->GetIndex());
+        PutString(param->GetName());
+        PutType(param->GetDataType());
+      }
+    }
+  }
+
+  WriteScope(m);
+
+  if (_message != "") return false;
+
+  // header, string table, body
+  size_t idx_ofs = IRHeaderSize;
+  size_t data_ofs = idx_ofs + 4*(_strings.size() + 1);
+  size_t string_size = 0;
+  for (const string &s : _strings) string_size += s.size();
+  size_t body_ofs = data_ofs + string_size;
+  size_t size = body_ofs + _body.size();
+
+  if (size > 0xffffffffUL) {
+    _message = "module too large for an IR file.";
+    return false;
+  }
+
+  string head(IRMagic, sizeof(IRMagic));
+  PutU32(head, IRFileVersion);
+  PutU32(head, _strings.size());
+  PutU32(head, idx_ofs);
+  PutU32(head, data_ofs);
+  PutU32(head, body_ofs);
+  PutU32(head, size);
+
+  string index;
+  size_t ofs = 0;
+  for (const string &s : _strings) {
+    PutU32(index, ofs);
+    ofs += s.size();
+  }
+  PutU32(index, ofs);
+
+  unsigned int h = Checksum(index.data(), index.size());
+  for (const string &s : _strings) h = Checksum(s.data(), s.size(), h);
+  h = Checksum(_body.data(), _body.size(), h);
+  PutU32(head, h);
+
+  out.write(head.data(), head.size());
+  out.write(index.data(), index.size());
+  for (const string &s : _strings) out.write(s.data(), s.size());
+  out.write(_body.data(), _body.size());
+
+  if (!out.good()) {
+    _message = "cannot write IR file.";
+    return false;
+  }
+
+  return true;
+}
+
+string CIRWriter::GetErrorMessage(void) const
+{
+  return _message;
+}
+
+void CIRWriter::Put(unsigned long long v)
+{
+  while (v >= 0x80) {
+    _body.push_back((char)((v & 0x7f) | 0x80));
+    v >>= 7;
+  }
+  _body.push_back((char)v);
+}
+
+void CIRWriter::PutSigned(long long v)
+{
+  Put(((unsigned long long)v << 1) ^ (unsigned long long)(v >> 63));
+}
+
+void CIRWriter::PutString(const string &s)
+{
+  auto it = _string_idx.find(s);
+  if (it == _string_idx.end()) {
+    it = _string_idx.emplace(s, _strings.size()).first;
+    _strings.push_back(s);
+  }
+
+  Put(it->second);
+}
+
+void CIRWriter::PutType(const CType *t)
+{
+  if (t == NULL) {
+    Put(0);
+    return;
+  }
+
+  auto it = _type_idx.find(t);
+  if (it == _type_idx.end()) {
+    Error("type not managed by the type manager.");
+    Put(0);
+  } else {
+    Put(it->second);
+  }
+}
+
+void CIRWriter::PutSymbol(const CSymbol *s)
+{
+  if (s == NULL) {
+    Put(0);
+    return;
+  }
+
+  auto it = _symbol_idx.find(s);
+  if (it == _symbol_idx.end()) {
+    Error("symbol '" + s->GetName() + "' is not in a symbol table of the module.");
+    Put(0);
+  } else {
+    Put(it->second + 1);
+  }
+}
+
+void CIRWriter::PutData(const CDataInitializer *data)
+{
+  if (data == NULL) {
+    Put(dkNone);
+  } else if (const CDataInitLongint *d = dynamic_cast<const CDataInitLongint*>(data)) {
+    Put(dkLongint);
+    PutSigned(d->GetData());
+  } else if (const CDataInitInteger *d = dynamic_cast<const CDataInitInteger*>(data)) {
+    Put(dkInteger);
+    PutSigned(d->GetData());
+  } else if (const CDataInitBoolean *d = dynamic_cast<const CDataInitBoolean*>(data)) {
+    Put(dkBoolean);
+    Put(d->GetData());
+  } else if (const CDataInitChar *d = dynamic_cast<const CDataInitChar*>(data)) {
+    Put(dkChar);
+    Put((unsigned char)d->GetData());
+  } else if (const CDataInitString *d = dynamic_cast<const CDataInitString*>(data)) {
+    Put(dkString);
+    PutString(d->GetData());
+  } else {
+    Error("unknown data initializer.");
+    Put(dkNone);
+  }
+}
+
+void CIRWriter::PutOperand(const CTac *t,
+                           const unordered_map<const CTacLabel*, unsigned int> &labels)
+{
+  if (t == NULL) {
+    Put(okNone);
+  } else if (const CTacConst *c = dynamic_cast<const CTacConst*>(t)) {
+    Put(okConst);
+    PutSigned(c->GetValue());
+    PutType(c->GetType());
+  } else if (const CTacReference *r = dynamic_cast<const CTacReference*>(t)) {
+    Put(okReference);
+    PutSymbol(r->GetSymbol());
+    PutSymbol(r->GetDerefSymbol());
+  } else if (const CTacTemp *n = dynamic_cast<const CTacTemp*>(t)) {
+    Put(okTemp);
+    PutSymbol(n->GetSymbol());
+  } else if (const CTacName *n = dynamic_cast<const CTacName*>(t)) {
+    Put(okName);
+    PutSymbol(n->GetSymbol());
+  } else if (const CTacLabel *l = dynamic_cast<const CTacLabel*>(t)) {
+    Put(okLabel);
+    Put(labels.at(l));
+  } else {
+    Error("unknown operand.");
+    Put(okNone);
+  }
+}
+
+void CIRWriter::AddType(const CType *t)
+{
+  if (_type_idx.find(t) != _type_idx.end()) return;
+
+  if (const CPointerType *p = dynamic_cast<const CPointerType*>(t)) {
+    AddType(p->GetBaseType());
+  } else if (const CArrayType *a = dynamic_cast<const CArrayType*>(t)) {
+    AddType(a->GetInnerType());
+  } else {
+    Error("unknown type.");
+    return;
+  }
+
+  _type_idx[t] = NBaseTypes + _types.size();
+  _types.push_back(t);
+}
+
+void CIRWriter::WriteTypes(void)
+{
+  CTypeManager *tm = CTypeManager::Get();
+
+  // base types
+  const CType *base[NBaseTypes] = {
+    NULL, tm->GetNull(), tm->GetBool(), tm->GetChar(), tm->GetInteger(), tm->GetLongint(),
+    tm->GetVoidPtr()
+  };
+  for (unsigned int i=1; i<NBaseTypes; i++) _type_idx[base[i]] = i;
+
+  // composite types in order of creation (arrays first since pointers to arrays are common)
+  for (const CType *t : tm->GetArrayTypes()) AddType(t);
+  for (const CType *t : tm->GetPointerTypes()) AddType(t);
+
+  Put(_types.size());
+  for (const CType *t : _types) {
+    if (const CPointerType *p = dynamic_cast<const CPointerType*>(t)) {
+      Put(0);
+      PutType(p->GetBaseType());
+    } else {
+      const CArrayType *a = dynamic_cast<const CArrayType*>(t);
+      Put(1);
+      Put(a->GetNElem());
+      PutType(a->GetInnerType());
+    }
+  }
+}
+
+void CIRWriter::WriteScope(const CScope *s)
+{
+  const CCodeBlock *cb = s->GetCodeBlock();
+
+  if (s->GetParent() != NULL) {
+    PutString(s->GetName());
+    Put(_symtab_idx[s->GetSymbolTable()]);
+    PutSymbol(s->GetDeclaration());
+  }
+
+  Put(s->_temp_id);
+  Put(s->_label_id);
+  Put(cb->_inst_id);
+  PutSigned(cb->_prof_id);
+
+  // labels in the instruction list, followed by branch targets outside of it (if any)
+  vector<const CTacLabel*> labels;
+  unordered_map<const CTacLabel*, unsigned int> label_idx;
+  for (const CTacInstr *i : cb->GetInstr()) {
+    if (const CTacLabel *l = dynamic_cast<const CTacLabel*>(i)) {
+      label_idx.emplace(l, labels.size());
+      labels.push_back(l);
+    }
+  }
+  for (const CTacInstr *i : cb->GetInstr()) {
+    const CTacLabel *l = dynamic_cast<const CTacLabel*>(i->GetDest());
+    if ((l != NULL) && label_idx.emplace(l, labels.size()).second) labels.push_back(l);
+  }
+
+  Put(labels.size());
+  for (const CTacLabel *l : labels) PutString(l->GetLabel());
+
+  Put(cb->GetInstr().size());
+  for (const CTacInstr *i : cb->GetInstr()) {
+    Put(i->GetOperation());
+    Put(i->GetId());
+    PutSigned(i->GetProfileId());
+    Put(i->IsProfileInverted());
+
+    if (const CTacLabel *l = dynamic_cast<const CTacLabel*>(i)) {
+      Put(label_idx[l]);
+    } else {
+      PutOperand(i->GetDest(), label_idx);
+      PutOperand(i->GetSrc(1), label_idx);
+      PutOperand(i->GetSrc(2), label_idx);
+    }
+  }
+
+  Put(s->GetSubscopes().size());
+  for (const CScope *c : s->GetSubscopes()) WriteScope(c);
+}
+
+void CIRWriter::Error(const string message)
+{
+  if (_message == "") _message = message;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CIRReader
+//
+CIRReader::CIRReader(void)
+  : _pos(NULL), _end(NULL), _nstrings(0), _string_idx(NULL), _string_data(NULL),
+    _string_size(0), _arena(NULL)
+{
+}
+
+CIRReader::~CIRReader(void)
+{
+}
+
+bool CIRReader::IsIRFile(const char *data, size_t size)
+{
+  return (size >= sizeof(IRMagic)) && (memcmp(data, IRMagic, sizeof(IRMagic)) == 0);
+}
+
+CModule* CIRReader::Load(const char *data, size_t size)
+{
+  const unsigned char *d = (const unsigned char*)data;
+
+  _types.clear();
+  _symtabs.clear();
+  _attached.clear();
+  _symbols.clear();
+  _procs.clear();
+  _defined.clear();
+  _arena = NULL;
+  _message = "";
+
+  // header and string table
+  if (!IsIRFile(data, size) || (size < IRHeaderSize)) {
+    _message = "not an IR file.";
+    return NULL;
+  }
+
+  unsigned int version = GetU32(d + 8);
+  if (version != IRFileVersion) {
+    _message = "unsupported IR file version " + to_string(version) + ".";
+    return NULL;
+  }
+
+  _nstrings = GetU32(d + 12);
+  size_t idx_ofs = GetU32(d + 16);
+  size_t data_ofs = GetU32(d + 20);
+  size_t body_ofs = GetU32(d + 24);
+  size_t fsize = GetU32(d + 28);
+
+  if ((fsize != size) || (idx_ofs < IRHeaderSize) ||
+      (idx_ofs + 4*((size_t)_nstrings + 1) > data_ofs) || (data_ofs > body_ofs) ||
+      (body_ofs > size)) {
+    _message = "corrupt IR file header.";
+    return NULL;
+  }
+
+  if (GetU32(d + 32) != Checksum(d + IRHeaderSize, size - IRHeaderSize)) {
+    _message = "corrupt IR file (checksum mismatch).";
+    return NULL;
+  }
+
+  _string_idx = d + idx_ofs;
+  _string_data = d + data_ofs;
+  _string_size = body_ofs - data_ofs;
+  _pos = d + body_ofs;
+  _end = d + size;
+
+  // types, symbol tables, and the module
+  ReadTypes();
+
+  string name = GetString();
+  unsigned long long nsymtabs = Get();
+  if ((nsymtabs == 0) || (nsymtabs > (unsigned long long)(_end - _pos) + 1)) {
+    Error("invalid number of symbol tables.");
+  }
+  if (_message != "") return NULL;
+
+  _symtabs.push_back(new CSymtab());
+  for (unsigned long long i=1; (i<nsymtabs) && (_message == ""); i++) {
+    unsigned long long parent = Get();
+    if (parent >= i) Error("invalid parent symbol table.");
+    else _symtabs.push_back(new CSymtab(_symtabs[parent]));
+  }
+  _attached.resize(_symtabs.size(), false);
+
+  CModule *m = new CModule(name, _symtabs[0]);
+  _attached[0] = true;
+  _arena = m->GetArena();
+
+  for (CSymtab *st : _symtabs) ReadSymtab(st);
+  ReadParams();
+  ReadScope(m);
+
+  if ((_message == "") && (_pos != _end)) Error("trailing data.");
+
+  if (_message != "") {
+    delete m;
+    for (size_t i=0; i<_symtabs.size(); i++) {
+      if (!_attached[i]) delete _symtabs[i];
+    }
+    return NULL;
+  }
+
+  return m;
+}
+
+CModule* CIRReader::Load(const string file)
+{
+  CSourceBuffer buf(file);
+
+  if (!buf.Good()) {
+    _message = "cannot read IR file '" + file + "'.";
+    return NULL;
+  }
+
+  return Load(buf.GetData(), buf.GetSize());
+}
+
+string CIRReader::GetErrorMessage(void) const
+{
+  return _message;
+}
+
+unsigned long long CIRReader::Get(void)
+{
+  unsigned long long v = 0;
+
+  for (int shift=0; shift<64; shift+=7) {
+    if (_pos >= _end) {
+      Error("unexpected end of file.");
+      return 0;
+    }
+
+    unsigned char b = *_pos++;
+    v |= (unsigned long long)(b & 0x7f) << shift;
+    if ((b & 0x80) == 0) return v;
+  }
+
+  Error("invalid varint.");
+  return 0;
+}
+
+long long CIRReader::GetSigned(void)
+{
+  unsigned long long v = Get();
+  return (long long)(v >> 1) ^ -(long long)(v & 1);
+}
+
+unsigned int CIRReader::GetUInt(void)
+{
+  unsigned long long v = Get();
+
+  if (v > UINT_MAX) {
+    Error("value out of range.");
+    return 0;
+  }
+
+  return v;
+}
+
+int CIRReader::GetInt(void)
+{
+  long long v = GetSigned();
+
+  if ((v < INT_MIN) || (v > INT_MAX)) {
+    Error("value out of range.");
+    return 0;
+  }
+
+  return v;
+}
+
+string CIRReader::GetString(void)
+{
+  unsigned long long idx = Get();
+
+  if (idx >= _nstrings) {
+    Error("invalid string index.");
+    return "";
+  }
+
+  size_t start = GetU32(_string_idx + 4*idx);
+  size_t end = GetU32(_string_idx + 4*(idx+1));
+  if ((start > end) || (end > _string_size)) {
+    Error("corrupt string table.");
+    return "";
+  }
+
+  return string((const char*)_string_data + start, end - start);
+}
+
+const CType* CIRReader::GetType(void)
+{
+  unsigned long long idx = Get();
+
+  if (idx >= _types.size()) {
+    Error("invalid type index.");
+    return NULL;
+  }
+
+  return _types[idx];
+}
+
+CSymbol* CIRReader::GetSymbol(void)
+{
+  unsigned long long idx = Get();
+
+  if (idx > _symbols.size()) {
+    Error("invalid symbol index.");
+    return NULL;
+  }
+
+  return idx == 0 ? NULL : _symbols[idx-1];
+}
+
+CDataInitializer* CIRReader::GetData(void)
+{
+  unsigned long long v;
+
+  switch (Get()) {
+    case dkNone:    return NULL;
+    case dkLongint: return _arena->New<CDataInitLongint>(GetSigned());
+    case dkInteger: return _arena->New<CDataInitInteger>(GetInt());
+    case dkBoolean: if ((v = Get()) > 1) break;
+                    return _arena->New<CDataInitBoolean>(v != 0);
+    case dkChar:    if ((v = Get()) > UCHAR_MAX) break;
+                    return _arena->New<CDataInitChar>((char)v);
+    case dkString:  return _arena->New<CDataInitString>(GetString());
+  }
+
+  Error("invalid data initializer.");
+  return NULL;
+}
+
+CTac* CIRReader::GetOperand(CScope *s, const vector<CTacLabel*> &labels)
+{
+  unsigned long long kind = Get();
+
+  switch (kind) {
+    case okNone:
+      return NULL;
+
+    case okConst:
+      {
+        long long value = GetSigned();
+        const CType *type = GetType();
+        if (type != NULL) return s->CreateConst(value, type);
+        break;
+      }
+
+    case okName:
+    case okTemp:
+    case okReference:
+      {
+        CSymbol *sym = GetSymbol();
+        if (sym == NULL) {
+          Error("operand without symbol.");
+          return NULL;
+        }
+
+        // the backend and the interpreter resolve symbols through the scope's symbol tables
+        const CSymtab *st = s->GetSymbolTable();
+        if ((st->FindSymbol(sym->GetAtom()) != sym) || (sym->GetSymbolType() == stReserved) ||
+            ((kind == okTemp) && (sym->GetSymbolType() != stLocal ||
+                                  st->FindSymbol(sym->GetAtom(), sLocal) != sym))) {
+          Error("symbol '" + sym->GetName() + "' not visible in scope '" + s->GetName() + "'.");
+          return NULL;
+        }
+
+        if (kind == okName) return s->CreateName(sym);
+        if (kind == okReference) {
+          CSymbol *deref = GetSymbol();
+          if ((deref != NULL) && (st->FindSymbol(deref->GetAtom()) != deref)) {
+            Error("symbol '" + deref->GetName() + "' not visible in scope '" +
+                  s->GetName() + "'.");
+            return NULL;
+          }
+          return s->CreateReference(sym, deref);
+        }
+
+        CTacName *&n = s->_names[sym];
+        if (dynamic_cast<CTacTemp*>(n) == NULL) n = s->_arena.New<CTacTemp>(sym);
+        return n;
+      }
+
+    case okLabel:
+      {
+        unsigned long long idx = Get();
+        if (idx < labels.size()) return labels[idx];
+      }
+      break;
+  }
+
+  Error("invalid operand.");
+  return NULL;
+}
+
+void CIRReader::ReadTypes(void)
+{
+  CTypeManager *tm = CTypeManager::Get();
+
+  _types = {
+    NULL, tm->GetNull(), tm->GetBool(), tm->GetChar(), tm->GetInteger(), tm->GetLongint(),
+    tm->GetVoidPtr()
+  };
+  assert(_types.size() == NBaseTypes);
+
+  unsigned long long n = Get();
+  for (unsigned long long i=0; (i<n) && (_message == ""); i++) {
+    const CType *t = NULL;
+
+    if (Get() == 0) {
+      const CType *base = GetType();
+      if (base != NULL) t = tm->GetPointer(base);
+    } else {
+      unsigned long long nelem = Get();
+      const CType *inner = GetType();
+      if ((nelem > 0) && (nelem <= CArrayType::OPEN)) t = tm->GetArray(nelem, inner);
+    }
+
+    if (t == NULL) Error("invalid type.");
+    _types.push_back(t);
+  }
+}
+
+void CIRReader::ReadSymtab(CSymtab *st)
+{
+  unsigned long long n = Get();
+
+  for (unsigned long long i=0; (i<n) && (_message == ""); i++) {
+    unsigned long long stype = Get();
+    string name = GetString();
+    const CType *type = GetType();
+    CDataInitializer *data = GetData();
+    CSymbol *s = NULL;
+
+    if ((name == "") || (type == NULL)) Error("invalid symbol.");
+    else if (!ValidData((ESymbolType)stype, type, data)) {
+      Error("invalid initializer of symbol '" + name + "'.");
+    }
+    if (_message != "") return;
+
+    switch (stype) {
+      case stGlobal:    s = new CSymGlobal(name, type); break;
+      case stLocal:     s = new CSymLocal(name, type); break;
+      case stParam:     s = new CSymParam(GetUInt(), name, type); break;
+      case stProcedure: s = new CSymProc(name, type, Get() != 0); break;
+      case stConstant:  s = new CSymConstant(name, type, data); break;
+      case stReserved:  s = new CSymbol(name, stReserved, type); break;
+      default:
+        Error("invalid symbol type.");
+        return;
+    }
+
+    if ((stype != stConstant) && (data != NULL)) s->SetData(data);
+
+    if ((_message != "") || !st->AddSymbol(s)) {
+      Error("duplicate symbol '" + name + "'.");
+      delete s;
+      return;
+    }
+
+    _symbols.push_back(s);
+    if (stype == stProcedure) _procs.push_back((CSymProc*)s);
+  }
+}
+
+void CIRReader::ReadParams(void)
+{
+  for (CSymProc *p : _procs) {
+    unsigned long long n = Get();
+
+    for (unsigned long long i=0; (i<n) && (_message == ""); i++) {
+      CSymParam *param = NULL;
+
+      unsigned long long idx = Get();
+      if (idx == 0) {
+        int index = GetUInt();
+        string name = GetString();
+        const CType *type = GetType();
+        if ((name != "") && (type != NULL)) param = _arena->New<CSymParam>(index, name, type);
+      } else if (idx <= _symbols.size()) {
+        param = dynamic_cast<CSymParam*>(_symbols[idx-1]);
+      }
+
+      if ((param == NULL) || (param->GetIndex() != (int)i)) {
+        Error("invalid parameter of procedure '" + p->GetName() + "'.");
+        return;
+      }
+
+      p->AddParam(param);
+    }
+  }
+}
+
+void CIRReader::ReadScope(CScope *s)
+{
+  CCodeBlock *cb = s->GetCodeBlock();
+
+  s->_temp_id = GetUInt();
+  s->_label_id = GetUInt();
+  unsigned int inst_id = GetUInt();
+  cb->_prof_id = GetInt();
+
+  // parameters belong to the declaration of the procedure
+  const CSymProc *proc = dynamic_cast<const CSymProc*>(s->GetDeclaration());
+  for (const CSymbol *sym : s->GetSymbolTable()->GetSymbols()) {
+    if (sym->GetSymbolType() != stParam) continue;
+
+    unsigned int index = ((const CSymParam*)sym)->GetIndex();
+    if ((proc == NULL) || (index >= proc->GetNParams()) || (proc->GetParam(index) != sym)) {
+      Error("invalid parameter '" + sym->GetName() + "' in scope '" + s->GetName() + "'.");
+      return;
+    }
+  }
+
+  // labels
+  unsigned long long nlabels = Get();
+  if (nlabels > (unsigned long long)(_end - _pos)) {
+    Error("invalid number of labels.");
+    return;
+  }
+
+  // labels created later by CreateLabel() must not clash with the loaded ones
+  vector<CTacLabel*> labels;
+  vector<bool> placed(nlabels, false);
+  set<string> names;
+  for (unsigned long long i=0; (i<nlabels) && (_message == ""); i++) {
+    string name = GetString();
+    if ((name == "") || !names.insert(name).second || (LabelId(name) >= s->_label_id)) {
+      Error("invalid label '" + name + "' in scope '" + s->GetName() + "'.");
+      return;
+    }
+    labels.push_back(s->_arena.New<CTacLabel>(name));
+  }
+
+  // instructions; the parameters of a call precede it and are within its parameter list
+  vector<long long> args;
+  unsigned long long ninstr = Get();
+  for (unsigned long long i=0; (i<ninstr) && (_message == ""); i++) {
+    unsigned long long op = Get();
+    unsigned int id = GetUInt();
+    int pid = GetInt();
+    bool pinv = Get() != 0;
+    CTacInstr *instr = NULL;
+
+    if (op > opNop) {
+      Error("invalid operation.");
+      return;
+    }
+
+    if (op == opLabel) {
+      unsigned long long idx = Get();
+      if ((idx >= labels.size()) || placed[idx]) {
+        Error("invalid label.");
+        return;
+      }
+      placed[idx] = true;
+      instr = labels[idx];
+    } else {
+      CTac *dst = GetOperand(s, labels);
+      CTac *src1 = GetOperand(s, labels);
+      CTac *src2 = GetOperand(s, labels);
+
+      if (!ValidOperands((EOperation)op, dst, src1, src2)) Error("invalid operands.");
+      if (_message != "") return;
+
+      if (op == opParam) {
+        args.push_back(((CTacConst*)dst)->GetValue());
+      } else if (op == opCall) {
+        const CSymProc *callee = dynamic_cast<const CSymProc*>(((CTacName*)src1)->GetSymbol());
+        for (long long a : args) {
+          if ((callee == NULL) || (a < 0) || (a >= callee->GetNParams())) {
+            Error("invalid call in scope '" + s->GetName() + "'.");
+            return;
+          }
+        }
+        args.clear();
+      }
+
+      instr = s->CreateInstr((EOperation)op, dst, (CTacAddr*)src1, (CTacAddr*)src2);
+    }
+
+    cb->AddInstr(instr);
+    instr->SetId(id);
+    instr->SetProfileId(pid, pinv);
+  }
+
+  if ((_message == "") && !args.empty()) {
+    Error("parameter without call in scope '" + s->GetName() + "'.");
+  }
+
+  cb->_inst_id = inst_id;
+
+  // subscopes
+  unsigned long long nchildren = Get();
+  for (unsigned long long i=0; (i<nchildren) && (_message == ""); i++) {
+    string name = GetString();
+    unsigned long long st = Get();
+    CSymProc *decl = dynamic_cast<CSymProc*>(GetSymbol());
+
+    // a procedure is nested in the scope declaring it and is reached through its declaration
+    if ((st >= _symtabs.size()) || _attached[st] ||
+        (_symtabs[st]->GetParent() != s->GetSymbolTable()) || (decl == NULL) ||
+        (decl->GetName() != name) || decl->IsExternal() ||
+        (s->GetSymbolTable()->FindSymbol(decl->GetAtom(), sLocal) != decl) ||
+        !_defined.insert(decl).second) {
+      Error("invalid procedure '" + name + "'.");
+      return;
+    }
+
+    CProcedure *p = new CProcedure(name, _symtabs[st], decl, s);
+    _attached[st] = true;
+    s->_children.push_back(p);
+
+    ReadScope(p);
+  }
+}
+
+void CIRReader::Error(const string message)
+{
+  if (_message == "") _message = message;
+}
@@ -0,0 +1,223 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL binary IR files
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_IRFILE_H__
+#define __SnuPL_IRFILE_H__
+
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "ir.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief binary IR file format
+///
+/// An IR file holds the TAC of a module at any point of the optimization pipeline and is loaded
+/// without scanning, parsing, or type checking the source code. The file is designed to be read
+/// directly from memory (e.g., a memory-mapped file); all integers are little-endian.
+///
+///   header        magic "SnuPL/IR", u32 version, u32 number of strings, u32 offset of the
+///                 string index, u32 offset of the string data, u32 offset of the body,
+///                 u32 file size, u32 FNV-1a checksum of the rest of the file
+///   string index  u32 offset of each string in the string data plus one end offset, so that
+///                 every string is accessible in constant time
+///   string data   the strings without separators
+///   body          type table, symbol tables, and scopes, encoded as a stream of unsigned LEB128
+///                 varints (signed values are zigzag-encoded)
+///
+/// The body references strings, types, symbols, and labels by their index in the respective
+/// table. Types 1-6 are the base types (null, boolean, char, integer, longint, and the void
+/// pointer); the type table lists the pointer and array types of the type manager in order
+/// of creation, each after the types it depends on. The symbol tables are followed by the
+/// module scope and its procedures in preorder; each scope lists its labels followed by its
+/// instructions. Instruction ids, profile ids, and the counters for new temporaries and labels
+/// are preserved, so that a loaded module prints identically and can be optimized further.
+///
+
+/// @brief version of the IR file format
+const unsigned int IRFileVersion = 1;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief IR file writer
+///
+/// Serializes a module into the binary IR file format.
+///
+class CIRWriter {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    CIRWriter(void);
+    ~CIRWriter(void);
+
+    /// @}
+
+
+    /// @brief serialize module @a m to @a out
+    /// @retval true on success
+    /// @retval false if the module cannot be represented (see GetErrorMessage())
+    bool Write(const CModule *m, ostream &out);
+
+    /// @brief return a human-readable error message of the last failed Write()
+    string GetErrorMessage(void) const;
+
+  private:
+    /// @brief encoding of the body
+    /// @{
+    void Put(unsigned long long v);
+    void PutSigned(long long v);
+    void PutString(const string &s);
+    void PutType(const CType *t);
+    void PutSymbol(const CSymbol *s);
+    void PutData(const CDataInitializer *data);
+    void PutOperand(const CTac *t, const unordered_map<const CTacLabel*, unsigned int> &labels);
+    /// @}
+
+    /// @brief add type @a t and the types it depends on to the type table
+    void AddType(const CType *t);
+
+    /// @brief write the type table
+    void WriteTypes(void);
+
+    /// @brief write the symbol table @a st and number its symbols
+    void WriteSymtab(const CSymtab *st);
+
+    /// @brief write scope @a s and its subscopes
+    void WriteScope(const CScope *s);
+
+    /// @brief record an error (only the first error is kept)
+    void Error(const string message);
+
+    string _body;                   ///< encoded body
+    vector<string> _strings;        ///< string table
+    vector<const CType*> _types;    ///< type table
+    unordered_map<string, unsigned int>
+                   _string_idx;     ///< string indices
+    unordered_map<const CType*, unsigned int>
+                   _type_idx;       ///< type indices
+    unordered_map<const CSymtab*, unsigned int>
+                   _symtab_idx;     ///< symbol table indices
+    unordered_map<const CSymbol*, unsigned int>
+                   _symbol_idx;     ///< symbol indices
+    string _message;                ///< error message
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief IR file reader
+///
+/// Loads a module from the binary IR file format. Types and names are created in the type
+/// manager and atom table of the calling thread; the returned module owns its symbol tables
+/// and is independent of the reader.
+///
+/// The reader rejects corrupt files (checksum) and checks the structure of the IR (indices,
+/// operand kinds of each operation, value ranges) as well as the properties the backend and the
+/// interpreter rely on: symbol initializers match their types, operands refer to symbols visible
+/// in their scope, parameters belong to the declaration of their procedure, the arguments of a
+/// call are within its parameter list, and the counters for new labels exceed the existing ones.
+/// It does not type check the instructions.
+///
+class CIRReader {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    CIRReader(void);
+    ~CIRReader(void);
+
+    /// @}
+
+
+    /// @brief return true if the @a size bytes at @a data start with the magic of an IR file
+    static bool IsIRFile(const char *data, size_t size);
+
+    /// @brief load a module from the @a size bytes at @a data (e.g., a memory-mapped file)
+    /// @retval CModule* module (owned by the caller)
+    /// @retval NULL if the data is not a valid IR file (see GetErrorMessage())
+    CModule* Load(const char *data, size_t size);
+
+    /// @brief load a module from the (memory-mapped) IR file @a file
+    /// @retval CModule* module (owned by the caller)
+    /// @retval NULL if the file cannot be read or is not a valid IR file
+    CModule* Load(const string file);
+
+    /// @brief return a human-readable error message of the last failed Load()
+    string GetErrorMessage(void) const;
+
+  private:
+    /// @brief decoding of the body
+    /// @{
+    unsigned long long Get(void);
+    long long GetSigned(void);
+    unsigned int GetUInt(void);
+    int GetInt(void);
+    string GetString(void);
+    const CType* GetType(void);
+    CSymbol* GetSymbol(void);
+    CDataInitializer* GetData(void);
+    CTac* GetOperand(CScope *s, const vector<CTacLabel*> &labels);
+    /// @}
+
+    /// @brief read the type table
+    void ReadTypes(void);
+
+    /// @brief read the symbols of symbol table @a st
+    void ReadSymtab(CSymtab *st);
+
+    /// @brief read the parameter lists of the procedure symbols
+    void ReadParams(void);
+
+    /// @brief read the code and the subscopes of scope @a s
+    void ReadScope(CScope *s);
+
+    /// @brief record an error (only the first error is kept)
+    void Error(const string message);
+
+    const unsigned char *_pos;      ///< current position in the body
+    const unsigned char *_end;      ///< end of the body
+    unsigned int _nstrings;         ///< number of strings
+    const unsigned char *_string_idx; ///< string index
+    const unsigned char *_string_data;///< string data
+    size_t _string_size;            ///< size of the string data
+    vector<const CType*> _types;    ///< type table
+    vector<CSymtab*> _symtabs;      ///< symbol tables
+    vector<bool> _attached;         ///< symbol table is owned by a scope
+    vector<CSymbol*> _symbols;      ///< symbols
+    vector<CSymProc*> _procs;       ///< procedure symbols (parameters pending)
+    set<const CSymProc*> _defined;  ///< procedures with a scope
+    CArena *_arena;                 ///< arena of the module (data initializers, parameters)
+    string _message;                ///< error message
+};
+
+
+#endif // __SnuPL_IRFILE_H__
@@ -0,0 +1,448 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL optimizations
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_OPT_H__
+#define __SnuPL_OPT_H__
+
+#include <map>
+#include <set>
+#include <vector>
+#include <string>
+#include <functional>
+
+#include "ir.h"
+#include "cfg.h"
+#include "profile.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief basic block layout
+///
+/// Reorders the basic blocks of a scope so that the likely successor of each block becomes its
+/// fall-through successor (Pettis-Hansen bottom-up chaining). Loops are rotated so that the test
+/// sits at the bottom, branch conditions are inverted where the taken successor is placed next,
+/// and cold blocks are moved to the end of the scope.
+///
+/// Edge weights are taken from the execution profile if available, otherwise they are estimated
+/// with static heuristics (loop branches are taken, loop exits and returns are unlikely).
+///
+class CBlockLayout {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param scope scope to optimize
+    /// @param cfg control flow graph of @a scope (invalid after Run())
+    CBlockLayout(CScope *scope, CControlFlowGraph *cfg);
+
+    /// @brief destructor
+    virtual ~CBlockLayout(void);
+
+    /// @}
+
+    /// @brief run the pass
+    /// @retval true if the block order has changed
+    bool Run(void);
+
+  private:
+    /// @brief return the probability that the branch terminating @a b is taken
+    double TakenProbability(const CBasicBlock *b) const;
+
+    /// @brief return the probability of the edge @a from -> @a to
+    double EdgeProbability(const CBasicBlock *from, const CBasicBlock *to) const;
+
+    /// @brief compute block frequencies from the profile
+    /// @retval false if the profile has no data for this scope
+    bool ProfileFrequencies(void);
+
+    /// @brief estimate block frequencies statically
+    void EstimateFrequencies(void);
+
+    /// @brief merge blocks into chains along the heaviest edges
+    void BuildChains(void);
+
+    /// @brief order the chains, cold chains last
+    void PlaceChains(void);
+
+    /// @brief rewrite the instruction list of the code block in the new order
+    void Emit(void);
+
+    /// @brief returns true if @a b is cold
+    bool IsCold(const CBasicBlock *b) const;
+
+    /// @brief return the label of @a b (its leading label or the one created for it)
+    CTacLabel* Label(const CBasicBlock *b) const;
+
+    CScope *_scope;                  ///< scope
+    CControlFlowGraph *_cfg;         ///< control flow graph
+    const CProfile *_profile;        ///< execution profile (NULL if none)
+    bool _use_profile;               ///< frequencies are based on the profile
+
+    map<const CBasicBlock*, CTacLabel*> _label; ///< labels created for unlabeled blocks
+    map<const CBasicBlock*, double> _freq;   ///< block frequencies
+    vector<vector<CBasicBlock*>> _chains;    ///< block chains
+    map<const CBasicBlock*, size_t> _chain;  ///< block -> chain index
+    vector<CBasicBlock*> _order;             ///< final block order
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief interprocedural mod/ref summaries
+///
+/// Computes for each procedure of a module the set of global variables the procedure or any of
+/// the procedures it calls (transitively) may modify or reference. External procedures do not
+/// access the globals of a module. Globals whose address is taken may be accessed through
+/// pointers and are reported by IsAddressTaken().
+///
+class CModRef {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param m module to analyze
+    CModRef(CModule *m);
+
+    /// @brief destructor
+    virtual ~CModRef(void);
+
+    /// @}
+
+    /// @name summaries
+    /// @{
+
+    /// @brief return the set of globals @a proc may modify
+    const set<const CSymbol*>& GetMod(const CSymbol *proc) const;
+
+    /// @brief return the set of globals @a proc may reference
+    const set<const CSymbol*>& GetRef(const CSymbol *proc) const;
+
+    /// @brief returns true if @a proc may modify @a global
+    bool MayMod(const CSymbol *proc, const CSymbol *global) const;
+
+    /// @brief returns true if @a proc may reference @a global
+    bool MayRef(const CSymbol *proc, const CSymbol *global) const;
+
+    /// @brief returns true if the address of @a global is taken anywhere in the module
+    bool IsAddressTaken(const CSymbol *global) const;
+
+    /// @}
+
+  private:
+    /// @brief mod/ref summary of a procedure
+    struct Summary {
+      set<const CSymbol*> mod;       ///< modified globals
+      set<const CSymbol*> ref;       ///< referenced globals
+      set<const CSymbol*> callees;   ///< directly called procedures
+    };
+
+    /// @brief collect the direct accesses and calls of @a scope
+    void Collect(CScope *scope, Summary &s);
+
+    map<const CSymbol*, Summary> _summary;  ///< procedure -> summary
+    set<const CSymbol*> _addr;              ///< globals whose address is taken
+    Summary _none;                          ///< summary of external procedures
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief liveness of temporaries
+///
+/// Computes the temporaries that are live at the entry and the exit of each basic block of a
+/// control flow graph. Only temporaries are tracked; variables may be accessed through pointers
+/// and by called procedures.
+///
+class CLiveness {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param cfg control flow graph
+    CLiveness(const CControlFlowGraph *cfg);
+
+    /// @brief destructor
+    virtual ~CLiveness(void);
+
+    /// @}
+
+    /// @name liveness
+    /// @{
+
+    /// @brief return the temporaries live at the entry of @a b
+    const set<const CSymbol*>& GetLiveIn(const CBasicBlock *b) const;
+
+    /// @brief return the temporaries live at the exit of @a b
+    const set<const CSymbol*>& GetLiveOut(const CBasicBlock *b) const;
+
+    /// @brief return the temporary defined by @a instr (NULL if none)
+    static const CSymbol* GetDef(const CTacInstr *instr);
+
+    /// @brief add the temporaries used by @a instr to @a uses
+    static void GetUses(const CTacInstr *instr, set<const CSymbol*> &uses);
+
+    /// @}
+
+    /// @name output
+    /// @{
+
+    /// @brief print the live sets to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+    /// @}
+
+  private:
+    const CControlFlowGraph *_cfg;                       ///< control flow graph
+    map<const CBasicBlock*, set<const CSymbol*>> _in;    ///< block -> live-in set
+    map<const CBasicBlock*, set<const CSymbol*>> _out;   ///< block -> live-out set
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief analyses managed by the analysis manager
+///
+enum EAnalysis {
+  anNone       = 0,                 ///< no analysis
+  anCFG        = 1 << 0,            ///< control flow graph
+  anDominators = 1 << 1,            ///< dominator tree (requires the CFG)
+  anLiveness   = 1 << 2,            ///< liveness of temporaries (requires the CFG)
+  anAll        = anCFG | anDominators | anLiveness,
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief analysis manager
+///
+/// Computes the analyses of the scopes of a module on demand and caches them until a pass that
+/// modifies a scope invalidates them. An analysis is invalidated together with the analyses it
+/// requires.
+///
+class CAnalysisManager {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    CAnalysisManager(void);
+
+    /// @brief destructor
+    virtual ~CAnalysisManager(void);
+
+    /// @}
+
+    /// @name analyses
+    /// @{
+
+    /// @brief return the control flow graph of @a s
+    CControlFlowGraph* GetCFG(CScope *s);
+
+    /// @brief return the dominator tree of @a s
+    CDominatorTree* GetDominators(CScope *s);
+
+    /// @brief return the liveness of temporaries of @a s
+    CLiveness* GetLiveness(CScope *s);
+
+    /// @brief invalidate the analyses of @a s except @a preserved (a set of EAnalysis)
+    void Invalidate(CScope *s, unsigned int preserved=anNone);
+
+    /// @brief invalidate the analyses of all scopes except @a preserved (a set of EAnalysis)
+    void InvalidateAll(unsigned int preserved=anNone);
+
+    /// @}
+
+  private:
+    CAnalysisManager(const CAnalysisManager&) = delete;
+    CAnalysisManager& operator=(const CAnalysisManager&) = delete;
+
+    /// @brief cached analyses of a scope
+    struct SAnalyses {
+      CControlFlowGraph *cfg;        ///< control flow graph
+      CDominatorTree *dom;           ///< dominator tree
+      CLiveness *live;               ///< liveness
+    };
+
+    map<CScope*, SAnalyses> _cache;  ///< scope -> analyses
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief optimization pass
+///
+/// Passes are either function passes that run on each scope (module body and procedures) in turn,
+/// or module passes that run on the whole module. A pass returns whether it has modified the IR
+/// and declares the analyses it preserves in that case.
+///
+class CPass {
+  public:
+    /// @brief destructor
+    virtual ~CPass(void);
+
+    /// @brief return the name of the pass
+    virtual const char* GetName(void) const = 0;
+
+    /// @brief return the analyses preserved by the pass (a set of EAnalysis)
+    virtual unsigned int GetPreserved(void) const;
+};
+
+/// @brief function pass
+class CFunctionPass : public CPass {
+  public:
+    /// @brief run the pass on scope @a s
+    /// @retval true if the IR of @a s has been modified
+    virtual bool Run(CScope *s, CAnalysisManager &am) = 0;
+};
+
+/// @brief module pass
+class CModulePass : public CPass {
+  public:
+    /// @brief run the pass on module @a m
+    /// @retval true if the IR of @a m has been modified
+    virtual bool Run(CModule *m, CAnalysisManager &am) = 0;
+};
+
+//--------------------------------------------------------------------------------------------------
+/// @brief pass manager
+///
+/// Runs a pipeline of passes over a module and keeps the analyses of the analysis manager up to
+/// date. Pipelines are comma-separated lists of pass names; GetPipeline() returns the pipelines
+/// of the optimization levels -O0, -O1, and -O2.
+///
+class CPassManager {
+  public:
+    /// @name constructors/destructors
+    /// @{
+
+    /// @brief constructor
+    /// @param log output stream of passes that print analyses (may be NULL)
+    CPassManager(ostream *log=NULL);
+
+    /// @brief destructor
+    virtual ~CPassManager(void);
+
+    /// @}
+
+    /// @name pipeline
+    /// @{
+
+    /// @brief append the passes in the comma-separated list @a pipeline
+    /// @retval true on success
+    /// @retval false if a pass is unknown
+    bool AddPasses(const string &pipeline);
+
+    /// @brief return the pipeline of optimization level @a level (0-2)
+    static string GetPipeline(int level);
+
+    /// @brief returns true if @a name is the name of a pass
+    static bool IsPass(const string &name);
+
+    /// @brief set a function called after each pass has been run
+    void SetCallback(const function<void(const CPass*)> &after);
+
+    /// @brief run the pipeline on module @a m
+    void Run(CModule *m);
+
+    /// @brief return the error message
+    string GetErrorMessage(void) const;
+
+    /// @}
+
+  private:
+    CPassManager(const CPassManager&) = delete;
+    CPassManager& operator=(const CPassManager&) = delete;
+
+    /// @brief run function pass @a p on @a s and its subscopes
+    void Run(CFunctionPass *p, CScope *s);
+
+    vector<CPass*> _passes;          ///< pipeline
+    CAnalysisManager _am;            ///< analysis manager
+    function<void(const CPass*)> _after; ///< callback run after each pass
+    ostream *_log;                   ///< output stream of passes that print analyses
+    string _message;                 ///< error message
+};
+
+
+//--------------------------------------------------------------------------------------------------
+// passes
+//
+
+/// @brief basic block layout (CBlockLayout)
+class CLayoutPass : public CFunctionPass {
+  public:
+    virtual const char* GetName(void) const { return "layout"; };
+    virtual bool Run(CScope *s, CAnalysisManager &am);
+};
+
+/// @brief remove basic blocks that are unreachable from the entry
+class CUnreachablePass : public CFunctionPass {
+  public:
+    virtual const char* GetName(void) const { return "unreachable"; };
+    virtual bool Run(CScope *s, CAnalysisManager &am);
+};
+
+/// @brief redirect branches to blocks that consist of a single goto to the goto's target
+class CJumpThreadingPass : public CFunctionPass {
+  public:
+    virtual const char* GetName(void) const { return "jumps"; };
+    virtual bool Run(CScope *s, CAnalysisManager &am);
+};
+
+/// @brief remove side-effect free instructions that define dead temporaries
+class CDeadCodePass : public CFunctionPass {
+  public:
+    virtual const char* GetName(void) const { return "dce"; };
+    virtual unsigned int GetPreserved(void) const { return anCFG | anDominators; };
+    virtual bool Run(CScope *s, CAnalysisManager &am);
+};
+
+/// @brief remove procedures that are not called from the module body (transitively)
+class CDeadProcedurePass : public CModulePass {
+  public:
+    virtual const char* GetName(void) const { return "dpe"; };
+    virtual unsigned int GetPreserved(void) const { return anAll; };
+    virtual bool Run(CModule *m, CAnalysisManager &am);
+};
+
+/// @brief print an analysis of each scope to the log (debugging aid)
+class CPrintAnalysisPass : public CFunctionPass {
+  public:
+    /// @brief constructor
+    /// @param analysis analysis to print
+    /// @param out output stream (NULL: print nothing)
+    CPrintAnalysisPass(EAnalysis analysis, ostream *out);
+
+    virtual const char* GetName(void) const;
+    virtual unsigned int GetPreserved(void) const { return anAll; };
+    virtual bool Run(CScope *s, CAnalysisManager &am);
+
+  private:
+    EAnalysis _analysis;             ///< analysis to print
+    ostream  *_out;                  ///< output stream
+};
+
+
+#endif // __SnuPL_OPT_H__
@@ -0,0 +1,129 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL dead code elimination
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+
+#include "opt.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CDeadCodePass
+//
+
+/// @brief returns true if @a op has no effect besides defining its destination. Divisions may
+///        trap and dereferences may fault, so they are kept.
+static bool IsPure(EOperation op)
+{
+  switch (op) {
+    case opAdd: case opSub: case opMul: case opAnd: case opOr:
+    case opNeg: case opPos: case opNot:
+    case opAssign: case opAddress: case opCast: case opWiden: case opNarrow:
+      return true;
+    default:
+      return false;
+  }
+}
+
+bool CDeadCodePass::Run(CScope *s, CAnalysisManager &am)
+{
+  bool changed = false, removed = true;
+
+  // removing an instruction may make the definitions of its operands dead
+  while (removed) {
+    CControlFlowGraph *cfg = am.GetCFG(s);
+    CLiveness *live = am.GetLiveness(s);
+    vector<pair<CBasicBlock*, CTacInstr*>> dead;
+
+    for (CBasicBlock *b : cfg->GetBlocks()) {
+      set<const CSymbol*> l = live->GetLiveOut(b);
+      const vector<CTacInstr*> &instr = b->GetInstr();
+
+      for (size_t k=instr.size(); k-- > 0; ) {
+        CTacInstr *i = instr[k];
+        const CSymbol *d = CLiveness::GetDef(i);
+
+        if ((d != NULL) && IsPure(i->GetOperation()) && (l.find(d) == l.end())) {
+          dead.push_back(make_pair(b, i));
+          continue;
+        }
+
+        if (d != NULL) l.erase(d);
+        CLiveness::GetUses(i, l);
+      }
+    }
+
+    for (const auto &d : dead) cfg->RemoveInstr(d.first, d.second);
+
+    removed = !dead.empty();
+    if (removed) am.Invalidate(s, GetPreserved());
+    changed = changed || removed;
+  }
+
+  return changed;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CDeadProcedurePass
+//
+bool CDeadProcedurePass::Run(CModule *m, CAnalysisManager &am)
+{
+  map<const CSymbol*, CScope*> proc;
+  for (CScope *c : m->GetSubscopes()) proc[c->GetDeclaration()] = c;
+
+  // procedures reachable from the module body in the call graph
+  set<CScope*> called;
+  vector<CScope*> work { m };
+  while (!work.empty()) {
+    CScope *s = work.back();
+    work.pop_back();
+
+    for (CTacInstr *i : s->GetCodeBlock()->GetInstr()) {
+      if (i->GetOperation() != opCall) continue;
+
+      CTacName *n = dynamic_cast<CTacName*>(i->GetSrc(1));
+      assert(n != NULL);
+
+      auto it = proc.find(n->GetSymbol());
+      if ((it != proc.end()) && called.insert(it->second).second) work.push_back(it->second);
+    }
+  }
+
+  vector<CScope*> dead;
+  for (CScope *c : m->GetSubscopes()) {
+    if (called.find(c) == called.end()) dead.push_back(c);
+  }
+
+  for (CScope *c : dead) {
+    am.Invalidate(c);
+    m->RemoveSubscope(c);
+  }
+
+  return !dead.empty();
+}
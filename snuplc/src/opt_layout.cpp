@@ -0,0 +1,345 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL basic block layout
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+
+#include "opt.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+// static branch prediction heuristics (Ball/Larus)
+//
+#define PROB_LOOP_BRANCH      0.88    ///< probability that a loop branch is taken
+#define PROB_RETURN           0.28    ///< probability of branching to a returning block
+#define LOOP_SCALE            8.0     ///< estimated iterations per loop entry (~1/(1-0.88))
+
+#define COLD_STATIC           0.3     ///< cold threshold relative to entry (static estimates)
+#define COLD_PROFILE          0.01    ///< cold threshold relative to entry (profile)
+
+
+//--------------------------------------------------------------------------------------------------
+// CBlockLayout
+//
+CBlockLayout::CBlockLayout(CScope *scope, CControlFlowGraph *cfg)
+  : _scope(scope), _cfg(cfg), _profile(NULL), _use_profile(false)
+{
+  assert((scope != NULL) && (cfg != NULL));
+  _profile = scope->GetProfile();
+}
+
+CBlockLayout::~CBlockLayout(void)
+{
+}
+
+bool CBlockLayout::Run(void)
+{
+  CCodeBlock *cb = _scope->GetCodeBlock();
+
+  // give every reachable block a label up front so that branches can be redirected to it.
+  // This happens before the layout is computed so that instrumented and profile-optimized
+  // compilations agree on the label names; Emit() places the labels in front of their blocks
+  // and unused ones are removed again by CleanupControlFlow().
+  for (CBasicBlock *b : _cfg->GetBlocks()) {
+    if ((b->GetLabel() == NULL) && (b != _cfg->GetEntry()) && !b->GetPredecessors().empty()) {
+      _label[b] = cb->CreateLabel();
+    }
+  }
+
+  if (_cfg->GetBlocks().size() < 3) {
+    _order = _cfg->GetBlocks();
+    Emit();
+    return false;
+  }
+
+  _use_profile = ProfileFrequencies();
+  if (!_use_profile) EstimateFrequencies();
+
+  BuildChains();
+  PlaceChains();
+
+  bool changed = false;
+  for (size_t i=0; i<_order.size(); i++) {
+    if (_order[i] != _cfg->GetBlocks()[i]) changed = true;
+  }
+
+  Emit();
+
+  return changed;
+}
+
+double CBlockLayout::TakenProbability(const CBasicBlock *b) const
+{
+  CTacInstr *t = b->GetTerminator();
+  CBasicBlock *T = b->GetTaken(), *F = b->GetFallthrough();
+
+  if ((t == NULL) || !IsRelOp(t->GetOperation()) || (F == NULL)) return 1.0;
+
+  // profile
+  unsigned long long taken, fall;
+  if (_use_profile && _profile->GetBranchCounts(_scope, t, taken, fall) && (taken+fall > 0)) {
+    return (double)taken / (double)(taken+fall);
+  }
+
+  // loop branch heuristic: back edges are taken, loop exits are not
+  bool bT = _cfg->IsBackEdge(b, T), bF = _cfg->IsBackEdge(b, F);
+  if (bT != bF) return bT ? PROB_LOOP_BRANCH : 1.0-PROB_LOOP_BRANCH;
+
+  CBasicBlock *h = _cfg->GetLoopHeader(b);
+  if (h != NULL) {
+    bool iT = _cfg->InLoop(T, h), iF = _cfg->InLoop(F, h);
+    if (iT != iF) return iT ? PROB_LOOP_BRANCH : 1.0-PROB_LOOP_BRANCH;
+  }
+
+  // return heuristic: successors leaving the scope are unlikely
+  bool rT = T->IsExit(), rF = F->IsExit();
+  if (rT != rF) return rT ? PROB_RETURN : 1.0-PROB_RETURN;
+
+  return 0.5;
+}
+
+double CBlockLayout::EdgeProbability(const CBasicBlock *from, const CBasicBlock *to) const
+{
+  CBasicBlock *T = from->GetTaken(), *F = from->GetFallthrough();
+
+  // unconditional control transfer
+  if ((T == NULL) || (F == NULL) || (T == F)) return (to == T) || (to == F) ? 1.0 : 0.0;
+
+  double p = TakenProbability(from);
+  if (to == T) return p;
+  if (to == F) return 1.0-p;
+  return 0.0;
+}
+
+bool CBlockLayout::ProfileFrequencies(void)
+{
+  if (_profile == NULL) return false;
+
+  double entry = (double)_profile->GetEntryCount(_scope);
+  if (entry == 0.0) return false;
+
+  const vector<CBasicBlock*> &blocks = _cfg->GetBlocks();
+  for (size_t i=0; i<blocks.size(); i++) {
+    CBasicBlock *b = blocks[i];
+    double f = 0.0;
+
+    if (Label(b) != NULL) {
+      f = (double)_profile->GetLabelCount(_scope, Label(b));
+    } else if (b == _cfg->GetEntry()) {
+      f = entry;
+    } else if (i > 0) {
+      // unlabeled blocks are only reachable by falling through a conditional branch
+      CTacInstr *t = blocks[i-1]->GetTerminator();
+      unsigned long long taken, fall;
+      if ((t != NULL) && _profile->GetBranchCounts(_scope, t, taken, fall)) f = (double)fall;
+    }
+
+    _freq[b] = f;
+  }
+
+  // the entry block may also be a loop header
+  _freq[_cfg->GetEntry()] = max(_freq[_cfg->GetEntry()], entry);
+
+  return true;
+}
+
+void CBlockLayout::EstimateFrequencies(void)
+{
+  // propagate frequencies along forward edges in reverse postorder; loop headers are scaled by
+  // the expected number of iterations
+  for (CBasicBlock *b : _cfg->GetReversePostorder()) {
+    double f = (b == _cfg->GetEntry()) ? 1.0 : 0.0;
+
+    for (CBasicBlock *p : b->GetPredecessors()) {
+      if (_cfg->IsBackEdge(p, b)) continue;
+      f += _freq[p] * EdgeProbability(p, b);
+    }
+
+    if (_cfg->IsLoopHeader(b)) f *= LOOP_SCALE;
+
+    _freq[b] = f;
+  }
+}
+
+bool CBlockLayout::IsCold(const CBasicBlock *b) const
+{
+  if (b == _cfg->GetEntry()) return false;
+
+  auto f = _freq.find(b);
+  double freq = f != _freq.end() ? f->second : 0.0;
+  double entry = _freq.find(_cfg->GetEntry())->second;
+
+  return freq < entry * (_use_profile ? COLD_PROFILE : COLD_STATIC);
+}
+
+CTacLabel* CBlockLayout::Label(const CBasicBlock *b) const
+{
+  if (b->GetLabel() != NULL) return b->GetLabel();
+
+  auto l = _label.find(b);
+  return l != _label.end() ? l->second : NULL;
+}
+
+void CBlockLayout::BuildChains(void)
+{
+  struct Edge {
+    CBasicBlock *from, *to;
+    double weight;
+    bool back;
+  };
+  vector<Edge> edges;
+
+  const vector<CBasicBlock*> &blocks = _cfg->GetBlocks();
+  for (CBasicBlock *b : blocks) {
+    _chain[b] = _chains.size();
+    _chains.push_back(vector<CBasicBlock*>(1, b));
+
+    for (CBasicBlock *s : b->GetSuccessors()) {
+      Edge e = { b, s, _freq[b] * EdgeProbability(b, s), _cfg->IsBackEdge(b, s) };
+      edges.push_back(e);
+    }
+  }
+
+  // heaviest edges first; on ties prefer back edges which rotates loops such that the loop
+  // test ends up at the bottom
+  stable_sort(edges.begin(), edges.end(), [](const Edge &a, const Edge &b) {
+    if (a.weight != b.weight) return a.weight > b.weight;
+    return a.back && !b.back;
+  });
+
+  for (const Edge &e : edges) {
+    if ((e.weight <= 0.0) || (e.to == _cfg->GetEntry())) continue;
+    if (IsCold(e.from) != IsCold(e.to)) continue;
+
+    size_t cf = _chain[e.from], ct = _chain[e.to];
+    if ((cf == ct) || (_chains[cf].back() != e.from) || (_chains[ct].front() != e.to)) continue;
+
+    // append chain ct to chain cf
+    for (CBasicBlock *b : _chains[ct]) {
+      _chains[cf].push_back(b);
+      _chain[b] = cf;
+    }
+    _chains[ct].clear();
+  }
+}
+
+void CBlockLayout::PlaceChains(void)
+{
+  vector<bool> placed(_chains.size(), false);
+  set<const CBasicBlock*> done;
+
+  auto place = [&](size_t c) {
+    placed[c] = true;
+    for (CBasicBlock *b : _chains[c]) {
+      _order.push_back(b);
+      done.insert(b);
+    }
+  };
+
+  place(_chain[_cfg->GetEntry()]);
+
+  // hot chains: pick the chain most strongly connected to the blocks placed so far
+  while (true) {
+    size_t best = _chains.size();
+    double bestw = -1.0;
+
+    for (size_t c=0; c<_chains.size(); c++) {
+      if (placed[c] || _chains[c].empty() || IsCold(_chains[c].front())) continue;
+
+      double w = 0.0;
+      for (CBasicBlock *b : _chains[c]) {
+        for (CBasicBlock *p : b->GetPredecessors()) {
+          if (done.find(p) != done.end()) w = max(w, _freq[p] * EdgeProbability(p, b));
+        }
+      }
+
+      if (w > bestw) {
+        best = c;
+        bestw = w;
+      }
+    }
+
+    if (best == _chains.size()) break;
+    place(best);
+  }
+
+  // cold chains in their original order
+  for (size_t c=0; c<_chains.size(); c++) {
+    if (!placed[c] && !_chains[c].empty()) place(c);
+  }
+
+  assert(_order.size() == _cfg->GetBlocks().size());
+}
+
+void CBlockLayout::Emit(void)
+{
+  CCodeBlock *cb = _scope->GetCodeBlock();
+  vector<CTacInstr*> instr;
+
+  for (size_t i=0; i<_order.size(); i++) {
+    CBasicBlock *b = _order[i];
+    CBasicBlock *next = i+1 < _order.size() ? _order[i+1] : NULL;
+    CBasicBlock *T = b->GetTaken(), *F = b->GetFallthrough();
+    CTacInstr *t = b->GetTerminator();
+
+    const vector<CTacInstr*> &bi = b->GetInstr();
+    if (b->GetLabel() == NULL) {
+      auto l = _label.find(b);
+      if (l != _label.end()) instr.push_back(l->second);
+    }
+    instr.insert(instr.end(), bi.begin(), bi.end() - (t != NULL ? 1 : 0));
+
+    if ((t != NULL) && IsRelOp(t->GetOperation()) && (F != NULL) && (next == T) && (next != F)) {
+      // invert the branch to fall through to the taken successor
+      assert(Label(F) != NULL);
+      CTacInstr *inv = cb->CreateInstr(InvertRelOp(t->GetOperation()), Label(F),
+                                        t->GetSrc(1), t->GetSrc(2));
+      inv->SetProfileId(t->GetProfileId(), !t->IsProfileInverted());
+      cb->RemoveInstr(t);
+      instr.push_back(inv);
+      continue;
+    }
+
+    if (t != NULL) instr.push_back(t);
+    if ((t != NULL) && ((t->GetOperation() == opGoto) || (t->GetOperation() == opReturn))) {
+      continue;
+    }
+
+    // fall-through successor is not placed next
+    if ((F != NULL) && (next != F)) {
+      assert(Label(F) != NULL);
+      instr.push_back(cb->CreateInstr(opGoto, Label(F)));
+    } else if ((F == NULL) && (next != NULL)) {
+      // block used to fall off the end of the scope
+      instr.push_back(cb->CreateInstr(opReturn, NULL));
+    }
+  }
+
+  cb->SetInstr(instr);
+  cb->CleanupControlFlow();
+}
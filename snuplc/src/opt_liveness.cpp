@@ -0,0 +1,150 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL liveness analysis
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cassert>
+
+#include "opt.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CLiveness
+//
+CLiveness::CLiveness(const CControlFlowGraph *cfg)
+  : _cfg(cfg)
+{
+  assert(cfg != NULL);
+
+  const vector<CBasicBlock*> &blocks = cfg->GetBlocks();
+
+  // temporaries defined in the code block; all other names are ignored
+  set<const CSymbol*> temps;
+  for (CBasicBlock *b : blocks) {
+    for (CTacInstr *i : b->GetInstr()) {
+      if (const CSymbol *d = GetDef(i)) temps.insert(d);
+    }
+  }
+
+  // upward-exposed uses and definitions of each block
+  map<const CBasicBlock*, set<const CSymbol*>> use, def;
+  for (CBasicBlock *b : blocks) {
+    set<const CSymbol*> &u = use[b], &d = def[b];
+
+    for (CTacInstr *i : b->GetInstr()) {
+      set<const CSymbol*> iu;
+      GetUses(i, iu);
+      for (const CSymbol *s : iu) {
+        if ((temps.find(s) != temps.end()) && (d.find(s) == d.end())) u.insert(s);
+      }
+      if (const CSymbol *s = GetDef(i)) d.insert(s);
+    }
+
+    _in[b] = u;
+    _out[b];
+  }
+
+  // iterate to a fixed point; visiting the blocks backwards converges quickly
+  bool changed = true;
+  while (changed) {
+    changed = false;
+
+    for (size_t k=blocks.size(); k-- > 0; ) {
+      CBasicBlock *b = blocks[k];
+      set<const CSymbol*> &out = _out[b], &in = _in[b];
+
+      for (CBasicBlock *s : b->GetSuccessors()) {
+        for (const CSymbol *t : _in[s]) out.insert(t);
+      }
+
+      const set<const CSymbol*> &d = def[b];
+      for (const CSymbol *t : out) {
+        if ((d.find(t) == d.end()) && in.insert(t).second) changed = true;
+      }
+    }
+  }
+}
+
+CLiveness::~CLiveness(void)
+{
+}
+
+const set<const CSymbol*>& CLiveness::GetLiveIn(const CBasicBlock *b) const
+{
+  return _in.at(b);
+}
+
+const set<const CSymbol*>& CLiveness::GetLiveOut(const CBasicBlock *b) const
+{
+  return _out.at(b);
+}
+
+const CSymbol* CLiveness::GetDef(const CTacInstr *instr)
+{
+  if (instr->IsBranch()) return NULL;
+
+  CTacTemp *t = dynamic_cast<CTacTemp*>(instr->GetDest());
+  return t != NULL ? t->GetSymbol() : NULL;
+}
+
+void CLiveness::GetUses(const CTacInstr *instr, set<const CSymbol*> &uses)
+{
+  // temporaries are read directly or dereferenced as pointers (CTacReference)
+  for (unsigned int i=1; i<=2; i++) {
+    if (CTacName *n = dynamic_cast<CTacName*>(instr->GetSrc(i))) uses.insert(n->GetSymbol());
+  }
+
+  if (CTacReference *r = dynamic_cast<CTacReference*>(instr->GetDest())) {
+    uses.insert(r->GetSymbol());
+  }
+}
+
+ostream& CLiveness::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  // print the names in alphabetical order; the sets are ordered by address
+  auto names = [](const set<const CSymbol*> &live) {
+    vector<string> n;
+    for (const CSymbol *s : live) n.push_back(s->GetName());
+    sort(n.begin(), n.end());
+
+    string res;
+    for (const string &s : n) res += " " + s;
+    return res;
+  };
+
+  out << ind << "[[ liveness " << _cfg->GetCodeBlock()->GetName() << endl;
+  for (CBasicBlock *b : _cfg->GetBlocks()) {
+    out << ind << "  BB" << b->GetId() << ":  in:" << names(GetLiveIn(b))
+        << "  out:" << names(GetLiveOut(b)) << endl;
+  }
+  out << ind << "]]" << endl;
+
+  return out;
+}
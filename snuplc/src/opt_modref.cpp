@@ -0,0 +1,131 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL interprocedural mod/ref analysis
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+
+#include "opt.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CModRef
+//
+CModRef::CModRef(CModule *m)
+{
+  assert(m != NULL);
+
+  // direct accesses of all procedures
+  for (CScope *sc : m->GetSubscopes()) {
+    Collect(sc, _summary[sc->GetDeclaration()]);
+  }
+  Summary main;
+  Collect(m, main);
+
+  // propagate the summaries of callees to their callers until nothing changes
+  bool changed = true;
+  while (changed) {
+    changed = false;
+    for (auto &p : _summary) {
+      Summary &s = p.second;
+      for (const CSymbol *c : s.callees) {
+        auto cs = _summary.find(c);
+        if ((cs == _summary.end()) || (&cs->second == &s)) continue;
+
+        size_t n = s.mod.size() + s.ref.size();
+        s.mod.insert(cs->second.mod.begin(), cs->second.mod.end());
+        s.ref.insert(cs->second.ref.begin(), cs->second.ref.end());
+        changed |= (s.mod.size() + s.ref.size() != n);
+      }
+    }
+  }
+}
+
+CModRef::~CModRef(void)
+{
+}
+
+const set<const CSymbol*>& CModRef::GetMod(const CSymbol *proc) const
+{
+  auto s = _summary.find(proc);
+  return s != _summary.end() ? s->second.mod : _none.mod;
+}
+
+const set<const CSymbol*>& CModRef::GetRef(const CSymbol *proc) const
+{
+  auto s = _summary.find(proc);
+  return s != _summary.end() ? s->second.ref : _none.ref;
+}
+
+bool CModRef::MayMod(const CSymbol *proc, const CSymbol *global) const
+{
+  if (IsAddressTaken(global)) return true;
+
+  const set<const CSymbol*> &mod = GetMod(proc);
+  return mod.find(global) != mod.end();
+}
+
+bool CModRef::MayRef(const CSymbol *proc, const CSymbol *global) const
+{
+  if (IsAddressTaken(global)) return true;
+
+  const set<const CSymbol*> &ref = GetRef(proc);
+  return ref.find(global) != ref.end();
+}
+
+bool CModRef::IsAddressTaken(const CSymbol *global) const
+{
+  return _addr.find(global) != _addr.end();
+}
+
+void CModRef::Collect(CScope *scope, Summary &s)
+{
+  for (CTacInstr *i : scope->GetCodeBlock()->GetInstr()) {
+    EOperation op = i->GetOperation();
+
+    if (op == opCall) {
+      s.callees.insert(((CTacName*)i->GetSrc(1))->GetSymbol());
+      continue;
+    }
+
+    // references to array elements (CTacReference) access memory through a pointer
+    CTacName *dst = dynamic_cast<CTacName*>(i->GetDest());
+    if ((dst != NULL) && (dynamic_cast<CTacReference*>(dst) == NULL) &&
+        (dst->GetSymbol()->GetSymbolType() == stGlobal)) {
+      s.mod.insert(dst->GetSymbol());
+    }
+
+    for (int k=1; k<=2; k++) {
+      CTacName *src = dynamic_cast<CTacName*>(i->GetSrc(k));
+      if ((src == NULL) || (dynamic_cast<CTacReference*>(src) != NULL) ||
+          (src->GetSymbol()->GetSymbolType() != stGlobal)) continue;
+
+      if (op == opAddress) _addr.insert(src->GetSymbol());
+      else s.ref.insert(src->GetSymbol());
+    }
+  }
+}
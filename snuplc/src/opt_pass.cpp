@@ -0,0 +1,289 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL pass manager
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <sstream>
+
+#include "opt.h"
+#include "timer.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// pass registry
+//
+static const struct {
+  const char *name;                     ///< name of the pass
+  CPass* (*create)(ostream *log);       ///< factory
+} Passes[] = {
+  { "dce",         [](ostream*) -> CPass* { return new CDeadCodePass(); } },
+  { "dpe",         [](ostream*) -> CPass* { return new CDeadProcedurePass(); } },
+  { "jumps",       [](ostream*) -> CPass* { return new CJumpThreadingPass(); } },
+  { "layout",      [](ostream*) -> CPass* { return new CLayoutPass(); } },
+  { "unreachable", [](ostream*) -> CPass* { return new CUnreachablePass(); } },
+  { "print-cfg",   [](ostream *log) -> CPass* { return new CPrintAnalysisPass(anCFG, log); } },
+  { "print-dom",   [](ostream *log) -> CPass* { return new CPrintAnalysisPass(anDominators, log); } },
+  { "print-live",  [](ostream *log) -> CPass* { return new CPrintAnalysisPass(anLiveness, log); } },
+};
+
+/// @brief pipelines of the optimization levels
+static const char *Pipelines[] = {
+  "",                                   // -O0
+  "layout",                             // -O1
+  "dpe,jumps,unreachable,dce,layout",   // -O2
+};
+
+
+//--------------------------------------------------------------------------------------------------
+// CAnalysisManager
+//
+CAnalysisManager::CAnalysisManager(void)
+{
+}
+
+CAnalysisManager::~CAnalysisManager(void)
+{
+  InvalidateAll();
+}
+
+CControlFlowGraph* CAnalysisManager::GetCFG(CScope *s)
+{
+  SAnalyses &a = _cache[s];
+
+  if (a.cfg == NULL) {
+    CPhaseTimer timer("cfg");
+    a.cfg = new CControlFlowGraph(s->GetCodeBlock());
+  }
+
+  return a.cfg;
+}
+
+CDominatorTree* CAnalysisManager::GetDominators(CScope *s)
+{
+  CControlFlowGraph *cfg = GetCFG(s);
+  SAnalyses &a = _cache[s];
+
+  if (a.dom == NULL) {
+    CPhaseTimer timer("dominators");
+    a.dom = new CDominatorTree(cfg);
+  }
+
+  return a.dom;
+}
+
+CLiveness* CAnalysisManager::GetLiveness(CScope *s)
+{
+  CControlFlowGraph *cfg = GetCFG(s);
+  SAnalyses &a = _cache[s];
+
+  if (a.live == NULL) {
+    CPhaseTimer timer("liveness");
+    a.live = new CLiveness(cfg);
+  }
+
+  return a.live;
+}
+
+void CAnalysisManager::Invalidate(CScope *s, unsigned int preserved)
+{
+  auto it = _cache.find(s);
+  if (it == _cache.end()) return;
+
+  // all other analyses are computed on the CFG
+  if (!(preserved & anCFG)) preserved = anNone;
+
+  SAnalyses &a = it->second;
+  if (!(preserved & anDominators)) { delete a.dom; a.dom = NULL; }
+  if (!(preserved & anLiveness)) { delete a.live; a.live = NULL; }
+  if (!(preserved & anCFG)) { delete a.cfg; a.cfg = NULL; }
+
+  if ((a.cfg == NULL) && (a.dom == NULL) && (a.live == NULL)) _cache.erase(it);
+}
+
+void CAnalysisManager::InvalidateAll(unsigned int preserved)
+{
+  vector<CScope*> scopes;
+  for (const auto &c : _cache) scopes.push_back(c.first);
+  for (CScope *s : scopes) Invalidate(s, preserved);
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CPass
+//
+CPass::~CPass(void)
+{
+}
+
+unsigned int CPass::GetPreserved(void) const
+{
+  return anNone;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CPassManager
+//
+CPassManager::CPassManager(ostream *log)
+  : _log(log)
+{
+}
+
+CPassManager::~CPassManager(void)
+{
+  for (CPass *p : _passes) delete p;
+}
+
+bool CPassManager::AddPasses(const string &pipeline)
+{
+  istringstream in(pipeline);
+  string name;
+
+  while (getline(in, name, ',')) {
+    if (name == "") continue;
+
+    CPass *pass = NULL;
+    for (const auto &p : Passes) {
+      if (name == p.name) pass = p.create(_log);
+    }
+
+    if (pass == NULL) {
+      ostringstream o;
+      o << "unknown pass '" << name << "' (available:";
+      for (const auto &p : Passes) o << " " << p.name;
+      o << ").";
+      _message = o.str();
+      return false;
+    }
+
+    _passes.push_back(pass);
+  }
+
+  return true;
+}
+
+string CPassManager::GetPipeline(int level)
+{
+  int max = sizeof(Pipelines)/sizeof(Pipelines[0]) - 1;
+
+  if (level < 0) level = 0;
+  if (level > max) level = max;
+
+  return Pipelines[level];
+}
+
+bool CPassManager::IsPass(const string &name)
+{
+  for (const auto &p : Passes) {
+    if (name == p.name) return true;
+  }
+  return false;
+}
+
+void CPassManager::SetCallback(const function<void(const CPass*)> &after)
+{
+  _after = after;
+}
+
+void CPassManager::Run(CModule *m)
+{
+  assert(m != NULL);
+
+  for (CPass *p : _passes) {
+    {
+      CPhaseTimer timer(p->GetName());
+
+      if (CModulePass *mp = dynamic_cast<CModulePass*>(p)) {
+        if (mp->Run(m, _am)) _am.InvalidateAll(mp->GetPreserved());
+      } else {
+        CFunctionPass *fp = dynamic_cast<CFunctionPass*>(p);
+        assert(fp != NULL);
+        Run(fp, m);
+      }
+    }
+
+    if (_after) _after(p);
+  }
+
+  _am.InvalidateAll();
+}
+
+void CPassManager::Run(CFunctionPass *p, CScope *s)
+{
+  if (p->Run(s, _am)) _am.Invalidate(s, p->GetPreserved());
+
+  for (CScope *c : s->GetSubscopes()) Run(p, c);
+}
+
+string CPassManager::GetErrorMessage(void) const
+{
+  return _message;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CLayoutPass
+//
+bool CLayoutPass::Run(CScope *s, CAnalysisManager &am)
+{
+  // the layout labels all blocks and cleans up the control flow even if it keeps the block
+  // order, so the instruction list is always rewritten
+  CBlockLayout(s, am.GetCFG(s)).Run();
+  return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CPrintAnalysisPass
+//
+CPrintAnalysisPass::CPrintAnalysisPass(EAnalysis analysis, ostream *out)
+  : _analysis(analysis), _out(out)
+{
+}
+
+const char* CPrintAnalysisPass::GetName(void) const
+{
+  switch (_analysis) {
+    case anDominators: return "print-dom";
+    case anLiveness:   return "print-live";
+    default:           return "print-cfg";
+  }
+}
+
+bool CPrintAnalysisPass::Run(CScope *s, CAnalysisManager &am)
+{
+  if (_out == NULL) return false;
+
+  switch (_analysis) {
+    case anDominators: am.GetDominators(s)->print(*_out, 2); break;
+    case anLiveness:   am.GetLiveness(s)->print(*_out, 2); break;
+    default:           am.GetCFG(s)->print(*_out, 2); break;
+  }
+
+  return false;
+}
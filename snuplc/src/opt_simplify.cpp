@@ -0,0 +1,107 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL control flow simplifications
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+
+#include "opt.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CUnreachablePass
+//
+bool CUnreachablePass::Run(CScope *s, CAnalysisManager &am)
+{
+  CControlFlowGraph *cfg = am.GetCFG(s);
+  CDominatorTree *dom = am.GetDominators(s);
+  CCodeBlock *cb = s->GetCodeBlock();
+
+  // blocks without a dominator are unreachable. Branches from reachable blocks never target
+  // them, so their labels can be removed along with them.
+  vector<CTacInstr*> dead;
+  for (CBasicBlock *b : cfg->GetBlocks()) {
+    if (!dom->IsReachable(b)) dead.insert(dead.end(), b->GetInstr().begin(), b->GetInstr().end());
+  }
+
+  if (dead.empty()) return false;
+
+  for (CTacInstr *i : dead) cb->RemoveInstr(i);
+  cb->CleanupControlFlow();
+
+  return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CJumpThreadingPass
+//
+bool CJumpThreadingPass::Run(CScope *s, CAnalysisManager &am)
+{
+  CControlFlowGraph *cfg = am.GetCFG(s);
+  CCodeBlock *cb = s->GetCodeBlock();
+
+  // return the final target of a branch to @a l by following blocks that only consist of a
+  // label and a goto
+  auto forward = [&](CTacLabel *l) {
+    set<const CBasicBlock*> visited;
+    CBasicBlock *b = cfg->GetBlock(l);
+
+    while ((b != NULL) && (b->GetInstr().size() == 2) && (b->GetLabel() != NULL) &&
+           (b->GetTerminator() != NULL) && (b->GetTerminator()->GetOperation() == opGoto) &&
+           visited.insert(b).second) {
+      l = dynamic_cast<CTacLabel*>(b->GetTerminator()->GetDest());
+      b = cfg->GetBlock(l);
+    }
+
+    return l;
+  };
+
+  vector<CTacInstr*> instr, replaced;
+  for (CTacInstr *i : cb->GetInstr()) {
+    CTacLabel *target = i->IsBranch() ? dynamic_cast<CTacLabel*>(i->GetDest()) : NULL;
+    CTacLabel *dest = target != NULL ? forward(target) : NULL;
+
+    if (dest != target) {
+      CTacInstr *n = cb->CreateInstr(i->GetOperation(), dest, i->GetSrc(1), i->GetSrc(2));
+      n->SetProfileId(i->GetProfileId(), i->IsProfileInverted());
+      instr.push_back(n);
+      replaced.push_back(i);
+    } else {
+      instr.push_back(i);
+    }
+  }
+
+  if (replaced.empty()) return false;
+
+  // the goto blocks that are no longer branched to lose their labels and become unreachable
+  for (CTacInstr *i : replaced) cb->RemoveInstr(i);
+  cb->SetInstr(instr);
+  cb->CleanupControlFlow();
+
+  return true;
+}
@@ -62,6 +62,16 @@ using namespace std;
 //   statSequence  =  [ statement { ";" statement } ].
 //   whitespace    =  { " " | \n }+.
 
+/// @brief create the data initializer of a constant symbol from a folded value in @a arena
+static const CDataInitializer* ConstInitializer(CArena *arena, const SConstValue *v)
+{
+  if (v->data != NULL) return v->data;
+  if (v->type->IsBoolean()) return arena->New<CDataInitBoolean>(v->value);
+  if (v->type->IsChar()) return arena->New<CDataInitChar>(v->value);
+  if (v->type->IsInteger()) return arena->New<CDataInitInteger>(v->value);
+  return arena->New<CDataInitLongint>(v->value);
+}
+
 //--------------------------------------------------------------------------------------------------
 // CParser
 //
@@ -69,6 +79,7 @@ CParser::CParser(CScanner *scanner)
 {
   _scanner = scanner;
   _module = NULL;
+  _arena = NULL;
 }
 
 CAstNode* CParser::Parse(void)
@@ -80,8 +91,15 @@ CAstNode* CParser::Parse(void)
   try {
     if (_scanner != NULL) _module = module();
   } catch (...) {
+    // release the symbols that did not make it into a symbol table, then the partially built
+    // module and all its nodes
+    for (CSymbol *s : _pending) {
+      if (s->GetSymbolTable() == NULL) delete s;
+    }
+    delete _module;
     _module = NULL;
   }
+  _pending.clear();
 
   return _module;
 }
@@ -136,13 +154,14 @@ void CParser::InitSymbolTable(CSymtab *st)
   st->AddSymbol(s);
 
   // predefined functions for open arrays
+  // (their parameters are not part of any symbol table and live in the module's arena)
   f = new CSymProc("DIM", tm->GetInteger(), true);
-  f->AddParam(new CSymParam(0, "array", tm->GetPointer(tm->GetNull())));
-  f->AddParam(new CSymParam(1, "dim", tm->GetInteger()));
+  f->AddParam(_arena->New<CSymParam>(0, "array", tm->GetPointer(tm->GetNull())));
+  f->AddParam(_arena->New<CSymParam>(1, "dim", tm->GetInteger()));
   st->AddSymbol(f);
 
   f = new CSymProc("DOFS", tm->GetInteger(), true);
-  f->AddParam(new CSymParam(0, "array", tm->GetPointer(tm->GetNull())));
+  f->AddParam(_arena->New<CSymParam>(0, "array", tm->GetPointer(tm->GetNull())));
   st->AddSymbol(f);
 
   // predefined functions for I/O
@@ -153,19 +172,19 @@ void CParser::InitSymbolTable(CSymtab *st)
   st->AddSymbol(f);
 
   f = new CSymProc("WriteInt", tm->GetNull(), true);
-  f->AddParam(new CSymParam(0, "v", tm->GetInteger()));
+  f->AddParam(_arena->New<CSymParam>(0, "v", tm->GetInteger()));
   st->AddSymbol(f);
 
   f = new CSymProc("WriteLong", tm->GetNull(), true);
-  f->AddParam(new CSymParam(0, "v", tm->GetLongint()));
+  f->AddParam(_arena->New<CSymParam>(0, "v", tm->GetLongint()));
   st->AddSymbol(f);
 
   f = new CSymProc("WriteChar", tm->GetNull(), true);
-  f->AddParam(new CSymParam(0, "v", tm->GetChar()));
+  f->AddParam(_arena->New<CSymParam>(0, "v", tm->GetChar()));
   st->AddSymbol(f);
 
   f = new CSymProc("WriteStr", tm->GetNull(), true);
-  f->AddParam(new CSymParam(0, "v", tm->GetPointer(tm->GetArray(CArrayType::OPEN, tm->GetChar()))));
+  f->AddParam(_arena->New<CSymParam>(0, "v", tm->GetPointer(tm->GetArray(CArrayType::OPEN, tm->GetChar()))));
   st->AddSymbol(f);
 
   f = new CSymProc("WriteLn", tm->GetNull(), true);
@@ -186,6 +205,8 @@ CAstModule* CParser::module(void)
   Consume(tSemicolon);
 
   CAstModule *m = new CAstModule(t, t.GetValue());
+  _module = m;
+  _arena = m->GetArena();
   InitSymbolTable(m->GetSymbolTable());
 
   tt = _scanner->Peek().GetType();
@@ -219,7 +240,7 @@ CAstModule* CParser::module(void)
   Consume(tEnd);
   Consume(tIdent, &t);
 
-  if (t.GetValue() != m->GetName()) {
+  if (t.GetAtom() != m->GetToken().GetAtom()) {
     SetError(t, "mismatched module closing ident.");
   }
 
@@ -243,6 +264,7 @@ void CParser::varDeclarations(CAstScope *s)
     auto decls = varDecl(s);
     for (string ident : decls.first) {
       CSymbol *sym = s->CreateVar(ident, decls.second);
+      _pending.push_back(sym);
       if (!st->AddSymbol(sym)) {
         SetError(t, "variable redeclared.");
         break;
@@ -284,14 +306,16 @@ void CParser::constDeclarations(CAstScope *s)
       break;
     }
 
-    const CDataInitializer *init = expr->Evaluate();
-    if (!init) {
+    const SConstValue *value = expr->Evaluate();
+    if (!value) {
       SetError(t, "cannot evaluate constant expression.");
       break;
     }
+    const CDataInitializer *init = ConstInitializer(_arena, value);
 
     for (string ident : decls.first) {
       CSymbol *sym = s->CreateConst(ident, ct, init);
+      _pending.push_back(sym);
       if (!st->AddSymbol(sym)) {
         SetError(t, "constant redeclared.");
         break;
@@ -352,6 +376,11 @@ CAstProcedure* CParser::subroutineDecl(CAstScope *s)
     return n;
   }
 
+  // Add symbol before parsing body to allow recursive calls
+  if (!st->AddSymbol(n->GetSymbol())) {
+    SetError(t, "subroutine redeclared");
+  }
+
   if (_scanner->Peek().GetType() == tExtern) {
     Consume(tExtern);
     Consume(tSemicolon);
@@ -359,16 +388,11 @@ CAstProcedure* CParser::subroutineDecl(CAstScope *s)
     return n;
   }
 
-  // Add symbol before parsing body to allow recursive calls
-  if (!st->AddSymbol(n->GetSymbol())) {
-    SetError(t, "subroutine redeclared");
-  }
-
   CAstStatement *body = subroutineBody(n);
   n->SetStatementSequence(body);
 
   Consume(tIdent, &t);
-  if (t.GetValue() != n->GetName()) {
+  if (t.GetAtom() != n->GetSymbol()->GetAtom()) {
     SetError(t, "mismatched subroutine closing ident.");
   }
 
@@ -406,14 +430,17 @@ CAstProcedure* CParser::procedureDecl(CAstScope *s)
   Consume(tIdent, &t);
 
   CSymProc *sym = new CSymProc(t.GetValue(), CTypeManager::Get()->GetNull(), false);
-  CAstProcedure *f = new CAstProcedure(t, t.GetValue(), s, sym);
+  _pending.push_back(sym);
+  CAstProcedure *f = _arena->New<CAstProcedure>(t, t.GetValue(), s, sym);
   CSymtab *st = f->GetSymbolTable();
 
   if (_scanner->Peek().GetType() == tLParens) {
     auto params = formalParam(s);
     for (auto *param : params) {
       sym->AddParam(param);
-      st->AddSymbol(param);
+      if (!st->AddSymbol(param)) {
+        SetError(t, "duplicated parameter '" + param->GetName() + "'.");
+      }
     }
   }
 
@@ -441,12 +468,15 @@ CAstProcedure* CParser::functionDecl(CAstScope *s)
   const CType *ty = cctype(s);
 
   CSymProc *sym = new CSymProc(t.GetValue(), ty, false);
-  CAstProcedure *f = new CAstProcedure(t, t.GetValue(), s, sym);
+  _pending.push_back(sym);
+  CAstProcedure *f = _arena->New<CAstProcedure>(t, t.GetValue(), s, sym);
   CSymtab *st = f->GetSymbolTable();
 
   for (auto *param : params) {
     sym->AddParam(param);
-    st->AddSymbol(param);
+    if (!st->AddSymbol(param)) {
+      SetError(t, "duplicated parameter '" + param->GetName() + "'.");
+    }
   }
 
   Consume(tSemicolon);
@@ -478,6 +508,7 @@ vector<CSymParam*> CParser::formalParam(CAstScope *s)
 
     for (string ident : decls.first) {
       params.push_back(new CSymParam(index++, ident, ty));
+      _pending.push_back(params.back());
     }
 
     if (_scanner->Peek().GetType() != tSemicolon) {
@@ -527,7 +558,7 @@ CAstStatement* CParser::statSequence(CAstScope *s)
         if ((ident = dynamic_cast<CAstDesignator*>(expr))) {
           st = assignment(s, ident);
         } else if ((call = dynamic_cast<CAstFunctionCall*>(expr))) {
-          st = new CAstStatCall(t, call);
+          st = _arena->New<CAstStatCall>(t, call);
         } else {
           // Should never happen
           assert(false);
@@ -575,7 +606,7 @@ CAstStatAssign* CParser::assignment(CAstScope *s, CAstDesignator *lhs)
   CToken t;
   Consume(tAssign, &t);
   CAstExpression *rhs = expression(s);
-  return new CAstStatAssign(t, lhs, rhs);
+  return _arena->New<CAstStatAssign>(t, lhs, rhs);
 }
 
 CAstStatIf* CParser::ifStatement(CAstScope *s) {
@@ -600,7 +631,7 @@ CAstStatIf* CParser::ifStatement(CAstScope *s) {
   }
 
   Consume(tEnd);
-  return new CAstStatIf(t, cond, ifBody, elseBody);
+  return _arena->New<CAstStatIf>(t, cond, ifBody, elseBody);
 }
 
 CAstStatWhile* CParser::whileStatement(CAstScope *s)
@@ -619,7 +650,7 @@ CAstStatWhile* CParser::whileStatement(CAstScope *s)
   CAstStatement *body = statSequence(s);
   Consume(tEnd);
 
-  return new CAstStatWhile(t, cond, body);
+  return _arena->New<CAstStatWhile>(t, cond, body);
 }
 
 CAstStatReturn* CParser::returnStatement(CAstScope *s)
@@ -635,9 +666,9 @@ CAstStatReturn* CParser::returnStatement(CAstScope *s)
     case tEnd:
     case tElse:
       // Empty return
-      return new CAstStatReturn(t, s, NULL);
+      return _arena->New<CAstStatReturn>(t, s, (CAstExpression*)NULL);
     default:
-      return new CAstStatReturn(t, s, expression(s));
+      return _arena->New<CAstStatReturn>(t, s, expression(s));
   }
 }
 
@@ -671,7 +702,7 @@ CAstExpression* CParser::expression(CAstScope* s)
     } else {
         SetError(t, "invalid relation.");
     }
-    return new CAstBinaryOp(t, relop, left, right);
+    return _arena->New<CAstBinaryOp>(t, relop, left, right);
   } else {
     return left;
   }
@@ -688,7 +719,7 @@ CAstExpression* CParser::simpleexpr(CAstScope *s)
   if (_scanner->Peek().GetType() == tPlusMinus) {
     Consume(tPlusMinus, &t);
     n = term(s);
-    n = new CAstUnaryOp(t, t.GetValue() == "+" ? opPos : opNeg, n);
+    n = _arena->New<CAstUnaryOp>(t, t.GetValue() == "+" ? opPos : opNeg, n);
   } else {
     n = term(s);
   }
@@ -707,7 +738,7 @@ CAstExpression* CParser::simpleexpr(CAstScope *s)
     }
 
     r = term(s);
-    n = new CAstBinaryOp(t, termop, l, r);
+    n = _arena->New<CAstBinaryOp>(t, termop, l, r);
     tt = _scanner->Peek().GetType();
   }
 
@@ -736,7 +767,7 @@ CAstExpression* CParser::term(CAstScope *s)
     }
 
     r = factor(s);
-    n = new CAstBinaryOp(t, factop, l, r);
+    n = _arena->New<CAstBinaryOp>(t, factop, l, r);
     tt = _scanner->Peek().GetType();
   }
 
@@ -778,7 +809,7 @@ CAstExpression* CParser::factor(CAstScope *s)
     case tNot:
       Consume(tNot, &t);
       n = factor(s);
-      n = new CAstUnaryOp(t, opNot, n);
+      n = _arena->New<CAstUnaryOp>(t, opNot, n);
       break;
 
     // factor ::= qualident | subroutineCall
@@ -805,7 +836,7 @@ CAstExpression* CParser::identOrCall(CAstScope *s)
 
   EToken tt = _scanner->Peek().GetType();
   if (tt == tLBrak) {
-    CAstArrayDesignator *nn = new CAstArrayDesignator(_scanner->Peek(), n->GetSymbol());
+    CAstArrayDesignator *nn = _arena->New<CAstArrayDesignator>(_scanner->Peek(), n->GetSymbol());
     while (tt == tLBrak) {
       Consume(tLBrak);
       nn->AddIndex(simpleexpr(s));
@@ -823,7 +854,7 @@ CAstExpression* CParser::identOrCall(CAstScope *s)
       SetError(t, "not a procedure.");
       return NULL;
     }
-    CAstFunctionCall *nn = new CAstFunctionCall(t, sym);
+    CAstFunctionCall *nn = _arena->New<CAstFunctionCall>(t, sym);
 
     if (_scanner->Peek().GetType() == tRParens) {
       Consume(tRParens);
@@ -831,7 +862,13 @@ CAstExpression* CParser::identOrCall(CAstScope *s)
     }
 
     while (true) {
-      nn->AddArg(expression(s));
+      CAstExpression *arg = expression(s);
+
+      // pass arrays as pointers
+      if (arg->GetType()->IsArray())
+        arg = _arena->New<CAstSpecialOp>(arg->GetToken(), opAddress, arg);
+
+      nn->AddArg(arg);
       switch (_scanner->Peek().GetType()) {
         case tRParens:
           Consume(tRParens);
@@ -858,12 +895,12 @@ CAstDesignator* CParser::ident(CAstScope *s)
 
   Consume(tIdent, &t);
 
-  const CSymbol *sym = st->FindSymbol(t.GetValue(), sGlobal);
+  const CSymbol *sym = st->FindSymbol(t.GetAtom(), sGlobal);
   if (sym == NULL) {
     SetError(t, "undeclared identifier");
   }
 
-  return new CAstDesignator(t, sym);
+  return _arena->New<CAstDesignator>(t, sym);
 }
 
 CAstConstant* CParser::boolConst(void)
@@ -873,22 +910,22 @@ CAstConstant* CParser::boolConst(void)
   Consume(tBoolConst, &t);
 
   if (t.GetValue() == "true") {
-    return new CAstConstant(t, CTypeManager::Get()->GetBool(), true);
+    return _arena->New<CAstConstant>(t, CTypeManager::Get()->GetBool(), true);
   } else {
-    return new CAstConstant(t, CTypeManager::Get()->GetBool(), false);
+    return _arena->New<CAstConstant>(t, CTypeManager::Get()->GetBool(), false);
   }
 }
 
 CAstConstant* CParser::charConst(void) {
   CToken t;
   Consume(tCharConst, &t);
-  return new CAstConstant(t, CTypeManager::Get()->GetChar(), t.unescape(t.GetValue()).front());
+  return _arena->New<CAstConstant>(t, CTypeManager::Get()->GetChar(), t.unescape(t.GetValue()).front());
 }
 
 CAstStringConstant* CParser::stringConst(CAstScope *s) {
   CToken t;
   Consume(tStringConst, &t);
-  return new CAstStringConstant(t, t.unescape(t.GetValue()), s);
+  return _arena->New<CAstStringConstant>(t, t.unescape(t.GetValue()), s);
 }
 
 CAstConstant* CParser::number(void)
@@ -908,7 +945,7 @@ CAstConstant* CParser::number(void)
     if (v < LONG_MIN || v > LONG_MAX)
       SetError(t, "longint out of range.");
 
-    return new CAstConstant(t, CTypeManager::Get()->GetLongint(), v);
+    return _arena->New<CAstConstant>(t, CTypeManager::Get()->GetLongint(), v);
   } else {
     errno = 0;
     long long v = strtoll(s.c_str(), NULL, 10);
@@ -918,7 +955,7 @@ CAstConstant* CParser::number(void)
     if (v < INT_MIN || v > INT_MAX)
       SetError(t, "int out of range.");
 
-    return new CAstConstant(t, CTypeManager::Get()->GetInteger(), v);
+    return _arena->New<CAstConstant>(t, CTypeManager::Get()->GetInteger(), v);
   }
 }
 
@@ -974,17 +1011,12 @@ const CType* CParser::arrayIndex(CAstScope *s, const CType *type)
         break;
       }
 
-      const CDataInitializer *init = expr->Evaluate();
-      if (!init) {
+      const SConstValue *value = expr->Evaluate();
+      if (!value) {
         SetError(t, "expected constant array size.");
         break;
       }
-
-      if (expr->GetType()->IsInteger()) {
-        nelem = ((const CDataInitInteger *) init)->GetData();
-      } else {
-        nelem = ((const CDataInitLongint *) init)->GetData();
-      }
+      nelem = value->value;
 
       if (nelem < 0) {
         SetError(t, "expected non-negative array size.");
@@ -219,6 +219,9 @@ class CParser {
 
     CScanner     *_scanner;       ///< CScanner instance
     CAstModule   *_module;        ///< root node of the program
+    CArena       *_arena;         ///< arena of the module being parsed
+    vector<CSymbol*> _pending;    ///< symbols created during parsing; those that have not been
+                                  ///< added to a symbol table are released on errors
     CToken        _token;         ///< current token
 
     /// @name error handling
@@ -0,0 +1,193 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL execution profiles
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cassert>
+#include <fstream>
+#include <sstream>
+
+#include "profile.h"
+#include "sha256.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// CProfile
+//
+CProfile::CProfile(void)
+{
+}
+
+CProfile::~CProfile(void)
+{
+}
+
+bool CProfile::Load(const string file)
+{
+  ifstream in(file);
+
+  if (!in.good()) {
+    _message = "cannot open profile '" + file + "'.";
+    return false;
+  }
+
+  return Load(in, file);
+}
+
+bool CProfile::Load(istream &in, const string name)
+{
+  string line;
+  int lineno = 0;
+  while (getline(in, line)) {
+    lineno++;
+    if ((line == "") || (line[0] == '#')) continue;
+
+    istringstream l(line);
+    unsigned long long count;
+    string key;
+
+    if (!(l >> count >> key)) {
+      _message = name + ":" + to_string(lineno) + ": malformed profile entry.";
+      return false;
+    }
+
+    _count[key] += count;
+  }
+
+  return true;
+}
+
+string CProfile::GetErrorMessage(void) const
+{
+  return _message;
+}
+
+unsigned long long CProfile::GetCount(const string key) const
+{
+  auto it = _count.find(key);
+  return it != _count.end() ? it->second : 0;
+}
+
+unsigned long long CProfile::GetEntryCount(const CScope *scope) const
+{
+  return GetCount(EntryKey(scope));
+}
+
+unsigned long long CProfile::GetLabelCount(const CScope *scope, const CTacLabel *label) const
+{
+  return GetCount(LabelKey(scope, label));
+}
+
+bool CProfile::GetBranchCounts(const CScope *scope, const CTacInstr *instr,
+                               unsigned long long &taken, unsigned long long &fallthrough) const
+{
+  taken = fallthrough = 0;
+
+  int pid = instr->GetProfileId();
+  if (pid < 0) return false;
+
+  auto t = _count.find(BranchKey(scope, pid, true));
+  auto f = _count.find(BranchKey(scope, pid, false));
+  if ((t == _count.end()) || (f == _count.end())) return false;
+
+  taken = t->second;
+  fallthrough = f->second;
+  if (instr->IsProfileInverted()) swap(taken, fallthrough);
+
+  return true;
+}
+
+bool CProfile::HasScope(const CScope *scope) const
+{
+  // all counters of a scope are recorded together, including the entry count
+  return _count.find(EntryKey(scope)) != _count.end();
+}
+
+bool CProfile::Matches(const CScope *scope, const string sig) const
+{
+  return _count.find(SignatureKey(scope, sig)) != _count.end();
+}
+
+string CProfile::Signature(const CScope *scope, const string pipeline)
+{
+  assert(scope != NULL);
+
+  ostringstream code;
+  scope->GetCodeBlock()->print(code);
+
+  CSHA256 h;
+  h.Update(pipeline);
+  h.Update(code.str());
+  return h.GetDigest().substr(0, 16);
+}
+
+string CProfile::EntryKey(const CScope *scope)
+{
+  assert(scope != NULL);
+  return scope->GetName();
+}
+
+string CProfile::LabelKey(const CScope *scope, const CTacLabel *label)
+{
+  assert((scope != NULL) && (label != NULL));
+  return scope->GetName() + ":" + label->GetLabel();
+}
+
+string CProfile::BranchKey(const CScope *scope, int pid, bool taken)
+{
+  assert(scope != NULL);
+  return scope->GetName() + ":#" + to_string(pid) + (taken ? ":t" : ":f");
+}
+
+string CProfile::SignatureKey(const CScope *scope, const string sig)
+{
+  assert(scope != NULL);
+  return scope->GetName() + ":@" + sig;
+}
+
+ostream& CProfile::print(ostream &out, int indent) const
+{
+  string ind(indent, ' ');
+
+  out << ind << "[[ profile" << endl;
+  for (const auto &c : _count) {
+    out << ind << "  " << c.second << " " << c.first << endl;
+  }
+  out << ind << "]]" << endl;
+
+  return out;
+}
+
+ostream& operator<<(ostream &out, const CProfile &p)
+{
+  return p.print(out);
+}
+
+ostream& operator<<(ostream &out, const CProfile *p)
+{
+  return p->print(out);
+}
@@ -0,0 +1,165 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL execution profiles
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_PROFILE_H__
+#define __SnuPL_PROFILE_H__
+
+#include <iostream>
+#include <map>
+
+#include "ir.h"
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief execution profile
+///
+/// An execution profile holds the counters written by an instrumented executable (compiled
+/// with --instrument) at program exit. Counters are identified by textual keys:
+///
+///   <scope>                 number of invocations of scope
+///   <scope>:<label>         number of times the label (basic block) was entered
+///   <scope>:#<pid>:t|f      number of times conditional branch <pid> was taken/fell through
+///   <scope>:@<signature>    signature of the profiled code of scope (always 0, see Signature())
+///
+/// The profile file contains one counter per line in the form '<count> <key>'; lines starting
+/// with '#' are comments.
+///
+class CProfile {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    CProfile(void);
+    virtual ~CProfile(void);
+
+    /// @}
+
+
+    /// @name loading
+    /// @{
+
+    /// @brief load (and accumulate) counters from @a file
+    /// @param file profile file
+    /// @retval true on success
+    /// @retval false if the file could not be read or is malformed
+    bool Load(const string file);
+
+    /// @brief load (and accumulate) counters from the stream @a in
+    /// @param in input stream
+    /// @param name name of the profile in error messages
+    /// @retval true on success
+    /// @retval false if the profile is malformed
+    bool Load(istream &in, const string name);
+
+    /// @brief return a human-readable error message of the last failed Load()
+    string GetErrorMessage(void) const;
+
+    /// @}
+
+
+    /// @name counter queries
+    /// @{
+
+    /// @brief return the counter for @a key or 0 if not recorded
+    unsigned long long GetCount(const string key) const;
+
+    /// @brief return the number of invocations of @a scope
+    unsigned long long GetEntryCount(const CScope *scope) const;
+
+    /// @brief return the number of times @a label in @a scope was entered
+    unsigned long long GetLabelCount(const CScope *scope, const CTacLabel *label) const;
+
+    /// @brief return the taken/fall-through counts of conditional branch @a instr
+    ///
+    /// The counts refer to the current condition of @a instr, i.e., they are swapped if the
+    /// branch has been inverted after profiling.
+    /// @retval true if @a instr has profile information
+    /// @retval false otherwise (@a taken and @a fallthrough are set to 0)
+    bool GetBranchCounts(const CScope *scope, const CTacInstr *instr,
+                         unsigned long long &taken, unsigned long long &fallthrough) const;
+
+    /// @brief return true if the profile contains counters of @a scope
+    bool HasScope(const CScope *scope) const;
+
+    /// @brief return true if the counters of @a scope were recorded for code with signature @a sig
+    bool Matches(const CScope *scope, const string sig) const;
+
+    /// @}
+
+
+    /// @brief return the signature of the code of @a scope when optimized by @a pipeline
+    ///
+    /// The label names, and thus the counter keys, depend on the code before optimization and
+    /// on the optimization passes. The signature is a hash of both; an instrumented executable
+    /// records it for each scope, and a compilation using the profile ignores the counters of
+    /// scopes whose signature differs.
+    static string Signature(const CScope *scope, const string pipeline);
+
+
+    /// @name counter keys
+    /// @{
+
+    static string EntryKey(const CScope *scope);
+    static string LabelKey(const CScope *scope, const CTacLabel *label);
+    static string BranchKey(const CScope *scope, int pid, bool taken);
+    static string SignatureKey(const CScope *scope, const string sig);
+
+    /// @}
+
+
+    /// @brief print the profile to an output stream
+    /// @param out output stream
+    /// @param indent indentation
+    virtual ostream& print(ostream &out, int indent=0) const;
+
+  private:
+    map<string, unsigned long long> _count; ///< counters
+    string _message;                         ///< error message
+};
+
+/// @name CProfile output operators
+/// @{
+
+/// @brief CProfile output operator
+///
+/// @param out output stream
+/// @param p reference to CProfile
+/// @retval output stream
+ostream& operator<<(ostream &out, const CProfile &p);
+
+/// @brief CProfile output operator
+///
+/// @param out output stream
+/// @param p reference to CProfile
+/// @retval output stream
+ostream& operator<<(ostream &out, const CProfile *p);
+
+/// @}
+
+
+#endif // __SnuPL_PROFILE_H__
@@ -42,8 +42,22 @@
 #include <cstring>
 #include <cassert>
 #include <cstdio>
+#include <algorithm>
+#include <iterator>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 #include "scanner.h"
+#include "timer.h"
 using namespace std;
 
 //--------------------------------------------------------------------------------------------------
@@ -162,67 +176,259 @@ char ETokenStr[][TOKEN_STRLEN] = {
 //--------------------------------------------------------------------------------------------------
 // reserved keywords
 //
-pair<const char*, EToken> Keywords[] =
-{
-    {"module", tModule},
-    {"procedure", tProcedure},
-    {"function", tFunction},
-    {"extern", tExtern},
-    {"begin", tBegin},
-    {"end", tEnd},
-    {"if", tIf},
-    {"then", tThen},
-    {"else", tElse},
-    {"while", tWhile},
-    {"do", tDo},
-    {"return", tReturn},
-    {"var", tVarDecl},
-    {"const", tConstDecl},
-    {"boolean", tBoolean},
-    {"char", tChar},
-    {"integer", tInteger},
-    {"longint", tLongint},
-    {"true", tBoolConst},
-    {"false", tBoolConst},
-
-    //"void", // not actually a keyword allowed by the spec
+// Keywords are recognized with a perfect hash on the length and the first and last character of
+// an identifier; each keyword occupies its own slot in KeywordTable. When adding a keyword, choose
+// new factors for KeywordHash() such that all keywords map to distinct slots (the static_assert
+// below verifies the table at compile time).
+//
+// "void" is not actually a keyword allowed by the spec.
+//
+struct SKeyword {
+  const char *name;                 ///< keyword (NULL for empty slots)
+  size_t len;                       ///< length of keyword
+  EToken token;                     ///< corresponding token
 };
 
+#define KEYWORD_SLOTS 32
+
+/// @brief perfect hash for the keywords in KeywordTable
+constexpr unsigned int KeywordHash(const char *s, size_t len)
+{
+  return ((unsigned char)s[0]*2 + (unsigned char)s[len-1]*30 + len) % KEYWORD_SLOTS;
+}
+
+constexpr SKeyword KeywordTable[KEYWORD_SLOTS] = {
+  {NULL,        0, tIdent},             //  0
+  {NULL,        0, tIdent},             //  1
+  {"true",      4, tBoolConst},         //  2
+  {"const",     5, tConstDecl},         //  3
+  {"else",      4, tElse},              //  4
+  {"end",       3, tEnd},               //  5
+  {"char",      4, tChar},              //  6
+  {"false",     5, tBoolConst},         //  7
+  {"if",        2, tIf},                //  8
+  {"while",     5, tWhile},             //  9
+  {NULL,        0, tIdent},             // 10
+  {"var",       3, tVarDecl},           // 11
+  {"do",        2, tDo},                // 12
+  {"begin",     5, tBegin},             // 13
+  {"return",    6, tReturn},            // 14
+  {"boolean",   7, tBoolean},           // 15
+  {"then",      4, tThen},              // 16
+  {NULL,        0, tIdent},             // 17
+  {NULL,        0, tIdent},             // 18
+  {NULL,        0, tIdent},             // 19
+  {"extern",    6, tExtern},            // 20
+  {"integer",   7, tInteger},           // 21
+  {"module",    6, tModule},            // 22
+  {"longint",   7, tLongint},           // 23
+  {"function",  8, tFunction},          // 24
+  {NULL,        0, tIdent},             // 25
+  {NULL,        0, tIdent},             // 26
+  {NULL,        0, tIdent},             // 27
+  {NULL,        0, tIdent},             // 28
+  {NULL,        0, tIdent},             // 29
+  {NULL,        0, tIdent},             // 30
+  {"procedure", 9, tProcedure},         // 31
+};
+
+/// @brief check that the keywords in slots @a i and above hash to their slot
+constexpr bool KeywordTableValid(unsigned int i)
+{
+  return (i == KEYWORD_SLOTS) ||
+         (((KeywordTable[i].name == NULL) ||
+           (KeywordHash(KeywordTable[i].name, KeywordTable[i].len) == i)) &&
+          KeywordTableValid(i+1));
+}
+
+static_assert(KeywordTableValid(0), "keyword table does not match KeywordHash()");
+
+
+//--------------------------------------------------------------------------------------------------
+// character class scanning
+//
+// CScanner::SkipWhite(), SkipDigits() and SkipIDChars() return the first character in [p, end)
+// that does not belong to the respective character class. With SSE2 (always available on x86-64)
+// or AVX2 (when compiled with -mavx2), 16 or 32 characters are classified at once; the remainder
+// of the buffer is scanned one character at a time. Vector loads never reach beyond @a end.
+// Comments are skipped with memchr(), which the C library already vectorizes.
+//
+// Character classes are built from signed byte comparisons; bytes >= 0x80 compare as negative
+// and thus never fall into a range of printable ASCII characters.
+//
+#if defined(__AVX2__)
+typedef __m256i VChar;
+#define VWIDTH         32
+#define VLoad(p)       _mm256_loadu_si256((const __m256i*)(p))
+#define VSet(c)        _mm256_set1_epi8(c)
+#define VEq(a, b)      _mm256_cmpeq_epi8(a, b)
+#define VGt(a, b)      _mm256_cmpgt_epi8(a, b)
+#define VAnd(a, b)     _mm256_and_si256(a, b)
+#define VOr(a, b)      _mm256_or_si256(a, b)
+#define VMask(a)       ((uint32_t)_mm256_movemask_epi8(a))
+#define VFULL          0xffffffffU
+#elif defined(__SSE2__)
+typedef __m128i VChar;
+#define VWIDTH         16
+#define VLoad(p)       _mm_loadu_si128((const __m128i*)(p))
+#define VSet(c)        _mm_set1_epi8(c)
+#define VEq(a, b)      _mm_cmpeq_epi8(a, b)
+#define VGt(a, b)      _mm_cmpgt_epi8(a, b)
+#define VAnd(a, b)     _mm_and_si128(a, b)
+#define VOr(a, b)      _mm_or_si128(a, b)
+#define VMask(a)       ((uint32_t)_mm_movemask_epi8(a))
+#define VFULL          0xffffU
+#endif
+
+#ifdef VWIDTH
+/// @brief lanes of @a v that lie in the character range [lo, hi]
+static inline VChar VRange(VChar v, char lo, char hi)
+{
+  return VAnd(VGt(v, VSet(lo-1)), VGt(VSet(hi+1), v));
+}
+
+/// @brief lanes of @a v that are white space (see CScanner::IsWhite())
+static inline VChar VWhite(VChar v)
+{
+  return VOr(VOr(VEq(v, VSet(' ')), VEq(v, VSet('\t'))), VEq(v, VSet('\n')));
+}
+
+/// @brief lanes of @a v that are digits (see CScanner::IsNum())
+static inline VChar VDigit(VChar v)
+{
+  return VRange(v, '0', '9');
+}
+
+/// @brief lanes of @a v that are ID characters (see CScanner::IsIDChar())
+static inline VChar VIDChar(VChar v)
+{
+  // folding to lower case maps [A-Z] onto [a-z] and no other character onto [a-z]
+  return VOr(VOr(VRange(VOr(v, VSet(0x20)), 'a', 'z'), VDigit(v)), VEq(v, VSet('_')));
+}
+
+/// @brief skip vectors whose characters all satisfy the class @a Class
+/// @retval position of the first character not in the class, or the start of the tail that is
+///         shorter than one vector
+template <VChar (*Class)(VChar)>
+static inline const char* VSkip(const char *p, const char *end)
+{
+  while (end - p >= VWIDTH) {
+    uint32_t mask = VMask(Class(VLoad(p)));
+    if (mask != VFULL) return p + __builtin_ctz(~mask);
+    p += VWIDTH;
+  }
+  return p;
+}
+#endif
+
+
+//--------------------------------------------------------------------------------------------------
+// CSourceBuffer
+//
+CSourceBuffer::CSourceBuffer(const string filename)
+  : _data(""), _size(0), _good(false), _map(NULL)
+{
+  int fd = open(filename.c_str(), O_RDONLY);
+  if (fd < 0) return;
+
+  struct stat st;
+  if ((fstat(fd, &st) == 0) && S_ISREG(st.st_mode)) {
+    _good = true;
+    if (st.st_size > 0) {
+      void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (map != MAP_FAILED) {
+        _map = map;
+        _data = (const char*)map;
+        _size = st.st_size;
+      } else {
+        _good = false;
+      }
+    }
+  }
+
+  close(fd);
+}
+
+CSourceBuffer::CSourceBuffer(istream *in)
+  : _data(""), _size(0), _good(in->good()), _map(NULL)
+{
+  if (_good) {
+    _copy.assign(istreambuf_iterator<char>(*in), istreambuf_iterator<char>());
+    _data = _copy.data();
+    _size = _copy.size();
+  }
+}
+
+CSourceBuffer::CSourceBuffer(const char *data, size_t size, bool copy)
+  : _data(data), _size(size), _good(true), _map(NULL)
+{
+  if (copy) {
+    _copy.assign(data, size);
+    _data = _copy.data();
+  }
+}
+
+CSourceBuffer::~CSourceBuffer()
+{
+  if (_map != NULL) munmap(_map, _size);
+}
+
+void CSourceBuffer::GetPosition(size_t offset, int *line, int *charpos) const
+{
+  if (_lines.empty()) {
+    _lines.push_back(0);
+    const char *p = _data, *end = _data + _size;
+    while ((p = (const char*)memchr(p, '\n', end-p)) != NULL) _lines.push_back(++p - _data);
+  }
+
+  // the line starting last at or before offset
+  size_t l = upper_bound(_lines.begin(), _lines.end(), offset) - _lines.begin();
+  *line = l;
+  *charpos = offset - _lines[l-1] + 1;
+}
 
 
 //--------------------------------------------------------------------------------------------------
 // CToken
 //
 CToken::CToken()
+  : _type(tUndefined), _atom(0), _offset(0), _src(NULL)
 {
-  _type = tUndefined;
-  _value = "";
-  _line = _char = 0;
 }
 
-CToken::CToken(int line, int charpos, EToken type, const string value)
+CToken::CToken(EToken type, const string value)
+  : _type(type), _offset(0), _src(NULL)
 {
-  _type = type;
-  if ((type==tStringConst) || (type==tCharConst)) _value = escape(type, value);
-  else _value = value;
-  _line = line;
-  _char = charpos;
+  if ((type==tStringConst) || (type==tCharConst)) _atom = CAtomTable::Get()->Intern(escape(type, value));
+  else _atom = CAtomTable::Get()->Intern(value);
 }
 
-CToken::CToken(const CToken &token)
+CToken::CToken(EToken type, TAtom atom, const CSourceBuffer *src, size_t offset)
+  : _type(type), _atom(atom), _offset(offset), _src(src)
 {
-  _type = token.GetType();
-  _value = token.GetValue();
-  _line = token.GetLineNumber();
-  _char = token.GetCharPosition();
 }
 
 CToken::CToken(const CToken *token)
+  : CToken(*token)
+{
+}
+
+int CToken::GetLineNumber(void) const
+{
+  if (_src == NULL) return 0;
+
+  int line, charpos;
+  _src->GetPosition(_offset, &line, &charpos);
+  return line;
+}
+
+int CToken::GetCharPosition(void) const
 {
-  _type = token->GetType();
-  _value = token->GetValue();
-  _line = token->GetLineNumber();
-  _char = token->GetCharPosition();
+  if (_src == NULL) return 0;
+
+  int line, charpos;
+  _src->GetPosition(_offset, &line, &charpos);
+  return charpos;
 }
 
 const string CToken::Name(EToken type)
@@ -238,11 +444,12 @@ const string CToken::GetName(void) const
 ostream& CToken::print(ostream &out) const
 {
   #define MAX_STRLEN 128
-  int str_len = _value.length();
+  const string &value = GetValue();
+  int str_len = value.length();
   str_len = TOKEN_STRLEN + (str_len < MAX_STRLEN ? str_len : MAX_STRLEN);
   char *str = (char*)malloc(str_len);
-  snprintf(str, str_len, ETokenStr[GetType()], _value.c_str());
-  out << dec << _line << ":" << _char << ": " << str;
+  snprintf(str, str_len, ETokenStr[GetType()], value.c_str());
+  out << dec << GetLineNumber() << ":" << GetCharPosition() << ": " << str;
   free(str);
   return out;
 }
@@ -336,51 +543,45 @@ ostream& operator<<(ostream &out, const CToken *t)
 //--------------------------------------------------------------------------------------------------
 // CScanner
 //
-map<string, EToken> CScanner::keywords;
-
 CScanner::CScanner(istream *in)
 {
-  InitKeywords();
-  _in = in;
-  _delete_in = false;
-  _line = _char = 1;
-  _token = NULL;
-  _good = in->good();
-  NextToken();
+  _src = new CSourceBuffer(in);
+  _delete_src = true;
+  Init();
 }
 
 CScanner::CScanner(string in)
 {
-  InitKeywords();
-  _in = new istringstream(in);
-  _delete_in = true;
-  _line = _char = 1;
-  _token = NULL;
-  _good = true;
-  NextToken();
+  _src = new CSourceBuffer(in.data(), in.size());
+  _delete_src = true;
+  Init();
+}
+
+CScanner::CScanner(CSourceBuffer *src)
+{
+  _src = src;
+  _delete_src = false;
+  Init();
 }
 
 CScanner::~CScanner()
 {
-  if (_token != NULL) delete _token;
-  if (_delete_in) delete _in;
+  if (_delete_src) delete _src;
 }
 
-void CScanner::InitKeywords(void)
+void CScanner::Init(void)
 {
-  if (keywords.size() == 0) {
-    int size = sizeof(Keywords) / sizeof(Keywords[0]);
-    for (int i=0; i<size; i++) {
-      keywords[Keywords[i].first] = Keywords[i].second;
-    }
-  }
+  _pos = _saved = _src->GetData();
+  _end = _pos + _src->GetSize();
+  _good = _src->Good();
+  NextToken();
 }
 
 CToken CScanner::Get()
 {
-  CToken result(_token);
+  CToken result = _token;
 
-  EToken type = _token->GetType();
+  EToken type = _token.GetType();
   _good = !(type == tIOError);
 
   NextToken();
@@ -389,54 +590,82 @@ CToken CScanner::Get()
 
 CToken CScanner::Peek() const
 {
-  return CToken(_token);
+  return _token;
 }
 
 void CScanner::NextToken()
 {
-  if (_token != NULL) delete _token;
-
+  CPhaseTimer timer("scan", true);
   _token = Scan();
 }
 
+int CScanner::GetLineNumber(void) const
+{
+  int line, charpos;
+  _src->GetPosition(_pos - _src->GetData(), &line, &charpos);
+  return line;
+}
+
+int CScanner::GetCharPosition(void) const
+{
+  int line, charpos;
+  _src->GetPosition(_pos - _src->GetData(), &line, &charpos);
+  return charpos;
+}
+
 void CScanner::RecordStreamPosition(void)
 {
-  _saved_line = _line;
-  _saved_char = _char;
+  _saved = _pos;
 }
 
 void CScanner::GetRecordedStreamPosition(int *lineno, int *charpos)
 {
-  *lineno = _saved_line;
-  *charpos = _saved_char;
+  _src->GetPosition(_saved - _src->GetData(), lineno, charpos);
 }
 
-CToken* CScanner::NewToken(EToken type, const string token)
+CToken CScanner::NewToken(EToken type, const string token)
 {
-  return new CToken(_saved_line, _saved_char, type, token);
+  CToken t(type, token);
+  t._src = _src;
+  t._offset = _saved - _src->GetData();
+  return t;
 }
 
-CToken* CScanner::Scan()
+CToken CScanner::NewToken(EToken type, const char *start, const char *end)
+{
+  return CToken(type, CAtomTable::Get()->Intern(start, end - start), _src, _saved - _src->GetData());
+}
+
+CToken CScanner::Scan()
 {
   EToken token;
   string tokval;
+  const char *start;
   char c;
 
+  if (!_src->Good()) {
+    RecordStreamPosition();
+    return NewToken(tIOError, string());
+  }
+
 again:
-  while (_in->good() && IsWhite(PeekChar())) GetChar();
+  _pos = SkipWhite(_pos, _end);
 
   RecordStreamPosition();
 
-  if (_in->eof()) return NewToken(tEOF);
-  if (!_in->good()) return NewToken(tIOError);
+  if (AtEnd()) return NewToken(tEOF, string());
 
+  // the value of most tokens is the lexeme in the source buffer;
+  // character and string constants are unescaped into tokval
+  start = _pos;
   c = GetChar();
   tokval = c;
   token = tUndefined;
 
   // Skip over comments, restart scan afterwards
   if (c == '/' && PeekChar() == '/') {
-    while (_in->good() && GetChar() != '\n');
+    const char *eol = (const char*)memchr(_pos, '\n', _end - _pos);
+    _pos = eol != NULL ? eol + 1 : _end;
     goto again;
   }
 
@@ -552,27 +781,27 @@ again:
     default:
       if (IsNum(c)) {
         token = tNumber;
-        while (IsNum(PeekChar()))
-          tokval += GetChar();
+        _pos = SkipDigits(_pos, _end);
         if (PeekChar() == 'L') // longints
-          tokval += GetChar();
+          GetChar();
         break;
       }
 
       if (IsAlpha(c)) {
         token = tIdent;
-        while (IsIDChar(PeekChar()))
-          tokval += GetChar();
-        for (const auto& e : keywords)
-          if (tokval == e.first)
-            token = e.second;
+        _pos = SkipIDChars(_pos, _end);
+
+        size_t len = _pos - start;
+        const SKeyword &k = KeywordTable[KeywordHash(start, len)];
+        if ((k.len == len) && (memcmp(k.name, start, len) == 0)) token = k.token;
         break;
       }
 
       break;
   }
 
-  return NewToken(token, tokval);
+  if ((*start == '\'') || (*start == '"')) return NewToken(token, tokval);
+  return NewToken(token, start, _pos);
 }
 
 CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
@@ -597,7 +826,7 @@ CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
 
   if (c == '\\') {
     // escaped character
-    if (_in->eof() || !_in->good()) return cUnexpEnd;
+    if (AtEnd()) return cUnexpEnd;
     c = GetChar();
 
     switch (PeekChar()) {
@@ -612,7 +841,7 @@ CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
 
       case 'x':  // \xHH encoding: read exactly two hexadecimal digits
                  for (i=v=0; i<2; i++) {
-                   if (_in->eof() || !_in->good()) return cUnexpEnd;
+                   if (AtEnd()) return cUnexpEnd;
                    GetChar();
                    if ((t = CToken::digitValue(PeekChar())) == -1) break;
                    v = (v << 4) + t;
@@ -634,7 +863,7 @@ CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
   if (res != cOkay) RecordStreamPosition();
 
   // consume character (we only peeked at it so far)
-  if (_in->eof() || !_in->good()) return cUnexpEnd;
+  if (AtEnd()) return cUnexpEnd;
   GetChar();
 
   return res;
@@ -642,14 +871,12 @@ CScanner::ECharacter CScanner::GetCharacter(unsigned char &c, EToken mode)
 
 unsigned char CScanner::PeekChar()
 {
-  return (unsigned char)_in->peek();
+  return _pos < _end ? (unsigned char)*_pos : 0xff;
 }
 
 unsigned char CScanner::GetChar()
 {
-  unsigned char c = _in->get();
-  if (c == '\n') { _line++; _char = 1; } else _char++;
-  return c;
+  return _pos < _end ? (unsigned char)*_pos++ : 0xff;
 }
 
 string CScanner::GetChar(int n)
@@ -686,3 +913,30 @@ bool CScanner::IsIDChar(unsigned char c)
   return (IsAlpha(c) || IsNum(c));
 }
 
+const char* CScanner::SkipWhite(const char *p, const char *end)
+{
+#ifdef VWIDTH
+  p = VSkip<VWhite>(p, end);
+#endif
+  while ((p < end) && IsWhite(*p)) p++;
+  return p;
+}
+
+const char* CScanner::SkipDigits(const char *p, const char *end)
+{
+#ifdef VWIDTH
+  p = VSkip<VDigit>(p, end);
+#endif
+  while ((p < end) && IsNum(*p)) p++;
+  return p;
+}
+
+const char* CScanner::SkipIDChars(const char *p, const char *end)
+{
+#ifdef VWIDTH
+  p = VSkip<VIDChar>(p, end);
+#endif
+  while ((p < end) && IsIDChar(*p)) p++;
+  return p;
+}
+
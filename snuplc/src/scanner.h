@@ -42,7 +42,11 @@
 #include <ostream>
 #include <iomanip>
 #include <map>
+#include <string>
+#include <vector>
+#include <type_traits>
 
+#include "atom.h"
 using namespace std;
 
 //--------------------------------------------------------------------------------------------------
@@ -102,6 +106,69 @@ enum EToken {
 };
 
 
+//--------------------------------------------------------------------------------------------------
+/// @brief source buffer
+///
+/// Holds the source code of a module in a contiguous buffer. The buffer is either a memory-mapped
+/// file, a copy of a stream or string, or borrowed from the caller. Line/column positions are not
+/// tracked while scanning; they are computed from a line-start index that is built the first time
+/// a position is requested.
+///
+class CSourceBuffer {
+  public:
+    /// @name construction/destruction
+    /// @{
+
+    /// @brief constructor mapping a file into memory
+    ///
+    /// @param filename name of the source file
+    CSourceBuffer(const string filename);
+
+    /// @brief constructor reading a stream to its end
+    ///
+    /// @param in input stream containing the source code
+    CSourceBuffer(istream *in);
+
+    /// @brief constructor for a contiguous buffer
+    ///
+    /// @param data source code
+    /// @param size size of @a data in bytes
+    /// @param copy copy the data (otherwise @a data must outlive the buffer)
+    CSourceBuffer(const char *data, size_t size, bool copy=true);
+
+    /// @brief destructor
+    ~CSourceBuffer();
+
+    /// @}
+
+    /// @brief check the status of the buffer
+    ///
+    /// @retval true if the source could be read
+    bool Good(void) const { return _good; };
+
+    /// @brief return the start of the buffer
+    const char* GetData(void) const { return _data; };
+
+    /// @brief return the size of the buffer in bytes
+    size_t GetSize(void) const { return _size; };
+
+    /// @brief compute the position of a byte in the buffer
+    ///
+    /// @param offset offset of the byte
+    /// @param line [out] line number (1-based)
+    /// @param charpos [out] character position (1-based)
+    void GetPosition(size_t offset, int *line, int *charpos) const;
+
+  private:
+    const char *_data;              ///< source code
+    size_t  _size;                  ///< size of source code
+    bool    _good;                  ///< status flag
+    void   *_map;                   ///< mapped file (NULL if not mapped)
+    string  _copy;                  ///< copy of the source code (if not mapped or borrowed)
+    mutable vector<size_t> _lines;  ///< offsets of line starts (built on demand)
+};
+
+
 //--------------------------------------------------------------------------------------------------
 /// @brief token class
 ///
@@ -109,7 +176,10 @@ enum EToken {
 /// Additional fields specify the exact position of the lexeme in the input
 /// stream (line/column); this is used for error reporting.
 ///
-/// Note that the token value is stored in escaped form for strings/characters.
+/// The value of a token is interned in the atom table (CAtomTable); tokens
+/// are trivially copyable. Tokens created by the scanner store the offset of
+/// the lexeme in the source buffer; its line/column are computed on request.
+/// Such tokens must not outlive the source buffer.
 ///
 class CToken {
   friend class CScanner;
@@ -120,18 +190,19 @@ class CToken {
     /// @brief default constructor
     CToken();
 
-    /// @brief constructor taking initialization values
+    /// @brief constructor for a token without a position in a source buffer
     ///
-    /// @param line line number in the input stream
-    /// @param charpos character position in the input stream
     /// @param type token type
     /// @param value token value
-    CToken(int line, int charpos, EToken type, const string value="");
+    CToken(EToken type, const string value="");
 
-    /// @brief copy contructor
+    /// @brief constructor for a token in a source buffer
     ///
-    /// @param token token to copy
-    CToken(const CToken &token);
+    /// @param type token type
+    /// @param atom token value
+    /// @param src source buffer
+    /// @param offset offset of the lexeme in @a src
+    CToken(EToken type, TAtom atom, const CSourceBuffer *src, size_t offset);
 
     /// @brief copy contructor
     ///
@@ -160,22 +231,32 @@ class CToken {
     /// @brief return the token value of this instance
     ///
     /// @retval token value
-    string GetValue(void) const { return _value; };
+    const string& GetValue(void) const { return CAtomTable::Get()->GetString(_atom); };
+
+    /// @brief return the interned token value of this instance
+    ///
+    /// @retval token value (atom)
+    TAtom GetAtom(void) const { return _atom; };
 
     /// @}
 
     /// @name stream attributes
     /// @{
 
+    /// @brief return the offset of the lexeme in the source buffer
+    ///
+    /// @retval offset
+    size_t GetOffset(void) const { return _offset; };
+
     /// @brief return the line number
     ///
-    /// @retval line number of the token in the input stream
-    int GetLineNumber(void) const { return _line; };
+    /// @retval line number of the token in the input stream (0 if unknown)
+    int GetLineNumber(void) const;
 
     /// @brief return the character position
     ///
-    /// @retval character position of the token in the input stream
-    int GetCharPosition(void) const { return _char; };
+    /// @retval character position of the token in the input stream (0 if unknown)
+    int GetCharPosition(void) const;
 
     /// @}
 
@@ -211,11 +292,13 @@ class CToken {
 
   private:
     EToken _type;                   ///< token type
-    string _value;                  ///< token value
-    int    _line;                   ///< input stream position (line)
-    int    _char;                   ///< input stream position (character pos)
+    TAtom  _atom;                   ///< token value
+    uint32_t _offset;               ///< offset of the lexeme in the source buffer
+    const CSourceBuffer *_src;      ///< source buffer (NULL if none)
 };
 
+static_assert(is_trivially_copyable<CToken>::value, "CToken must be trivially copyable");
+
 /// @name CToken output operators
 /// @{
 
@@ -256,6 +339,11 @@ class CScanner {
     /// @param in input stream containing the source code
     CScanner(string in);
 
+    /// @brief constructor
+    ///
+    /// @param src source buffer (not owned; must outlive the scanner and its tokens)
+    CScanner(CSourceBuffer *src);
+
     /// @brief destructor
     ~CScanner();
 
@@ -277,15 +365,15 @@ class CScanner {
     /// @retval false if an error has occurred
     bool Good(void) const { return _good; };
 
-    /// @brief get the line number of the next token in the input stream
+    /// @brief get the current line number in the input stream
     ///
     /// @retval line number
-    int GetLineNumber(void) const { return _line; };
+    int GetLineNumber(void) const;
 
-    /// @brief get the character position of the next token in the input stream
+    /// @brief get the current character position in the input stream
     ///
     /// @retval character position
-    int GetCharPosition() const { return _char; };
+    int GetCharPosition() const;
 
   private:
     /// @brief result type for the GetCharacter() method
@@ -296,8 +384,8 @@ class CScanner {
       cUnexpEnd,                    ///< unexpected end of string/character
     };
 
-    /// @brief initialize list of reserved keywords
-    void InitKeywords(void);
+    /// @brief prepare scanning of the source buffer
+    void Init(void);
 
     /// @brief scan the next token
     void NextToken(void);
@@ -316,7 +404,15 @@ class CScanner {
     /// @param type token type
     /// @param token  token value
     /// @retval CToken instance
-    CToken* NewToken(EToken type, const string token="");
+    CToken NewToken(EToken type, const string token);
+
+    /// @brief create and return a new token whose value is the lexeme in the source buffer
+    ///
+    /// @param type token type
+    /// @param start start of the lexeme
+    /// @param end end of the lexeme
+    /// @retval CToken instance
+    CToken NewToken(EToken type, const char *start, const char *end);
 
 
     /// @name low-level scanner routines
@@ -325,7 +421,7 @@ class CScanner {
     /// @brief scan the input stream and return the next token
     ///
     /// @retval CToken instance
-    CToken* Scan(void);
+    CToken Scan(void);
 
     /// @brief parse a (possibly escaped) character
     ///
@@ -334,9 +430,12 @@ class CScanner {
     /// @retval ECharacter status of character parse
     ECharacter GetCharacter(unsigned char &c, EToken mode);
 
+    /// @brief returns true if the end of the input has been reached
+    bool AtEnd(void) const { return _pos >= _end; };
+
     /// @brief peek at the next character in the input stream (w/o removing it)
     ///
-    /// @retval next character in the input stream
+    /// @retval next character in the input stream (0xff at the end)
     unsigned char PeekChar(void);
 
     /// @brief return the next character from the input stream
@@ -385,19 +484,26 @@ class CScanner {
     /// @retval false character is not valid in an ID
     static bool IsIDChar(unsigned char c);
 
+    /// @brief skip a run of white space / digits / ID characters
+    ///
+    /// @param p start of the run
+    /// @param end end of the source buffer
+    /// @retval pointer to the first character past the run
+    static const char* SkipWhite(const char *p, const char *end);
+    static const char* SkipDigits(const char *p, const char *end);
+    static const char* SkipIDChars(const char *p, const char *end);
+
     /// @}
 
 
   private:
-    static map<string, EToken> keywords;///< reserved keywords with corr. tokens
-    istream *_in;                   ///< input stream
-    bool    _delete_in;             ///< delete input stream upon destruction
+    CSourceBuffer *_src;            ///< source buffer
+    bool    _delete_src;            ///< delete source buffer upon destruction
     bool    _good;                  ///< scanner status flag
-    int     _line;                  ///< current stream position (line)
-    int     _char;                  ///< current stream position (character pos)
-    int     _saved_line;            ///< saved stream position (line)
-    int     _saved_char;            ///< saved stream position (character pos)
-    CToken *_token;                 ///< next token in input stream
+    const char *_pos;               ///< current position in the source buffer
+    const char *_end;               ///< end of the source buffer
+    const char *_saved;             ///< saved position in the source buffer
+    CToken  _token;                 ///< next token in input stream
 };
 
 
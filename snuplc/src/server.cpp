@@ -0,0 +1,276 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compile server connections
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/un.h>
+#include <arpa/inet.h>
+#include <unistd.h>
+
+#include "server.h"
+using namespace std;
+
+#define MAX_FIELDS    (1U << 20)      ///< max. number of strings in a message
+#define MAX_MESSAGE   (1U << 28)      ///< max. total size of a received message in bytes
+#define CHUNK         (1U << 16)      ///< strings are received in chunks of this size
+#define RECEIVE_TIMEOUT 30            ///< seconds the server waits for data from a client
+
+
+/// @brief fill in the socket address of @a path
+/// @retval true on success
+/// @retval false if @a path is too long
+static bool SocketAddress(const string &path, struct sockaddr_un &addr)
+{
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if (path.size() >= sizeof(addr.sun_path)) return false;
+  strcpy(addr.sun_path, path.c_str());
+  return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// message encoding
+//
+string EncodeMessage(const TMessage &msg)
+{
+  string buf;
+  uint32_t n = htonl(msg.size());
+  buf.append((const char*)&n, sizeof(n));
+  for (const string &s : msg) {
+    n = htonl(s.size());
+    buf.append((const char*)&n, sizeof(n));
+    buf.append(s);
+  }
+
+  return buf;
+}
+
+bool DecodeMessage(const string &data, TMessage &msg)
+{
+  size_t pos = 0;
+  uint32_t n;
+
+  msg.clear();
+  if (data.size() < sizeof(n)) return false;
+  memcpy(&n, data.data(), sizeof(n));
+  pos += sizeof(n);
+  n = ntohl(n);
+  if ((n > MAX_FIELDS) || (n > (data.size() - pos) / sizeof(n))) return false;
+
+  msg.resize(n);
+  for (string &s : msg) {
+    if (data.size() - pos < sizeof(n)) return false;
+    memcpy(&n, data.data() + pos, sizeof(n));
+    pos += sizeof(n);
+    n = ntohl(n);
+    if (data.size() - pos < n) return false;
+
+    s.assign(data, pos, n);
+    pos += n;
+  }
+
+  return pos == data.size();
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CConnection
+//
+CConnection::CConnection(int fd)
+  : _fd(fd)
+{
+}
+
+CConnection::~CConnection(void)
+{
+  close(_fd);
+}
+
+CConnection* CConnection::Connect(const string path)
+{
+  struct sockaddr_un addr;
+  if (!SocketAddress(path, addr)) return NULL;
+
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (fd < 0) return NULL;
+
+  if (connect(fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) {
+    close(fd);
+    return NULL;
+  }
+
+  return new CConnection(fd);
+}
+
+bool CConnection::Send(const TMessage &msg)
+{
+  string buf = EncodeMessage(msg);
+
+  return Write(buf.data(), buf.size());
+}
+
+bool CConnection::Receive(TMessage &msg)
+{
+  uint32_t n, fields;
+  size_t total = sizeof(n);
+
+  msg.clear();
+  if (!Read((char*)&n, sizeof(n))) return false;
+  fields = ntohl(n);
+  if (fields > MAX_FIELDS) return false;
+
+  // the message only grows as its strings arrive, so the memory in use is bounded by the data
+  // actually received rather than by the lengths the peer claims
+  for (uint32_t i=0; i<fields; i++) {
+    if (!Read((char*)&n, sizeof(n))) return false;
+    n = ntohl(n);
+    total += sizeof(n) + n;
+    if (total > MAX_MESSAGE) return false;
+
+    msg.push_back(string());
+    string &s = msg.back();
+    while (s.size() < n) {
+      size_t len = s.size(), chunk = min((size_t)(n - len), (size_t)CHUNK);
+      s.resize(len + chunk);
+      if (!Read(&s[len], chunk)) return false;
+    }
+  }
+
+  return true;
+}
+
+bool CConnection::Write(const char *data, size_t size)
+{
+  while (size > 0) {
+    ssize_t res = send(_fd, data, size, MSG_NOSIGNAL);
+    if (res < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    data += res;
+    size -= res;
+  }
+
+  return true;
+}
+
+bool CConnection::Read(char *data, size_t size)
+{
+  while (size > 0) {
+    ssize_t res = recv(_fd, data, size, 0);
+    if (res < 0) {
+      if (errno == EINTR) continue;
+      return false;
+    }
+    if (res == 0) return false;
+    data += res;
+    size -= res;
+  }
+
+  return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CServer
+//
+CServer::CServer(void)
+  : _fd(-1)
+{
+}
+
+CServer::~CServer(void)
+{
+  if (_fd >= 0) {
+    close(_fd);
+    unlink(_path.c_str());
+  }
+}
+
+bool CServer::Listen(const string path)
+{
+  struct sockaddr_un addr;
+  if (!SocketAddress(path, addr)) {
+    _message = "socket path too long: '" + path + "'.";
+    return false;
+  }
+
+  // remove a stale socket, but never a live one or any other file
+  struct stat st;
+  if ((stat(path.c_str(), &st) == 0) && S_ISSOCK(st.st_mode)) {
+    CConnection *c = CConnection::Connect(path);
+    if (c != NULL) {
+      delete c;
+      _message = "another server is listening on '" + path + "'.";
+      return false;
+    }
+    unlink(path.c_str());
+  }
+
+  _fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if ((_fd < 0) ||
+      (bind(_fd, (struct sockaddr*)&addr, sizeof(addr)) < 0) ||
+      (listen(_fd, SOMAXCONN) < 0)) {
+    _message = "cannot listen on '" + path + "': " + strerror(errno) + ".";
+    if (_fd >= 0) close(_fd);
+    _fd = -1;
+    return false;
+  }
+
+  _path = path;
+  return true;
+}
+
+CConnection* CServer::Accept(void)
+{
+  int fd;
+  do {
+    fd = accept(_fd, NULL, NULL);
+  } while ((fd < 0) && (errno == EINTR));
+
+  if (fd < 0) {
+    _message = string("cannot accept client: ") + strerror(errno) + ".";
+    return NULL;
+  }
+
+  // a client that stops sending must not occupy the server forever
+  struct timeval timeout = { RECEIVE_TIMEOUT, 0 };
+  setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+
+  return new CConnection(fd);
+}
+
+string CServer::GetErrorMessage(void) const
+{
+  return _message;
+}
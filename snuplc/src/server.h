@@ -0,0 +1,144 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compile server connections
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_SERVER_H__
+#define __SnuPL_SERVER_H__
+
+#include <string>
+#include <vector>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief compile server message
+///
+/// A message is a list of strings. On the wire, it is encoded as the number of strings followed by
+/// the length and the bytes of each string; numbers are 32-bit unsigned integers in network byte
+/// order.
+///
+typedef vector<string> TMessage;
+
+/// @brief encode message @a msg into its wire format
+string EncodeMessage(const TMessage &msg);
+
+/// @brief decode message @a msg from its wire format @a data
+/// @retval true on success
+/// @retval false if @a data is malformed
+bool DecodeMessage(const string &data, TMessage &msg);
+
+//--------------------------------------------------------------------------------------------------
+/// @brief connection between a compile server and a client over a Unix domain socket
+///
+class CConnection {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor
+    /// @param fd connected socket (owned by the connection)
+    CConnection(int fd);
+
+    /// @brief destructor; closes the socket
+    ~CConnection(void);
+
+    /// @}
+
+    /// @brief connect to the compile server listening on socket @a path
+    /// @param path path of the socket
+    /// @retval CConnection* connection on success
+    /// @retval NULL if no server is listening on @a path
+    static CConnection* Connect(const string path);
+
+    /// @name message exchange
+    /// @{
+
+    /// @brief send message @a msg
+    /// @retval true on success
+    /// @retval false if the connection has been closed or failed
+    bool Send(const TMessage &msg);
+
+    /// @brief receive message @a msg
+    /// @retval true on success
+    /// @retval false if the connection has been closed, failed, or the message is malformed or
+    ///         exceeds the maximal size (256 MiB)
+    bool Receive(TMessage &msg);
+
+    /// @}
+
+  private:
+    CConnection(const CConnection&) = delete;
+    CConnection& operator=(const CConnection&) = delete;
+
+    bool Write(const char *data, size_t size);
+    bool Read(char *data, size_t size);
+
+    int _fd;                        ///< socket
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief listening socket of the compile server
+///
+class CServer {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    CServer(void);
+    ~CServer(void);
+
+    /// @}
+
+    /// @brief listen on the Unix domain socket @a path
+    ///
+    /// A stale socket left behind by a previous server at @a path is removed.
+    /// @retval true on success
+    /// @retval false on failure (see GetErrorMessage())
+    bool Listen(const string path);
+
+    /// @brief wait for and accept the next client
+    ///
+    /// Receiving from the connection fails if the client sends nothing for 30 seconds.
+    /// @retval CConnection* connection to the client
+    /// @retval NULL on failure (see GetErrorMessage())
+    CConnection* Accept(void);
+
+    /// @brief return a human-readable error message of the last failed Listen() or Accept()
+    string GetErrorMessage(void) const;
+
+  private:
+    CServer(const CServer&) = delete;
+    CServer& operator=(const CServer&) = delete;
+
+    int    _fd;                     ///< listening socket
+    string _path;                   ///< path of the socket
+    string _message;                ///< error message
+};
+
+
+#endif // __SnuPL_SERVER_H__
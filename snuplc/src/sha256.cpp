@@ -0,0 +1,145 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SHA-256 message digest
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cstring>
+
+#include "sha256.h"
+using namespace std;
+
+/// @brief round constants
+static const uint32_t K[64] = {
+  0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+  0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+  0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+  0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+  0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+  0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+  0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+  0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static inline uint32_t Rotr(uint32_t x, int n)
+{
+  return (x >> n) | (x << (32 - n));
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CSHA256
+//
+CSHA256::CSHA256(void)
+  : _used(0), _length(0)
+{
+  static const uint32_t H0[8] = {
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19,
+  };
+  memcpy(_h, H0, sizeof(_h));
+}
+
+void CSHA256::Update(const void *data, size_t size)
+{
+  const unsigned char *p = (const unsigned char*)data;
+
+  _length += size;
+  while (size > 0) {
+    size_t n = min(size, sizeof(_block) - _used);
+    memcpy(_block + _used, p, n);
+    _used += n;
+    p += n;
+    size -= n;
+
+    if (_used == sizeof(_block)) {
+      Transform();
+      _used = 0;
+    }
+  }
+}
+
+void CSHA256::Update(const string &s)
+{
+  uint64_t len = s.size();
+  Update(&len, sizeof(len));
+  Update(s.data(), s.size());
+}
+
+string CSHA256::GetDigest(void) const
+{
+  // pad a copy so that more data can still be added to this instance
+  CSHA256 c(*this);
+  uint64_t bits = _length * 8;
+
+  unsigned char pad = 0x80;
+  c.Update(&pad, 1);
+  pad = 0;
+  while (c._used != 56) c.Update(&pad, 1);
+
+  unsigned char len[8];
+  for (int i=0; i<8; i++) len[i] = (unsigned char)(bits >> (56 - 8*i));
+  c.Update(len, sizeof(len));
+
+  static const char hex[] = "0123456789abcdef";
+  string digest;
+  for (int i=0; i<8; i++) {
+    for (int j=28; j>=0; j-=4) digest += hex[(c._h[i] >> j) & 0xf];
+  }
+
+  return digest;
+}
+
+void CSHA256::Transform(void)
+{
+  uint32_t w[64];
+
+  for (int i=0; i<16; i++) {
+    w[i] = ((uint32_t)_block[4*i] << 24) | ((uint32_t)_block[4*i+1] << 16) |
+           ((uint32_t)_block[4*i+2] << 8) | (uint32_t)_block[4*i+3];
+  }
+  for (int i=16; i<64; i++) {
+    uint32_t s0 = Rotr(w[i-15], 7) ^ Rotr(w[i-15], 18) ^ (w[i-15] >> 3);
+    uint32_t s1 = Rotr(w[i-2], 17) ^ Rotr(w[i-2], 19) ^ (w[i-2] >> 10);
+    w[i] = w[i-16] + s0 + w[i-7] + s1;
+  }
+
+  uint32_t a = _h[0], b = _h[1], c = _h[2], d = _h[3];
+  uint32_t e = _h[4], f = _h[5], g = _h[6], h = _h[7];
+
+  for (int i=0; i<64; i++) {
+    uint32_t s1 = Rotr(e, 6) ^ Rotr(e, 11) ^ Rotr(e, 25);
+    uint32_t ch = (e & f) ^ (~e & g);
+    uint32_t t1 = h + s1 + ch + K[i] + w[i];
+    uint32_t s0 = Rotr(a, 2) ^ Rotr(a, 13) ^ Rotr(a, 22);
+    uint32_t maj = (a & b) ^ (a & c) ^ (b & c);
+    uint32_t t2 = s0 + maj;
+
+    h = g; g = f; f = e; e = d + t1;
+    d = c; c = b; b = a; a = t1 + t2;
+  }
+
+  _h[0] += a; _h[1] += b; _h[2] += c; _h[3] += d;
+  _h[4] += e; _h[5] += f; _h[6] += g; _h[7] += h;
+}
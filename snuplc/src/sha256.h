@@ -0,0 +1,72 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SHA-256 message digest
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_SHA256_H__
+#define __SnuPL_SHA256_H__
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief SHA-256 message digest (FIPS 180-4)
+///
+/// Data is fed incrementally with Update(); GetDigest() returns the digest of all data fed so far
+/// as a lower-case hexadecimal string.
+///
+class CSHA256 {
+  public:
+    /// @brief constructor
+    CSHA256(void);
+
+    /// @brief add @a size bytes at @a data to the message
+    void Update(const void *data, size_t size);
+
+    /// @brief add string @a s to the message
+    ///
+    /// The length of @a s is added as well so that the concatenation of several strings is
+    /// unambiguous.
+    void Update(const string &s);
+
+    /// @brief return the digest of the message as a hexadecimal string
+    string GetDigest(void) const;
+
+  private:
+    /// @brief process the 64-byte block in _block
+    void Transform(void);
+
+    uint32_t _h[8];                 ///< hash state
+    unsigned char _block[64];       ///< current block
+    size_t   _used;                 ///< number of bytes in _block
+    uint64_t _length;               ///< message length in bytes
+};
+
+
+#endif // __SnuPL_SHA256_H__
@@ -37,12 +37,32 @@
 #include <iostream>
 #include <fstream>
 #include <vector>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <set>
+#include <map>
+#include <sstream>
+#include <climits>
+#include <csignal>
 
 #include "environment.h"
+#include "context.h"
 #include "scanner.h"
 #include "parser.h"
 #include "ir.h"
+#include "irfile.h"
+#include "profile.h"
+#include "opt.h"
 #include "backend.h"
+#include "interpreter.h"
+#include "server.h"
+#include "cache.h"
+#include "sha256.h"
+#include "timer.h"
 using namespace std;
 
 
@@ -94,7 +114,46 @@ void RunDOT(string file)
   }
 }
 
-void DumpAST(string file, CAstModule *ast)
+//--------------------------------------------------------------------------------------------------
+/// @brief result of the compilation of a source file
+///
+/// Compilations do not write to the console or to files directly; the driver (or the client of a
+/// compile server) prints the log and writes the output files once the compilation has finished.
+///
+struct SCompilation {
+  ostringstream log;                    ///< console output (diagnostics, assembly code)
+  vector<pair<string, string>> output;  ///< output files (file name, contents)
+  bool ok;                              ///< assembly code has been generated successfully
+};
+
+/// @brief encode the result of a compilation as [ log, ok, file name_1, contents_1, ... ]
+TMessage EncodeCompilation(const SCompilation &res)
+{
+  TMessage msg { res.log.str(), res.ok ? "1" : "0" };
+
+  for (const auto &o : res.output) {
+    msg.push_back(o.first);
+    msg.push_back(o.second);
+  }
+
+  return msg;
+}
+
+/// @brief decode the result of a compilation encoded with EncodeCompilation()
+/// @retval true on success
+/// @retval false if @a msg is malformed
+bool DecodeCompilation(const TMessage &msg, SCompilation &res)
+{
+  if ((msg.size() < 2) || (msg.size() % 2 != 0)) return false;
+
+  res.log << msg[0];
+  res.ok = msg[1] == "1";
+  for (size_t i=2; i<msg.size(); i+=2) res.output.push_back(make_pair(msg[i], msg[i+1]));
+
+  return true;
+}
+
+void DumpAST(string file, CAstModule *ast, SCompilation &res)
 {
   bool b;
 
@@ -102,18 +161,18 @@ void DumpAST(string file, CAstModule *ast)
     assert(ast != NULL);
 
     // output AST in textual form
-    ofstream out(file + ".ast");
+    ostringstream out;
     out << file << ":" << endl;
     ast->print(out, 4);
     out << endl << endl
       << "  symbol table:" << endl;
     ast->GetSymbolTable()->print(out, 4);
     out << endl;
+    res.output.push_back(make_pair(file + ".ast", out.str()));
 
     // output AST in graphical form
     if (CEnvironment::Get()->GetFlag("dot", b) && b) {
-      string fn = file + ".ast.dot";
-      ofstream dot(fn);
+      ostringstream dot;
       dot << "digraph AST {" << endl
           << "  graph [fontname=\"Times New Roman\",fontsize=10];" << endl
           << "  node  [fontname=\"Courier New\",fontsize=10];" << endl
@@ -121,145 +180,928 @@ void DumpAST(string file, CAstModule *ast)
           << endl;
       ast->toDot(dot, 2);
       dot << "}" << endl;
-      dot.flush();
+      res.output.push_back(make_pair(file + ".ast.dot", dot.str()));
+    }
+  }
+}
 
-      RunDOT(fn);
+/// @brief output the TAC of module @a m to @a name.tac (and @a name.tac.dot)
+void PrintTAC(string name, CModule *m, SCompilation &res)
+{
+  bool b;
+
+  assert(m != NULL);
+
+  // output TAC in textual form
+  ostringstream out;
+  out << name << ":" << endl
+      << m << endl;
+  res.output.push_back(make_pair(name + ".tac", out.str()));
+
+  // output TAC in graphical form
+  if (CEnvironment::Get()->GetFlag("dot", b) && b) {
+    ostringstream dot;
+
+    dot << "digraph IR {" << endl
+        << "  graph [fontname=\"Times New Roman\",fontsize=10];" << endl
+        << "  node  [fontname=\"Courier New\",fontsize=10];" << endl
+        << "  edge  [fontname=\"Times New Roman\",fontsize=10];" << endl
+        << endl;
+    m->toDot(dot, 2);
+    const vector<CScope*> &proc = m->GetSubscopes();
+    for (size_t p=0; p<proc.size(); p++) {
+      proc[p]->toDot(dot, 2);
     }
+    dot<< "}" << endl;
+    res.output.push_back(make_pair(name + ".tac.dot", dot.str()));
   }
 }
 
-void DumpTAC(string file, CModule *m)
+/// @brief output the IR of module @a m in binary form to @a name.ir
+void EmitIR(string name, CModule *m, SCompilation &res)
+{
+  CIRWriter w;
+  ostringstream out;
+
+  if (w.Write(m, out)) res.output.push_back(make_pair(name + ".ir", out.str()));
+  else res.log << "error: cannot output IR to " << name << ".ir: " << w.GetErrorMessage() << endl;
+}
+
+void DumpTAC(string file, CModule *m, SCompilation &res)
 {
   bool b;
 
-  if (CEnvironment::Get()->GetFlag("tac", b) && b) {
-    assert(m != NULL);
+  if (CEnvironment::Get()->GetFlag("tac", b) && b) PrintTAC(file, m, res);
+}
 
-    // output TAC in textual form
-    ofstream out(file + ".tac");
-    out << file << ":" << endl
-        << m << endl;
+/// @brief return the optimization pipeline configured in the environment @a env
+///
+/// An explicit --passes list takes precedence over the pipeline of the optimization level;
+/// --no-layout removes the block layout from the latter.
+string GetPipeline(CEnvironment *env)
+{
+  string passes, level;
+  bool layout = true;
 
-    // output TAC in graphical form
-    if (CEnvironment::Get()->GetFlag("dot", b) && b) {
-      string fn = file + ".tac.dot";
-      ofstream dot(fn);
+  if (env->GetSetting("passes", passes) && (passes != "")) return passes;
 
-      dot << "digraph IR {" << endl
-          << "  graph [fontname=\"Times New Roman\",fontsize=10];" << endl
-          << "  node  [fontname=\"Courier New\",fontsize=10];" << endl
-          << "  edge  [fontname=\"Times New Roman\",fontsize=10];" << endl
-          << endl;
-      m->toDot(dot, 2);
-      const vector<CScope*> &proc = m->GetSubscopes();
-      for (size_t p=0; p<proc.size(); p++) {
-        proc[p]->toDot(dot, 2);
-      }
-      dot<< "}" << endl;
-      dot.flush();
+  env->GetSetting("opt-level", level);
+  passes = CPassManager::GetPipeline(atoi(level.c_str()));
 
-      RunDOT(fn);
+  env->GetFlag("layout", layout);
+  if (!layout) {
+    istringstream in(passes);
+    string p, res;
+    while (getline(in, p, ',')) {
+      if (p != "layout") res += (res == "" ? "" : ",") + p;
     }
+    passes = res;
   }
+
+  return passes;
 }
 
-int main(int argc, char *argv[])
+/// @brief run the optimization pipeline on module @a m
+///
+/// @param file name of the source file
+/// @param m module
+/// @param res [in/out] result of the compilation
+void Optimize(string file, CModule *m, SCompilation &res)
 {
   CEnvironment *env = CEnvironment::Get();
-  env->ParseArguments(argc, argv);
+  CPassManager pm(&res.log);
+  string pipeline = GetPipeline(env);
 
-  CTarget *target = env->GetTarget();
-  if (target == NULL) {
-    env->Syntax("Target not available.");
+  if (!pm.AddPasses(pipeline)) {
+    res.log << "error: " << pm.GetErrorMessage() << endl;
+    return;
+  }
+
+  // profile counters refer to the code of an instrumented compilation; scopes whose code or
+  // pipeline differ fall back to static estimates
+  bool instrument = false;
+  env->GetFlag("instrument", instrument);
+  const CProfile *profile = m->GetProfile();
+
+  if (instrument || (profile != NULL)) {
+    vector<CScope*> scopes { m };
+    for (size_t i=0; i<scopes.size(); i++) {
+      CScope *s = scopes[i];
+      for (CScope *c : s->GetSubscopes()) scopes.push_back(c);
+
+      s->SetProfileSignature(CProfile::Signature(s, pipeline));
+      if ((profile != NULL) && !profile->Matches(s, s->GetProfileSignature())) {
+        if (profile->HasScope(s)) {
+          res.log << "warning: profile of '" << s->GetName() << "' was recorded for different "
+                  << "code or optimizations; using static estimates." << endl;
+        }
+        s->IgnoreProfile();
+      }
+    }
   }
 
-  //CTypeManager::Get()->print(cout);
+  // --print-after/--emit-ir-after: output the TAC in textual/binary form after the given passes
+  string after, item;
+  set<string> print, emit;
+  map<string, int> runs;
+  env->GetSetting("print-after", after);
+  for (istringstream in(after); getline(in, item, ','); ) print.insert(item);
+  env->GetSetting("emit-ir-after", after);
+  for (istringstream in(after); getline(in, item, ','); ) emit.insert(item);
+
+  if (!print.empty() || !emit.empty()) {
+    pm.SetCallback([&](const CPass *pass) {
+      string name = pass->GetName();
+      bool p = (print.find("all") != print.end()) || (print.find(name) != print.end());
+      bool e = (emit.find("all") != emit.end()) || (emit.find(name) != emit.end());
+      if (!p && !e) return;
+
+      int n = ++runs[name];
+      if (n > 1) name += "." + to_string(n);
+
+      CPhaseTimer timer("dump");
+      if (p) PrintTAC(file + "." + name, m, res);
+      if (e) EmitIR(file + "." + name, m, res);
+    });
+  }
+
+  pm.Run(m);
+}
+
+/// @brief optimize module @a tac, then generate code for it or run it in the IR interpreter
+///
+/// @param file name of the source file
+/// @param tac module
+/// @param res [in/out] result of the compilation
+void CompileTAC(string file, CModule *tac, SCompilation &res)
+{
+  CTarget *target = CEnvironment::Get()->GetTarget();
+
+  Optimize(file, tac, res);
+
+  {
+    CPhaseTimer timer("dump");
+    DumpTAC(file, tac, res);
+
+    bool emit = false;
+    CEnvironment::Get()->GetFlag("emit-ir", emit);
+    if (emit) EmitIR(file, tac, res);
+  }
+
+  bool interpret = false;
+  CEnvironment::Get()->GetFlag("interpret", interpret);
+
+  if (interpret) {
+    //
+    // execution in the IR interpreter
+    //
+    CInterpreter interp(tac);
+    bool ok;
+    {
+      CPhaseTimer timer("interpret");
+      ok = interp.Run(cin, cout);
+    }
+
+    if (!ok) {
+      res.log << "runtime error: " << interp.GetErrorMessage() << endl;
+    } else {
+      res.ok = true;
+    }
+  } else {
+    // output assembly to console or file
+    ostringstream sout;
+    bool console = false;
+    CEnvironment::Get()->GetFlag("console", console);
+
+    //
+    // code generation
+    //
+    CBackend *be = target->GetBackend(console ? (ostream&)res.log : (ostream&)sout);
+    assert(be != NULL);
+
+    {
+      CPhaseTimer timer("emit");
+      be->Emit(tac);
+    }
+
+    if (!console) res.output.push_back(make_pair(file + ".s", sout.str()));
+
+    if (be->HasError()) {
+      res.log << "code generation error: " << be->GetErrorMessage() << endl;
+    } else {
+      res.ok = true;
+    }
+
+    delete be;
+  }
+}
 
-  string file = env->GetNextFile();
+/// @brief compile @a file to assembly code
+///
+/// Compiles a single source file in its own compilation context so that several files can be
+/// compiled concurrently. Uses the environment of the calling thread. Binary IR files (see
+/// CIRReader) skip the front end.
+///
+/// @param file name of the source file
+/// @param src source code or binary IR
+/// @param profile execution profile (may be NULL)
+/// @param res [out] result of the compilation
+void Compile(string file, CSourceBuffer *src, const CProfile *profile, SCompilation &res)
+{
+  CContext ctx;
 
-  if (file == "") env->Syntax("No input files.");
+  res.ok = false;
+  res.log << "compiling " << file << "..." << endl;
 
-  while (file != "") {
+  if (CIRReader::IsIRFile(src->GetData(), src->GetSize())) {
     //
-    // scanning, parsing
+    // loading of binary IR
     //
-    CScanner *s = new CScanner(new ifstream(file));
-    CParser *p = new CParser(s);
+    CIRReader r;
+    CModule *tac;
+    {
+      CPhaseTimer timer("load");
+      tac = r.Load(src->GetData(), src->GetSize());
+    }
+
+    if (tac == NULL) {
+      res.log << "error: " << r.GetErrorMessage() << endl;
+    } else {
+      tac->SetProfile(profile);
+      CompileTAC(file, tac, res);
+      delete tac;
+    }
+
+    return;
+  }
 
-    cout << "compiling " << file << "..." << endl;
-    CAstNode *ast = p->Parse();
+  //
+  // scanning, parsing
+  //
+  CScanner *s = new CScanner(src);
+  CParser *p = new CParser(s);
+
+  CAstNode *ast;
+  {
+    CPhaseTimer timer("parse");
+    ast = p->Parse();
+  }
+
+  if (p->HasError()) {
+    const CToken *error = p->GetErrorToken();
+    res.log << "syntax error at " << error->GetLineNumber() << ":"
+            << error->GetCharPosition() << " : "
+            << p->GetErrorMessage() << endl;
+  } else {
+    CAstModule *m = dynamic_cast<CAstModule*>(ast);
+    assert(m != NULL);
+
+    //
+    // semantic analysis
+    //
+    CToken t;
+    string msg;
+    bool ok;
+    {
+      CPhaseTimer timer("typecheck");
+      ok = m->TypeCheck(&t, &msg);
+    }
 
-    if (p->HasError()) {
-      const CToken *error = p->GetErrorToken();
-      cout << "syntax error at " << error->GetLineNumber() << ":"
-           << error->GetCharPosition() << " : "
-           << p->GetErrorMessage() << endl;
+    if (!ok) {
+      res.log << "semantic error at " << t.GetLineNumber() << ":"
+              << t.GetCharPosition() << " : " << msg << endl;
     } else {
-      CAstModule *m = dynamic_cast<CAstModule*>(ast);
-      assert(m != NULL);
+      {
+        CPhaseTimer timer("dump");
+        DumpAST(file, m, res);
+      }
 
       //
-      // semantic analysis
+      // AST to TAC conversion
       //
-      CToken t;
-      string msg;
-      if (!m->TypeCheck(&t, &msg)) {
-        cout << "semantic error at " << t.GetLineNumber() << ":"
-          << t.GetCharPosition() << " : " << msg << endl;
-      } else {
-        DumpAST(file, m);
-
-        //
-        // AST to TAC conversion
-        //
-        CModule *m = new CModule(ast);
-
-        DumpTAC(file, m);
-
-        // output assembly to console or file
-        ostream *out = &cout;
-        ofstream *sout = NULL;
-
-        bool b;
-        if (CEnvironment::Get()->GetFlag("console", b) && !b) {
-          sout = new ofstream(file + ".s");
-          out = sout;
-        }
+      CModule *tac;
+      {
+        CPhaseTimer timer("tacgen");
+        tac = new CModule(ast);
+        tac->SetProfile(profile);
+      }
 
-        //
-        // code generation
-        //
-        CBackend *be = target->GetBackend(*out);
-        if (be == NULL) {
-          cout << "No backend available for target '"
-            << target->GetName() << "'." << endl;
-          return EXIT_FAILURE;
-        }
+      CompileTAC(file, tac, res);
 
-        be->Emit(m);
+      delete tac;
+    }
 
-        if (sout != NULL) {
-          sout->flush();
-          delete sout;
-        }
+    delete m;
+  }
 
-        if (be->HasError()) {
-          cout << "code generation error: " << be->GetErrorMessage() << endl;
-        } else {
-          RunCompile(file + ".s", target);
-        }
+  delete p;
+  delete s;
+}
+
+/// @brief print the log of a compilation, write its output files, and run external tools
+///
+/// When interpreting, the log goes to stderr to keep the output of the program apart.
+///
+/// @param file name of the source file
+/// @param res result of the compilation
+void Finish(string file, const SCompilation &res)
+{
+  bool interpret = false;
+  CEnvironment::Get()->GetFlag("interpret", interpret);
+
+  (interpret ? cerr : cout) << res.log.str() << flush;
+
+  for (const auto &o : res.output) {
+    ofstream out(o.first, ios::binary);
+    out << o.second;
+    out.close();
+
+    if ((o.first.size() > 4) && (o.first.compare(o.first.size()-4, 4, ".dot") == 0)) {
+      RunDOT(o.first);
+    }
+  }
+
+  if (res.ok && !interpret) RunCompile(file + ".s", CEnvironment::Get()->GetTarget());
+}
+
+//--------------------------------------------------------------------------------------------------
+// compilation cache
+//
+// The key of a compilation is the digest of the compiler executable, the file name, the source
+// code, all settings that influence the result, and the execution profile. The entry is the
+// encoded result of the compilation, so a hit reproduces the log and all output files without
+// scanning, parsing, or generating code.
+//
+
+/// @brief settings that do not influence the result of a compilation
+static const set<string> NonResultSettings = {
+  "cache", "cache-dir", "cache-size", "connect", "exe", "help", "jobs", "lib-path",
+  "profile-use", "run-dot", "server", "time-report", "time-report-json",
+};
+
+/// @brief open the compilation cache as configured in the environment of the calling thread
+/// @retval CCache* cache
+/// @retval NULL if caching is disabled, the cache directory is not usable, or the programs are
+///              interpreted
+CCache* OpenCache(void)
+{
+  CEnvironment *env = CEnvironment::Get();
+  bool b = false;
+  string dir, size;
+
+  if (env->GetFlag("interpret", b) && b) return NULL;
+  if (!env->GetFlag("cache", b) || !b) return NULL;
+
+  env->GetSetting("cache-dir", dir);
+  if (dir == "") dir = CCache::GetDefaultDir();
+  env->GetSetting("cache-size", size);
+
+  CCache *cache = new CCache(dir, strtoull(size.c_str(), NULL, 10) << 20);
+  if (!cache->IsValid()) {
+    delete cache;
+    cache = NULL;
+  }
+
+  return cache;
+}
+
+/// @brief return the cache key of compiling @a file with source code @a src
+///
+/// @param file name of the source file
+/// @param src source code
+/// @param profile digest of the execution profile ("" if none)
+string CacheKey(const string &file, const CSourceBuffer *src, const string &profile)
+{
+  CSHA256 h;
+
+  h.Update(string("snuplc-cache-1"));
+  h.Update(CCache::GetCompilerDigest());
+  h.Update(file);
+  h.Update(string(src->Good() ? "1" : "0"));
+  uint64_t size = src->GetSize();
+  h.Update(&size, sizeof(size));
+  h.Update(src->GetData(), size);
+
+  for (const auto &c : CEnvironment::Get()->GetConfiguration()) {
+    if (NonResultSettings.find(c.first) != NonResultSettings.end()) continue;
+    h.Update(c.first);
+    h.Update(c.second);
+  }
+
+  h.Update(profile);
+
+  return h.GetDigest();
+}
+
+/// @brief compile @a file unless its result is in @a cache
+///
+/// @param cache compilation cache (may be NULL)
+/// @param pdigest digest of the execution profile ("" if none)
+/// @param file name of the source file
+/// @param src source code
+/// @param profile execution profile (may be NULL)
+/// @param res [out] result of the compilation
+void CompileCached(CCache *cache, const string &pdigest,
+                   string file, CSourceBuffer *src, const CProfile *profile, SCompilation &res)
+{
+  CTimeReport::Get()->Begin();
+
+  if (cache == NULL) {
+    Compile(file, src, profile, res);
+  } else {
+    string key, entry;
+    TMessage msg;
+    bool hit;
+    {
+      CPhaseTimer timer("cache");
+      key = CacheKey(file, src, pdigest);
+      hit = cache->Lookup(key, entry) && DecodeMessage(entry, msg) && DecodeCompilation(msg, res);
+    }
+
+    if (!hit) {
+      res.log.str("");
+      res.output.clear();
+      Compile(file, src, profile, res);
+
+      CPhaseTimer timer("cache");
+      cache->Store(key, EncodeMessage(EncodeCompilation(res)));
+    }
+  }
+
+  CTimeReport::Get()->End(file);
+}
+
+/// @brief compile @a files on @a jobs threads
+///
+/// Files are compiled concurrently by a pool of worker threads that all use the environment of
+/// the calling thread. @a finish is invoked on the calling thread for each file in the order the
+/// files are given, as soon as the file and all its predecessors have been compiled. The source
+/// of a file is opened right before and closed right after its compilation, and the workers run
+/// at most 2*@a jobs files ahead of @a finish, so the memory in use does not grow with the number
+/// of files.
+///
+/// @param files names of the source files
+/// @param open function returning the source code of the file with the given index; the buffer
+///             is deleted after the compilation
+/// @param jobs number of worker threads
+/// @param profile execution profile (may be NULL)
+/// @param finish function called with the index and result of each compilation
+void CompileFiles(const vector<string> &files, const function<CSourceBuffer*(size_t)> &open,
+                  long jobs, const CProfile *profile,
+                  const function<void(size_t, SCompilation&)> &finish)
+{
+  if ((size_t)jobs > files.size()) jobs = files.size();
+
+  CCache *cache = OpenCache();
+  string pdigest;
+  if (profile != NULL) {
+    ostringstream o;
+    profile->print(o);
+    CSHA256 h;
+    h.Update(o.str());
+    pdigest = h.GetDigest();
+  }
+
+  if (jobs <= 1) {
+    for (size_t i=0; i<files.size(); i++) {
+      CSourceBuffer *src = open(i);
+      SCompilation res;
+      CompileCached(cache, pdigest, files[i], src, profile, res);
+      delete src;
+      finish(i, res);
+    }
+    delete cache;
+    return;
+  }
+
+  // results that have been compiled but not yet finished; NULL otherwise
+  vector<SCompilation*> res(files.size(), NULL);
+  size_t finished = 0;
+  size_t window = 2*jobs;
+  atomic<size_t> next(0);
+  mutex lock;
+  condition_variable progress;
+  CEnvironment *env = CEnvironment::Get();
 
-        delete be;
+  auto worker = [&]() {
+    CEnvironment::Set(env);
+
+    size_t i;
+    while ((i = next++) < files.size()) {
+      {
+        unique_lock<mutex> guard(lock);
+        progress.wait(guard, [&]() { return i < finished + window; });
       }
 
-      delete m;
+      CSourceBuffer *src = open(i);
+      SCompilation *r = new SCompilation();
+      CompileCached(cache, pdigest, files[i], src, profile, *r);
+      delete src;
+
+      lock_guard<mutex> guard(lock);
+      res[i] = r;
+      progress.notify_all();
+    }
+  };
+
+  vector<thread> pool;
+  for (long j=0; j<jobs; j++) pool.push_back(thread(worker));
+
+  for (size_t i=0; i<files.size(); i++) {
+    SCompilation *r;
+    {
+      unique_lock<mutex> guard(lock);
+      progress.wait(guard, [&]() { return res[i] != NULL; });
+      r = res[i];
+    }
+
+    finish(i, *r);
+    delete r;
+
+    lock_guard<mutex> guard(lock);
+    res[i] = NULL;
+    finished = i+1;
+    progress.notify_all();
+  }
+
+  for (thread &t : pool) t.join();
+
+  delete cache;
+}
+
+/// @brief return the number of jobs given with -j/--jobs
+long GetJobs(CEnvironment *env)
+{
+  string jobs_str;
+  env->GetSetting("jobs", jobs_str);
+
+  char *end;
+  long jobs = strtol(jobs_str.c_str(), &end, 10);
+  if ((jobs_str == "") || (*end != '\0') || (jobs < 1)) return 0;
+
+  return jobs;
+}
+
+/// @brief check the settings of the environment @a env that are not validated by the parser
+///
+/// @param env environment
+/// @param error [out] error message if a setting is invalid
+/// @retval true if all settings are valid
+/// @retval false otherwise (see @a error)
+bool CheckSettings(CEnvironment *env, string &error)
+{
+  if (env->GetTarget() == NULL) {
+    error = "Target not available.";
+    return false;
+  }
+
+  if (GetJobs(env) == 0) {
+    error = "Invalid number of jobs.";
+    return false;
+  }
+
+  string size;
+  env->GetSetting("cache-size", size);
+  char *end;
+  unsigned long long mib = strtoull(size.c_str(), &end, 10);
+  if ((size == "") || (size[0] < '0') || (size[0] > '9') || (*end != '\0') || (mib == 0) ||
+      (mib > (ULLONG_MAX >> 20))) {
+    error = "Invalid cache size.";
+    return false;
+  }
+
+  string level, after;
+  env->GetSetting("opt-level", level);
+  if ((level.size() != 1) || (level < "0") || (level > "2")) {
+    error = "Invalid optimization level.";
+    return false;
+  }
+
+  CPassManager pm;
+  if (!pm.AddPasses(GetPipeline(env))) {
+    error = pm.GetErrorMessage();
+    return false;
+  }
+
+  for (const char *setting : { "print-after", "emit-ir-after" }) {
+    env->GetSetting(setting, after);
+    istringstream print(after);
+    for (string p; getline(print, p, ','); ) {
+      if ((p != "all") && !CPassManager::IsPass(p)) {
+        error = "Unknown pass '" + p + "'.";
+        return false;
+      }
+    }
+  }
+
+  return true;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// compile server
+//
+// A client sends one request message
+//   [ profile, argc, argv[0], ..., argv[argc-1], file_1, readable_1, source_1, ..., file_n, ... ]
+// where profile is the contents of the --profile-use file (empty if none), and receives a status
+// message [ "ok" ] or [ "error", message ], followed (on success) by one message per file, in
+// order
+//   [ log, ok, output file name_1, contents_1, ... ]
+// The server parses the request's arguments into a fresh environment and compiles the files from
+// the received sources and profile; it never accesses the client's files, so client and server
+// need not share a file system. The client prints the log, writes the output files, and runs
+// external tools (dot, gcc) itself. This makes --connect a drop-in replacement for a local
+// compilation. The server uses its own cache settings (--cache, --cache-dir, --cache-size), those
+// of the client are ignored.
+//
+
+/// @brief serve the request of a client
+///
+/// @param c connection to the client (deleted when the request has been served)
+/// @param max_jobs max. number of threads compiling the files of the request
+void Serve(CConnection *c, long max_jobs)
+{
+  TMessage req;
+  size_t f = 0, argc = 0;
+
+  // decode request
+  bool valid = c->Receive(req) && (req.size() >= 2);
+  if (valid) {
+    argc = strtoul(req[1].c_str(), NULL, 10);
+    f = 2 + argc;
+    valid = (argc > 0) && (f <= req.size()) && ((req.size() - f) % 3 == 0);
+  }
+  if (!valid) {
+    c->Send(TMessage { "error", "malformed request." });
+    delete c;
+    return;
+  }
+
+  // environment of the request; the arguments come from the client and are checked again, an
+  // invalid request must not terminate the server
+  vector<char*> argv;
+  for (size_t i=0; i<argc; i++) argv.push_back(&req[2+i][0]);
+  argv.push_back(NULL);
+
+  CEnvironment *env = CEnvironment::Create();
+  string error;
+  bool interpret = false;
+  if (env->ParseArguments(argc, argv.data(), error) && CheckSettings(env, error) &&
+      env->GetFlag("interpret", interpret) && interpret) {
+    // programs run on the client
+    error = "the compile server does not interpret programs.";
+  }
+
+  if (error != "") {
+    c->Send(TMessage { "error", error });
+    delete env;
+    delete c;
+    return;
+  }
+
+  // the compilation cache is configured by the server: a client must not make the server create,
+  // write, or delete files in directories of its choice
+  for (const char *key : { "cache", "cache-dir", "cache-size" }) {
+    string value;
+    CEnvironment::Get()->GetConfig(key, value);
+    env->SetConfig(key, value);
+  }
+  CEnvironment::Set(env);
+
+  vector<string> files;
+  for (size_t i=f; i<req.size(); i+=3) files.push_back(req[i]);
+
+  // the sources are part of the request
+  auto open = [&](size_t i) -> CSourceBuffer* {
+    size_t r = f + 3*i;
+    if (req[r+1] == "1") return new CSourceBuffer(req[r+2].data(), req[r+2].size(), false);
+
+    // the client could not read the file
+    istringstream none;
+    none.setstate(ios::failbit);
+    return new CSourceBuffer(&none);
+  };
+
+  // execution profile, sent by the client
+  CProfile *profile = NULL;
+  string profile_file;
+  if (env->GetSetting("profile-use", profile_file) && (profile_file != "")) {
+    istringstream in(req[0]);
+    profile = new CProfile();
+    if (!profile->Load(in, profile_file)) {
+      c->Send(TMessage { "error", profile->GetErrorMessage() });
+      delete profile;
+      profile = NULL;
+      files.clear();
+    }
+  }
+
+  if (!files.empty() && c->Send(TMessage { "ok" })) {
+    CompileFiles(files, open, min(GetJobs(env), max_jobs), profile,
+      [&](size_t i, SCompilation &res) {
+        c->Send(EncodeCompilation(res));
+      });
+  }
+
+  delete profile;
+  CEnvironment::Set(NULL);
+  delete env;
+  delete c;
+}
+
+/// @brief run the compile server on socket @a path
+///
+/// At most one request per processor is served at once, each compiling its files on at most as
+/// many threads; further clients wait in the backlog of the socket until a request completes.
+int RunServer(string path)
+{
+  CServer server;
+
+  if (!server.Listen(path)) {
+    cout << "error: " << server.GetErrorMessage() << endl;
+    return EXIT_FAILURE;
+  }
+
+  cout << "compile server listening on '" << path << "'..." << endl;
+
+  long max_clients = max(thread::hardware_concurrency(), 1U), active = 0;
+  mutex lock;
+  condition_variable done;
+  int backoff = 0;
+
+  while (true) {
+    {
+      unique_lock<mutex> guard(lock);
+      done.wait(guard, [&]() { return active < max_clients; });
+    }
+
+    CConnection *c = server.Accept();
+    if (c == NULL) {
+      // errors such as EMFILE persist for a while; back off instead of spinning
+      cout << "warning: " << server.GetErrorMessage() << endl;
+      backoff = min(max(2*backoff, 10), 1000);
+      this_thread::sleep_for(chrono::milliseconds(backoff));
+      continue;
     }
+    backoff = 0;
 
-    delete p;
-    delete s;
+    lock_guard<mutex> guard(lock);
+    active++;
+    thread([&, c]() {
+      Serve(c, max_clients);
 
-    file = env->GetNextFile();
+      lock_guard<mutex> guard(lock);
+      active--;
+      done.notify_one();
+    }).detach();
   }
 
   return EXIT_SUCCESS;
 }
+
+/// @brief compile @a files on the compile server listening on socket @a path
+///
+/// @retval EXIT_SUCCESS/EXIT_FAILURE if the server handled the request
+/// @retval -1 if the server is not available (the files have not been compiled)
+int RunClient(string path, int argc, char *argv[], const vector<string> &files)
+{
+  CConnection *c = CConnection::Connect(path);
+  if (c == NULL) return -1;
+
+  // the profile has already been loaded successfully
+  string profile_file;
+  ostringstream profile;
+  if (CEnvironment::Get()->GetSetting("profile-use", profile_file) && (profile_file != "")) {
+    ifstream in(profile_file);
+    profile << in.rdbuf();
+  }
+
+  TMessage req { profile.str(), to_string(argc) };
+  for (int i=0; i<argc; i++) req.push_back(argv[i]);
+  for (const string &file : files) {
+    ifstream in(file, ios::binary);
+    ostringstream data;
+    if (in.good()) data << in.rdbuf();
+
+    req.push_back(file);
+    req.push_back(in.good() ? "1" : "0");
+    req.push_back(data.str());
+  }
+
+  TMessage msg;
+  if (!c->Send(req) || !c->Receive(msg) || msg.empty()) {
+    delete c;
+    return -1;
+  }
+
+  if (msg[0] != "ok") {
+    cout << "error: " << (msg.size() > 1 ? msg[1] : "compile server failed.") << endl;
+    delete c;
+    return EXIT_FAILURE;
+  }
+
+  for (const string &file : files) {
+    SCompilation res;
+    if (!c->Receive(msg) || !DecodeCompilation(msg, res)) {
+      cout << "error: lost connection to compile server." << endl;
+      delete c;
+      return EXIT_FAILURE;
+    }
+
+    Finish(file, res);
+  }
+
+  delete c;
+
+  return EXIT_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+  CEnvironment *env = CEnvironment::Get();
+  env->ParseArguments(argc, argv);
+
+  string error;
+  if (!CheckSettings(env, error)) env->Syntax(error);
+
+  CTarget *target = env->GetTarget();
+  CBackend *be = target->GetBackend(cout);
+  if (be == NULL) {
+    cout << "No backend available for target '"
+      << target->GetName() << "'." << endl;
+    return EXIT_FAILURE;
+  }
+  delete be;
+
+  long jobs = GetJobs(env);
+
+  string server;
+  if (env->GetSetting("server", server) && (server != "")) {
+    signal(SIGPIPE, SIG_IGN);
+    return RunServer(server);
+  }
+
+  vector<string> files;
+  for (string file = env->GetNextFile(); file != ""; file = env->GetNextFile()) {
+    files.push_back(file);
+  }
+
+  if (files.empty()) env->Syntax("No input files.");
+
+  // resource usage report
+  bool time_report = false;
+  string time_json;
+  env->GetFlag("time-report", time_report);
+  env->GetSetting("time-report-json", time_json);
+  if (time_report || (time_json != "")) CTimeReport::Enable(time_json != "");
+
+  // interpreted programs run one after the other on the console
+  bool interpret = false;
+  env->GetFlag("interpret", interpret);
+  if (interpret) jobs = 1;
+
+  // execution profile for profile-guided optimizations
+  CProfile *profile = NULL;
+  string profile_file;
+  if (env->GetSetting("profile-use", profile_file) && (profile_file != "")) {
+    profile = new CProfile();
+    if (!profile->Load(profile_file)) {
+      cout << "error: " << profile->GetErrorMessage() << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // compile on the compile server if one is available (the time report measures a local
+  // compilation, interpreted programs run locally)
+  string client;
+  if (env->GetSetting("connect", client) && (client != "") && !CTimeReport::IsEnabled() &&
+      !interpret) {
+    int res = RunClient(client, argc, argv, files);
+    if (res >= 0) {
+      delete profile;
+      return res;
+    }
+  }
+
+  bool failed = false;
+  CompileFiles(files, [&](size_t i) { return new CSourceBuffer(files[i]); }, jobs, profile,
+    [&](size_t i, SCompilation &res) {
+      Finish(files[i], res);
+      failed |= !res.ok;
+    });
+
+  delete profile;
+
+  if (time_report) CTimeReport::Get()->Print(cerr);
+  if (time_json != "") {
+    ofstream out(time_json);
+    CTimeReport::Get()->PrintJSON(out);
+    if (!out.good()) {
+      cout << "error: cannot write time report to '" << time_json << "'." << endl;
+      return EXIT_FAILURE;
+    }
+  }
+
+  // the exit code of the interpreter reports compilation and runtime errors
+  return interpret && failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
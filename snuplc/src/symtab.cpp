@@ -32,6 +32,7 @@
 /// DAMAGE.
 //--------------------------------------------------------------------------------------------------
 
+#include <algorithm>
 #include <cassert>
 #include <iomanip>
 #include <sstream>
@@ -101,9 +102,10 @@ ostream& operator<<(ostream &out, const CStorage *s)
 // CSymbol
 //
 CSymbol::CSymbol(const string name, ESymbolType stype, const CType *dtype)
-  : _symtab(NULL), _name(name), _symboltype(stype), _datatype(dtype), _location(NULL), _data(NULL)
+  : _symtab(NULL), _name(CAtomTable::Get()->Intern(name)), _symboltype(stype), _datatype(dtype),
+    _location(NULL), _data(NULL)
 {
-  assert(_name != "");
+  assert(name != "");
   assert(_datatype != NULL);
 }
 
@@ -112,7 +114,12 @@ CSymbol::~CSymbol(void)
   if (_location != NULL) delete _location;
 }
 
-string CSymbol::GetName(void) const
+const string& CSymbol::GetName(void) const
+{
+  return CAtomTable::Get()->GetString(_name);
+}
+
+TAtom CSymbol::GetAtom(void) const
 {
   return _name;
 }
@@ -332,21 +339,19 @@ ostream& CSymConstant::print(ostream &out, int indent) const
 // CSymtab
 //
 CSymtab::CSymtab(void)
-  : _parent(NULL)
+  : _slots(16, NULL), _parent(NULL)
 {
 }
 
 CSymtab::CSymtab(CSymtab *parent)
-  : _parent(parent)
+  : _slots(16, NULL), _parent(parent)
 {
   assert(parent != NULL);
 }
 
 CSymtab::~CSymtab(void)
 {
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) delete (*it++).second;
-  _symtab.clear();
+  for (CSymbol *s : _symbols) delete s;
 }
 
 CSymtab* CSymtab::GetParent(void) const
@@ -363,37 +368,79 @@ bool CSymtab::AddSymbol(CSymbol *s)
     return _parent->AddSymbol(s);
   }
 
-  if (!FindSymbol(s->GetName(), sLocal)) {
-    _symtab[s->GetName()] = s;
-    s->SetSymbolTable(this);
-    return true;
-  } else {
-    return false;
-  }
+  size_t slot = Slot(s->GetAtom());
+  if (_slots[slot] != NULL) return false;
+
+  _slots[slot] = s;
+  _symbols.push_back(s);
+  _sorted.clear();
+  if ((s->GetSymbolType() == stGlobal) && (s->GetData() != NULL)) _data[s->GetData()] = s;
+  s->SetSymbolTable(this);
+
+  // keep the load factor below 1/2
+  if (2*_symbols.size() > _slots.size()) Grow();
+
+  return true;
 }
 
 const CSymbol* CSymtab::FindSymbol(const string name, EScope scope) const
 {
-  map<string, CSymbol*>::const_iterator it = _symtab.find(name);
+  // names that are not interned do not name a symbol
+  TAtom atom;
+  if (!CAtomTable::Get()->Find(name, &atom)) return NULL;
 
-  if (it != _symtab.end()) return (*it).second;
-  else {
-    if ((scope == sLocal) || (_parent == NULL)) return NULL;
-    else return _parent->FindSymbol(name, scope);
-  }
+  return FindSymbol(atom, scope);
 }
 
-vector<CSymbol*> CSymtab::GetSymbols(void) const
+const CSymbol* CSymtab::FindSymbol(TAtom name, EScope scope) const
 {
-  vector<CSymbol*> _res;
+  const CSymtab *st = this;
+
+  do {
+    const CSymbol *s = st->_slots[st->Slot(name)];
+    if (s != NULL) return s;
+
+    st = st->_parent;
+  } while ((scope == sGlobal) && (st != NULL));
 
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) {
-    _res.push_back(it->second);
-    it++;
+  return NULL;
+}
+
+const CSymbol* CSymtab::FindData(const CDataInitializer *data) const
+{
+  const CSymtab *st = this;
+  while (st->_parent != NULL) st = st->_parent;
+
+  auto it = st->_data.find(data);
+  return it != st->_data.end() ? it->second : NULL;
+}
+
+const vector<CSymbol*>& CSymtab::GetSymbols(void) const
+{
+  if (_sorted.size() != _symbols.size()) {
+    _sorted = _symbols;
+    sort(_sorted.begin(), _sorted.end(),
+         [](const CSymbol *a, const CSymbol *b) { return a->GetName() < b->GetName(); });
   }
 
-  return _res;
+  return _sorted;
+}
+
+size_t CSymtab::Slot(TAtom name) const
+{
+  // atoms are dense small integers; multiplying by an odd constant permutes them in the table
+  size_t mask = _slots.size() - 1;
+  size_t slot = (name * 2654435769U) & mask;
+
+  while ((_slots[slot] != NULL) && (_slots[slot]->GetAtom() != name)) slot = (slot + 1) & mask;
+
+  return slot;
+}
+
+void CSymtab::Grow(void)
+{
+  _slots.assign(2*_slots.size(), NULL);
+  for (CSymbol *s : _symbols) _slots[Slot(s->GetAtom())] = s;
 }
 
 ostream& CSymtab::print(ostream &out, int indent) const
@@ -401,11 +448,9 @@ ostream& CSymtab::print(ostream &out, int indent) const
   string ind(indent, ' ');
 
   out << ind << "[[";
-  map<string, CSymbol*>::const_iterator it = _symtab.begin();
-  while (it != _symtab.end()) {
+  for (const CSymbol *s : GetSymbols()) {
     out << endl;
 
-    const CSymbol *s = (*it++).second;
     s->print(out, indent+2);
 
     const CDataInitializer *di = s->GetData();
@@ -35,9 +35,10 @@
 #define __SnuPL_SYMTAB_H__
 
 #include <iostream>
-#include <map>
+#include <unordered_map>
 #include <vector>
 
+#include "atom.h"
 #include "data.h"
 #include "type.h"
 using namespace std;
@@ -166,7 +167,11 @@ class CSymbol {
 
     /// @brief return the symbol's identifier
     /// @retval string name
-    string GetName(void) const;
+    const string& GetName(void) const;
+
+    /// @brief return the symbol's interned identifier
+    /// @retval TAtom name
+    TAtom GetAtom(void) const;
 
     /// @brief return the symbol's type
     /// @retval ESymbolType symbol type
@@ -227,7 +232,7 @@ class CSymbol {
     /// @}
 
     CSymtab       *_symtab;       ///< symbol table owning this symbol
-    string         _name;         ///< name
+    TAtom          _name;         ///< name
     ESymbolType    _symboltype;   ///< symbol type
     const CType   *_datatype;     ///< data type
     CStorage      *_location;     ///< storage location
@@ -461,7 +466,8 @@ enum EScope {
 //--------------------------------------------------------------------------------------------------
 /// @brief SnuPL symbol table
 ///
-/// hierarchical symbol table
+/// hierarchical symbol table. Symbols are stored in an open-addressing hash table keyed on the
+/// interned name (see CSymbol::GetAtom()).
 ///
 class CSymtab {
   public:
@@ -506,8 +512,19 @@ class CSymtab {
     /// @retval CSymbol matching symbol or NULL if not found
     const CSymbol* FindSymbol(const string name, EScope scope=sGlobal) const;
 
-    /// @brief return a list of all symbols
-    vector<CSymbol*> GetSymbols(void) const;
+    /// @brief return a symbol with a given interned name
+    /// @param name symbol name (identifier)
+    /// @param scope search scope (default: sGlobal)
+    /// @retval CSymbol matching symbol or NULL if not found
+    const CSymbol* FindSymbol(TAtom name, EScope scope=sGlobal) const;
+
+    /// @brief return the global symbol holding the initialized data @a data
+    /// @param data data initializer
+    /// @retval CSymbol matching symbol or NULL if not found
+    const CSymbol* FindData(const CDataInitializer *data) const;
+
+    /// @brief return a list of all symbols (sorted by name)
+    const vector<CSymbol*>& GetSymbols(void) const;
 
     /// @}
 
@@ -519,7 +536,18 @@ class CSymtab {
     ostream&  print(ostream &out, int indent=0) const;
 
   private:
-    map<string, CSymbol*> _symtab;///< local symbol table
+    /// @brief return the slot of the symbol named @a name (empty slot if not present)
+    size_t Slot(TAtom name) const;
+
+    /// @brief double the number of slots
+    void Grow(void);
+
+    vector<CSymbol*> _slots;      ///< hash table (NULL: empty slot)
+    vector<CSymbol*> _symbols;    ///< local symbols in order of insertion
+    mutable vector<CSymbol*>
+                   _sorted;       ///< local symbols sorted by name (empty: not computed)
+    unordered_map<const CDataInitializer*, const CSymbol*>
+                   _data;         ///< global symbols by data initializer
     CSymtab       *_parent;       ///< parent
 };
 
@@ -0,0 +1,294 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL binary IR file test
+///
+/// Compiles each module to TAC and saves it in several semantically invalid variants that the
+/// backend or the interpreter would crash on. All variants are well-formed IR files with a valid
+/// checksum; the test fails unless the IR reader rejects every one of them. The variants are
+/// written to <file>.<variant>.ir so that they can be fed to the compiler as well (memcheck.sh).
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <iostream>
+#include <fstream>
+#include <iomanip>
+#include <sstream>
+#include <cassert>
+
+#include "scanner.h"
+#include "parser.h"
+#include "ir.h"
+#include "irfile.h"
+using namespace std;
+
+/// @brief offsets of the file size (followed by the checksum) and of the body in an IR file
+#define SIZE_OFS      28
+#define BODY_OFS      36
+
+/// @brief replace the instructions of @a s by @a instr followed by the current ones, except
+///        for @a skip (which is removed)
+static void Prepend(CScope *s, CTacInstr *instr, CTacInstr *skip=NULL)
+{
+  CCodeBlock *cb = s->GetCodeBlock();
+  vector<CTacInstr*> list;
+
+  if (instr != NULL) list.push_back(instr);
+  for (CTacInstr *i : cb->GetInstr()) {
+    if (i != skip) list.push_back(i);
+  }
+
+  if (skip != NULL) cb->RemoveInstr(skip);
+  cb->SetInstr(list);
+}
+
+/// @brief return the module and its procedures
+static vector<CScope*> Scopes(CModule *m)
+{
+  vector<CScope*> scopes { m };
+  for (size_t i=0; i<scopes.size(); i++) {
+    for (CScope *c : scopes[i]->GetSubscopes()) scopes.push_back(c);
+  }
+  return scopes;
+}
+
+/// @name variants; each returns false if the module offers no opportunity for it
+/// @{
+
+/// @brief argument index far beyond the parameter list of the callee
+static bool BadParam(CModule *m)
+{
+  for (CScope *s : Scopes(m)) {
+    for (CTacInstr *i : s->GetCodeBlock()->GetInstr()) {
+      if (i->GetOperation() != opParam) continue;
+
+      CTacConst *index = s->CreateConst(1 << 30, CTypeManager::Get()->GetInteger());
+      Prepend(s, s->CreateInstr(opParam, index, i->GetSrc(1)), i);
+      return true;
+    }
+  }
+  return false;
+}
+
+/// @brief assignment to a local variable of a procedure in the module body
+static bool BadSymbol(CModule *m)
+{
+  for (CScope *s : m->GetSubscopes()) {
+    for (CSymbol *sym : s->GetSymbolTable()->GetSymbols()) {
+      if ((sym->GetSymbolType() != stLocal) || !sym->GetDataType()->IsScalar()) continue;
+
+      CTacConst *zero = m->CreateConst(0, sym->GetDataType());
+      Prepend(m, m->CreateInstr(opAssign, m->CreateName(sym), zero));
+      return true;
+    }
+  }
+  return false;
+}
+
+/// @brief scalar global initialized with a value (only strings are supported)
+static bool BadGlobal(CModule *m)
+{
+  CSymbol *g = new CSymGlobal("_corrupt", CTypeManager::Get()->GetInteger());
+  g->SetData(m->GetArena()->New<CDataInitInteger>(1));
+  return m->GetSymbolTable()->AddSymbol(g);
+}
+
+/// @brief label that the next label created by the optimizer would clash with
+static bool BadLabel(CModule *m)
+{
+  CTacLabel *l = m->CreateLabel();
+  Prepend(m, m->GetArena()->New<CTacLabel>(to_string(stoul(l->GetLabel()) + 1)));
+  return true;
+}
+
+/// @brief counter for new labels (the patch sets it to 2^32, which is out of range)
+static void MarkCounter(CModule *m, int n)
+{
+  for (int i=0; i<n; i++) m->CreateLabel();
+}
+
+/// @brief constant (the patch removes its value)
+static void MarkConstant(CModule *m, int n)
+{
+  const CType *t = CTypeManager::Get()->GetInteger();
+  m->GetSymbolTable()->AddSymbol(
+    new CSymConstant("_corrupt", t, m->GetArena()->New<CDataInitInteger>(n)));
+}
+
+/// @}
+
+/// @brief compile @a fn to TAC
+/// @retval CModule* module (the AST is returned in @a ast)
+/// @retval NULL on syntax or semantic errors
+static CModule* Compile(const char *fn, CAstModule *&ast)
+{
+  ifstream in(fn);
+  CScanner s(&in);
+  CParser p(&s);
+  CToken t;
+  string msg;
+
+  ast = dynamic_cast<CAstModule*>(p.Parse());
+  if (p.HasError() || (ast == NULL) || !ast->TypeCheck(&t, &msg)) {
+    delete ast;
+    ast = NULL;
+    return NULL;
+  }
+
+  return new CModule(ast);
+}
+
+/// @brief serialize @a m
+static string Write(const CModule *m)
+{
+  CIRWriter w;
+  ostringstream out;
+
+  bool ok = w.Write(m, out);
+  assert(ok);
+
+  return out.str();
+}
+
+/// @brief update the file size and the checksum in the header of IR file @a ir
+static void Seal(string &ir)
+{
+  unsigned int h = 2166136261U;
+  for (size_t i=BODY_OFS; i<ir.size(); i++) h = (h ^ (unsigned char)ir[i]) * 16777619U;
+
+  unsigned int v[] = { (unsigned int)ir.size(), h };
+  for (int f=0; f<2; f++) {
+    for (int b=0; b<4; b++) ir[SIZE_OFS + 4*f + b] = (char)((v[f] >> (8*b)) & 0xff);
+  }
+}
+
+/// @brief serialize @a fn with @a mark applied and replace the marked varint by @a bytes
+///
+/// The varint is located by comparing the files written with mark(m, 0) and mark(m, 1); the
+/// @a before bytes in front of it are replaced as well.
+static bool Patch(const char *fn, void (*mark)(CModule *m, int n), size_t before,
+                  const string bytes, string &ir)
+{
+  string ver[2];
+
+  for (int n=0; n<2; n++) {
+    CAstModule *ast;
+    CModule *m = Compile(fn, ast);
+    mark(m, n);
+    ver[n] = Write(m);
+    delete m;
+    delete ast;
+  }
+
+  ir = ver[0];
+
+  size_t p = BODY_OFS;
+  while ((p < ir.size()) && (p < ver[1].size()) && (ir[p] == ver[1][p])) p++;
+  if ((p >= ir.size()) || (p < BODY_OFS + before)) return false;
+
+  size_t end = p;
+  while ((end < ir.size()) && (ir[end] & 0x80)) end++;
+  ir.replace(p - before, end + 1 - (p - before), bytes);
+  Seal(ir);
+  return true;
+}
+
+int main(int argc, char *argv[])
+{
+  struct {
+    const char *name;
+    bool (*corrupt)(CModule *m);      ///< modify the module, or
+    void (*mark)(CModule *m, int n);  ///< patch the file (see Patch())
+    size_t before;
+    string bytes;
+  } variants[] = {
+    { "param",    BadParam,  NULL,         0, "" },
+    { "symbol",   BadSymbol, NULL,         0, "" },
+    { "global",   BadGlobal, NULL,         0, "" },
+    { "label",    BadLabel,  NULL,         0, "" },
+    { "constant", NULL,      MarkConstant, 1, string(1, '\0') },
+    { "counter",  NULL,      MarkCounter,  0, "\x80\x80\x80\x80\x10" },
+  };
+  bool failed = false;
+
+  if (argc < 2) {
+    cout << "usage: test_irfile FILES..." << endl;
+    return EXIT_FAILURE;
+  }
+
+  for (int i=1; i<argc; i++) {
+    cout << "testing '" << argv[i] << "'..." << endl;
+
+    CAstModule *ast;
+    CModule *m = Compile(argv[i], ast);
+    if (m == NULL) {
+      cout << "  skipped (does not compile)." << endl;
+      continue;
+    }
+    string valid = Write(m);
+    delete m;
+    delete ast;
+
+    for (const auto &v : variants) {
+      string ir;
+
+      if (v.corrupt != NULL) {
+        m = Compile(argv[i], ast);
+        bool applicable = v.corrupt(m);
+        if (applicable) ir = Write(m);
+        delete m;
+        delete ast;
+        if (!applicable) continue;
+      } else if (!Patch(argv[i], v.mark, v.before, v.bytes, ir)) {
+        continue;
+      }
+
+      ofstream(string(argv[i]) + "." + v.name + ".ir") << ir;
+
+      CIRReader r;
+      CModule *l = r.Load(ir.data(), ir.size());
+      cout << "  " << left << setw(10) << v.name;
+      if (l == NULL) {
+        cout << "rejected: " << r.GetErrorMessage() << endl;
+      } else {
+        cout << "ACCEPTED" << endl;
+        failed = true;
+        delete l;
+      }
+    }
+
+    // the unmodified module must still be accepted
+    CIRReader r;
+    CModule *l = r.Load(valid.data(), valid.size());
+    if (l == NULL) {
+      cout << "  " << left << setw(10) << "valid" << "REJECTED: " << r.GetErrorMessage() << endl;
+      failed = true;
+    }
+    delete l;
+  }
+
+  cout << (failed ? "FAILED." : "Done.") << endl;
+
+  return failed ? EXIT_FAILURE : EXIT_SUCCESS;
+}
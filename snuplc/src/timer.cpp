@@ -0,0 +1,343 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation time and memory report
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#include <cstdlib>
+#include <cstdio>
+#include <new>
+#include <iomanip>
+#include <algorithm>
+
+#include <time.h>
+#include <sys/resource.h>
+
+#include "timer.h"
+using namespace std;
+
+
+//--------------------------------------------------------------------------------------------------
+// allocation counter
+//
+// Replaces the global allocation functions to count the allocations of each thread. The count is
+// maintained even if the time report is disabled; incrementing a thread-local counter is
+// negligible compared to the cost of malloc().
+//
+// Builds with AddressSanitizer keep its allocation functions, which detect mismatched new/delete[]
+// and similar errors that plain malloc()/free() would hide; allocations are not counted there.
+//
+static thread_local unsigned long long _allocations = 0;
+
+#ifndef __SANITIZE_ADDRESS__
+void* operator new(size_t size)
+{
+  _allocations++;
+
+  void *p = malloc(size > 0 ? size : 1);
+  if (p == NULL) throw bad_alloc();
+
+  return p;
+}
+
+void* operator new(size_t size, const nothrow_t&) noexcept
+{
+  _allocations++;
+  return malloc(size > 0 ? size : 1);
+}
+
+void* operator new[](size_t size)
+{
+  return operator new(size);
+}
+
+void* operator new[](size_t size, const nothrow_t &nt) noexcept
+{
+  return operator new(size, nt);
+}
+
+void operator delete(void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete(void *p, const nothrow_t&) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+  free(p);
+}
+
+void operator delete[](void *p, const nothrow_t&) noexcept
+{
+  free(p);
+}
+#endif // __SANITIZE_ADDRESS__
+
+
+//--------------------------------------------------------------------------------------------------
+// helpers
+//
+static thread_local CPhaseTimer *_current = NULL;  ///< innermost running timer of the thread
+static thread_local TPhaseList  *_record = NULL;   ///< phases of the thread's compilation
+
+/// @brief return the current wall-clock time in seconds
+static double WallTime(void)
+{
+  return chrono::duration<double>(chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+/// @brief return the CPU time of the calling thread in seconds
+static double CPUTime(void)
+{
+  struct timespec ts;
+  if (clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts) != 0) return 0.0;
+  return ts.tv_sec + ts.tv_nsec / 1e9;
+}
+
+/// @brief return the peak resident set size of the process in KiB
+static long PeakRSS(void)
+{
+  struct rusage ru;
+  if (getrusage(RUSAGE_SELF, &ru) != 0) return 0;
+  return ru.ru_maxrss;
+}
+
+/// @brief add the usage @a s of @a phase to @a list
+static void Merge(TPhaseList &list, const char *phase, const SPhaseStats &s)
+{
+  auto it = list.begin();
+  while ((it != list.end()) && (it->first != phase)) it++;
+
+  if (it == list.end()) {
+    list.push_back(make_pair(phase, s));
+  } else {
+    it->second.wall   += s.wall;
+    it->second.cpu    += s.cpu;
+    it->second.allocs += s.allocs;
+    it->second.rss     = max(it->second.rss, s.rss);
+    it->second.runs   += s.runs;
+  }
+}
+
+/// @brief print @a str as a JSON string
+static void PrintJSONString(ostream &out, const string &str)
+{
+  out << "\"";
+  for (unsigned char c : str) {
+    if ((c == '"') || (c == '\\')) out << "\\" << c;
+    else if (c < 0x20) {
+      char esc[8];
+      snprintf(esc, sizeof(esc), "\\u%04x", c);
+      out << esc;
+    }
+    else out << c;
+  }
+  out << "\"";
+}
+
+/// @brief print the phases @a list as a JSON array
+static void PrintJSONPhases(ostream &out, const TPhaseList &list, int indent)
+{
+  string ind(indent, ' ');
+
+  out << "[";
+  for (size_t i=0; i<list.size(); i++) {
+    const SPhaseStats &s = list[i].second;
+    out << (i > 0 ? "," : "") << endl
+        << ind << "  { \"phase\": ";
+    PrintJSONString(out, list[i].first);
+    out << ", \"wall\": " << s.wall
+        << ", \"cpu\": " << s.cpu
+        << ", \"allocs\": " << s.allocs
+        << ", \"peak_rss_kib\": " << s.rss
+        << ", \"runs\": " << s.runs << " }";
+  }
+  if (!list.empty()) out << endl << ind;
+  out << "]";
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CTimeReport
+//
+bool CTimeReport::_enabled = false;
+bool CTimeReport::_per_file = false;
+
+CTimeReport::CTimeReport(void)
+  : _start(chrono::steady_clock::now()), _compilations(0)
+{
+}
+
+CTimeReport* CTimeReport::Get(void)
+{
+  static CTimeReport report;
+  return &report;
+}
+
+void CTimeReport::Enable(bool per_file)
+{
+  Get();
+  _enabled = true;
+  _per_file = per_file;
+}
+
+unsigned long long CTimeReport::GetAllocations(void)
+{
+  return _allocations;
+}
+
+void CTimeReport::Begin(void)
+{
+  if (!_enabled) return;
+
+  delete _record;
+  _record = new TPhaseList();
+}
+
+void CTimeReport::End(const string &file)
+{
+  if (_record == NULL) return;
+
+  lock_guard<mutex> guard(_lock);
+
+  for (const auto &p : *_record) Merge(_total, p.first.c_str(), p.second);
+  _compilations++;
+  if (_per_file) _files.push_back(make_pair(file, *_record));
+
+  delete _record;
+  _record = NULL;
+}
+
+void CTimeReport::Print(ostream &out) const
+{
+  lock_guard<mutex> guard(_lock);
+
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - _start).count();
+  SPhaseStats total = { 0.0, 0.0, 0, 0, 0 };
+  for (const auto &p : _total) {
+    total.wall   += p.second.wall;
+    total.cpu    += p.second.cpu;
+    total.allocs += p.second.allocs;
+  }
+  total.rss = PeakRSS();
+
+  ios::fmtflags flags = out.flags();
+
+  out << "time report: " << _compilations << " compilation(s), "
+      << fixed << setprecision(3) << elapsed << " s elapsed" << endl
+      << "  " << left << setw(16) << "phase" << right
+      << setw(12) << "wall (s)" << setw(9) << "wall %"
+      << setw(12) << "cpu (s)" << setw(12) << "allocs"
+      << setw(12) << "RSS (MiB)" << setw(8) << "runs" << endl;
+
+  auto row = [&](const string &phase, const SPhaseStats &s, bool runs) {
+    out << "  " << left << setw(16) << phase << right
+        << setprecision(4) << setw(12) << s.wall
+        << setprecision(1) << setw(8) << (total.wall > 0.0 ? 100.0*s.wall/total.wall : 0.0) << "%"
+        << setprecision(4) << setw(12) << s.cpu
+        << setw(12) << s.allocs
+        << setprecision(1) << setw(12) << s.rss / 1024.0;
+    if (runs) out << setw(8) << s.runs;
+    out << endl;
+  };
+
+  for (const auto &p : _total) row(p.first, p.second, true);
+  row("total", total, false);
+
+  out.flags(flags);
+}
+
+void CTimeReport::PrintJSON(ostream &out) const
+{
+  lock_guard<mutex> guard(_lock);
+
+  double elapsed = chrono::duration<double>(chrono::steady_clock::now() - _start).count();
+
+  out << "{" << endl
+      << "  \"elapsed\": " << elapsed << "," << endl
+      << "  \"peak_rss_kib\": " << PeakRSS() << "," << endl
+      << "  \"phases\": ";
+  PrintJSONPhases(out, _total, 2);
+  out << "," << endl
+      << "  \"files\": [";
+  for (size_t i=0; i<_files.size(); i++) {
+    out << (i > 0 ? "," : "") << endl
+        << "    { \"file\": ";
+    PrintJSONString(out, _files[i].first);
+    out << ", \"phases\": ";
+    PrintJSONPhases(out, _files[i].second, 4);
+    out << " }";
+  }
+  if (!_files.empty()) out << endl << "  ";
+  out << "]" << endl
+      << "}" << endl;
+}
+
+
+//--------------------------------------------------------------------------------------------------
+// CPhaseTimer
+//
+void CPhaseTimer::Start(const char *phase, bool light)
+{
+  _phase = phase;
+  _light = light;
+  _parent = _current;
+  _current = this;
+  _nested = { 0.0, 0.0, 0, 0, 0 };
+
+  _allocs = CTimeReport::GetAllocations();
+  _wall = WallTime();
+  _cpu = light ? 0.0 : CPUTime();
+}
+
+void CPhaseTimer::Stop(void)
+{
+  double wall = WallTime() - _wall;
+  double cpu = _light ? wall : CPUTime() - _cpu;
+  unsigned long long allocs = CTimeReport::GetAllocations() - _allocs;
+
+  _current = _parent;
+  if (_parent != NULL) {
+    _parent->_nested.wall   += wall;
+    _parent->_nested.cpu    += cpu;
+    _parent->_nested.allocs += allocs;
+  }
+
+  if (_record != NULL) {
+    SPhaseStats s = {
+      max(wall - _nested.wall, 0.0),
+      max(cpu - _nested.cpu, 0.0),
+      allocs > _nested.allocs ? allocs - _nested.allocs : 0,
+      _light ? 0 : PeakRSS(),
+      1
+    };
+
+    Merge(*_record, _phase, s);
+  }
+}
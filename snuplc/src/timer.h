@@ -0,0 +1,168 @@
+//--------------------------------------------------------------------------------------------------
+/// @brief SnuPL compilation time and memory report
+///
+/// @section license_section License
+/// Copyright (c) 2023, Computer Systems and Platforms Laboratory, SNU
+/// All rights reserved.
+///
+/// Redistribution and use in source and binary forms, with or without modification, are permitted
+/// provided that the following conditions are met:
+///
+/// - Redistributions of source code must retain the above copyright notice, this list of condi-
+///   tions and the following disclaimer.
+/// - Redistributions in binary form must reproduce the above copyright notice, this list of condi-
+///   tions and the following disclaimer in the documentation and/or other materials provided with
+///   the distribution.
+///
+/// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY EXPRESS OR
+/// IMPLIED WARRANTIES,  INCLUDING, BUT NOT LIMITED TO,  THE IMPLIED WARRANTIES OF MERCHANTABILITY
+/// AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR
+/// CONTRIBUTORS BE LIABLE FOR ANY DIRECT,  INDIRECT,  INCIDENTAL,  SPECIAL,  EXEMPLARY, OR CONSE-
+/// QUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO,  PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES;
+/// LOSS OF USE, DATA,  OR PROFITS;  OR BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF
+/// LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY, OR TORT  (INCLUDING NEGLIGENCE OR OTHERWISE)
+/// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH
+/// DAMAGE.
+//--------------------------------------------------------------------------------------------------
+//--------------------------------------------------------------------------------------------------
+
+#ifndef __SnuPL_TIMER_H__
+#define __SnuPL_TIMER_H__
+
+#include <ostream>
+#include <string>
+#include <vector>
+#include <mutex>
+#include <chrono>
+
+using namespace std;
+
+//--------------------------------------------------------------------------------------------------
+/// @brief resource usage of a compilation phase
+///
+/// Times and allocations are exclusive, i.e., they do not include the phases nested in the phase.
+/// The peak RSS is that of the whole process at the end of the phase.
+///
+struct SPhaseStats {
+  double wall;                          ///< wall-clock time (seconds)
+  double cpu;                           ///< CPU time of the compiling thread (seconds)
+  unsigned long long allocs;            ///< number of heap allocations
+  long   rss;                           ///< peak resident set size of the process (KiB)
+  unsigned long runs;                   ///< number of times the phase has been run
+};
+
+/// @brief resource usage of the phases of one compilation (phase name, usage) in order of first use
+typedef vector<pair<string, SPhaseStats>> TPhaseList;
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief time report
+///
+/// Collects the resource usage of the phases of all compilations of the process. The report is
+/// disabled by default; the phase timers then reduce to a test of a flag. Compilations are
+/// delimited by Begin() and End() on the compiling thread, so several files can be compiled
+/// concurrently.
+///
+class CTimeReport {
+  public:
+    /// @brief return the time report of the process
+    static CTimeReport* Get(void);
+
+    /// @brief enable collecting resource usage. Must be called before compiling.
+    /// @param per_file keep the usage of each compilation (for PrintJSON()); otherwise, only the
+    ///        totals are kept and the report does not grow with the number of compilations
+    static void Enable(bool per_file=false);
+
+    /// @brief check whether the time report is enabled
+    static bool IsEnabled(void) { return _enabled; };
+
+    /// @brief return the number of heap allocations made by the calling thread so far (always 0
+    ///        in builds with AddressSanitizer)
+    static unsigned long long GetAllocations(void);
+
+    /// @brief start collecting the phases of a compilation on the calling thread
+    void Begin(void);
+
+    /// @brief add the phases collected since Begin() to the report as the compilation of @a file
+    void End(const string &file);
+
+    /// @brief print the report as a table
+    /// @param out output stream
+    void Print(ostream &out) const;
+
+    /// @brief print the report in JSON format
+    /// @param out output stream
+    void PrintJSON(ostream &out) const;
+
+  private:
+    CTimeReport(void);
+
+    static bool _enabled;               ///< resource usage is collected
+    static bool _per_file;              ///< resource usage is kept per compilation
+
+    mutable mutex _lock;                ///< protects the members below
+    chrono::steady_clock::time_point _start; ///< time the report was enabled
+    TPhaseList _total;                  ///< resource usage of all compilations
+    size_t _compilations;               ///< number of compilations
+    vector<pair<string, TPhaseList>> _files; ///< resource usage per compilation
+
+    friend class CPhaseTimer;
+};
+
+
+//--------------------------------------------------------------------------------------------------
+/// @brief phase timer
+///
+/// Records the resource usage of the enclosing scope as a run of a phase of the current
+/// compilation of the calling thread. Timers nest; a timer's usage is subtracted from that of
+/// the enclosing timer.
+///
+/// Phases that are run very often (such as scanning a token) use lightweight timers that only
+/// measure the wall-clock time and the allocations; their CPU time is assumed to equal the
+/// wall-clock time.
+///
+class CPhaseTimer {
+  public:
+    /// @name constructor/destructor
+    /// @{
+
+    /// @brief constructor; start the timer if the time report is enabled
+    ///
+    /// @param phase name of the phase (must outlive the timer)
+    /// @param light lightweight timer
+    CPhaseTimer(const char *phase, bool light=false)
+      : _active(CTimeReport::IsEnabled())
+    {
+      if (_active) Start(phase, light);
+    };
+
+    /// @brief destructor; stop the timer
+    ~CPhaseTimer(void)
+    {
+      if (_active) Stop();
+    };
+
+    /// @}
+
+  private:
+    CPhaseTimer(const CPhaseTimer&) = delete;
+    CPhaseTimer& operator=(const CPhaseTimer&) = delete;
+
+    /// @brief start measuring
+    void Start(const char *phase, bool light);
+
+    /// @brief stop measuring and record the usage
+    void Stop(void);
+
+    bool _active;                       ///< timer is running
+    bool _light;                        ///< lightweight timer
+    const char *_phase;                 ///< name of the phase
+    CPhaseTimer *_parent;               ///< enclosing timer
+    double _wall;                       ///< wall-clock time at start
+    double _cpu;                        ///< thread CPU time at start
+    unsigned long long _allocs;         ///< allocation count at start
+    SPhaseStats _nested;                ///< usage of the nested timers
+};
+
+
+#endif // __SnuPL_TIMER_H__
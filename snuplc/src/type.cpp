@@ -57,7 +57,7 @@ unsigned int CType::GetDataSize(void) const
 
 bool CType::Compare(const CType *t) const
 {
-  return Match(t);
+  return this == t;
 }
 
 bool CType::CanWiden(const CType *t) const
@@ -229,6 +229,9 @@ unsigned int CPointerType::GetAlign(void) const {
 
 bool CPointerType::Match(const CType *t) const
 {
+  // identical types match
+  if (t == this) return true;
+
   // check whether t is a pointer
   if ((t == NULL) || !t->IsPointer()) return false;
 
@@ -245,24 +248,6 @@ bool CPointerType::Match(const CType *t) const
   return GetBaseType()->Match(pt->GetBaseType());
 }
 
-bool CPointerType::Compare(const CType *t) const
-{
-  // check whether t is a pointer
-  if ((t == NULL) || !t->IsPointer()) return false;
-
-  const CPointerType *pt = dynamic_cast<const CPointerType*>(t);
-  assert(pt != NULL);
-
-  // comparison: match if
-  // - this is a void pointer or
-  // - the types are compatible with respect to Compare()
-
-  if (GetBaseType()->IsNull())
-    return true;
-
-  return GetBaseType()->Compare(pt->GetBaseType());
-}
-
 ostream& CPointerType::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -327,6 +312,9 @@ unsigned int CArrayType::GetNDim(void) const
 
 bool CArrayType::Match(const CType *t) const
 {
+  // identical types match
+  if (t == this) return true;
+
   // check whether t is an array
   if ((t == NULL) || !t->IsArray()) return false;
 
@@ -345,26 +333,6 @@ bool CArrayType::Match(const CType *t) const
   return false;
 }
 
-bool CArrayType::Compare(const CType *t) const
-{
-  // check whether t is an array
-  if ((t == NULL) || !t->IsArray()) return false;
-
-  const CArrayType *at = dynamic_cast<const CArrayType*>(t);
-  assert(at != NULL);
-
-  // comparison: match if
-  // - the number of elements match and
-  // - the inner types are compatible with respect to Compare()
-
-  if (!GetInnerType()->Compare(at->GetInnerType()))
-    return false;
-  if (GetNElem() == 0 || GetNElem() == at->GetNElem())
-    return true;
-
-  return false;
-}
-
 ostream& CArrayType::print(ostream &out, int indent) const
 {
   string ind(indent, ' ');
@@ -382,7 +350,7 @@ ostream& CArrayType::print(ostream &out, int indent) const
 //--------------------------------------------------------------------------------------------------
 // CTypeManager
 //
-CTypeManager* CTypeManager::_global_tm = NULL;
+thread_local CTypeManager* CTypeManager::_global_tm = NULL;
 
 CTypeManager::CTypeManager(void)
 {
@@ -393,6 +361,7 @@ CTypeManager::CTypeManager(void)
   _longint = new CLongintType();
   _voidptr = new CPointerType(_null);
   _ptr.push_back(_voidptr);
+  _ptr_index[_null] = _voidptr;
 
   unsigned int bits = 8*CEnvironment::Get()->GetTarget()->GetMachineWordSize();
   if (bits == 32) _register = _integer;
@@ -420,6 +389,13 @@ CTypeManager* CTypeManager::Get(void)
   return _global_tm;
 }
 
+CTypeManager* CTypeManager::Set(CTypeManager *tm)
+{
+  CTypeManager *prev = _global_tm;
+  _global_tm = tm;
+  return prev;
+}
+
 const CNullType* CTypeManager::GetNull(void) const
 {
   return _null;
@@ -457,14 +433,13 @@ const CPointerType* CTypeManager::GetVoidPtr(void) const
 
 const CPointerType* CTypeManager::GetPointer(const CType *basetype)
 {
-  for (size_t i=0; i<_ptr.size(); i++) {
-    if ((_ptr[i]->GetBaseType()->Compare(basetype))) {
-      return _ptr[i];
-    }
-  }
+  // types are unique: identical pointer types have the same base type object
+  CPointerType *&p = _ptr_index[basetype];
 
-  CPointerType *p = new CPointerType(basetype);
-  _ptr.push_back(p);
+  if (p == NULL) {
+    p = new CPointerType(basetype);
+    _ptr.push_back(p);
+  }
 
   return p;
 }
@@ -474,12 +449,9 @@ const CArrayType* CTypeManager::GetArray(unsigned int nelem,
 {
   if (innertype == NULL) return NULL;
 
-  for (size_t i=0; i<_array.size(); i++) {
-    if ((_array[i]->GetNElem() == nelem) &&
-        (_array[i]->GetInnerType()->Compare(innertype))) {
-      return _array[i];
-    }
-  }
+  // types are unique: identical array types have the same element count and inner type object
+  auto it = _array_index.find(make_pair(nelem, innertype));
+  if (it != _array_index.end()) return it->second;
 
   unsigned long long size = innertype->GetDataSize();
   if (nelem != CArrayType::OPEN) size = size * nelem + 8;
@@ -488,6 +460,7 @@ const CArrayType* CTypeManager::GetArray(unsigned int nelem,
 
   CArrayType *a = new CArrayType(nelem, innertype);
   _array.push_back(a);
+  _array_index[make_pair(nelem, innertype)] = a;
 
   return a;
 }
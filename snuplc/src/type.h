@@ -35,6 +35,8 @@
 
 #include <climits>
 #include <iostream>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 using namespace std;
 
@@ -116,9 +118,8 @@ class CType {
     /// @brief match two types
     ///
     /// Match() and Compare() differ as follows: Match() returns true for
-    /// compatible types whereas Compare() only returns true for identical
-    /// types. Except for array and pointer types, Match() and Compare()
-    /// return the same result.
+    /// compatible types (integer and longint, open arrays, void pointers)
+    /// whereas Compare() only returns true for identical types.
     ///
     /// @param t type to compare this type to
     /// @retval true if the types match (are compatible)
@@ -126,10 +127,14 @@ class CType {
     virtual bool Match(const CType *t) const = 0;
 
     /// @brief compare two types. Returns true if the types are identical
+    ///
+    /// Types are unique (see CTypeManager), identical types are thus represented by the same
+    /// object and Compare() reduces to a pointer comparison.
+    ///
     /// @param t type to compare this type to
     /// @retval true if the types are identical
     /// @retval false if the types are not identical
-    virtual bool Compare(const CType *t) const;
+    bool Compare(const CType *t) const;
 
     /// @brief check if the provided type @a t can be widened to this one
     /// @param t type to widen to this type
@@ -485,16 +490,6 @@ class CPointerType : public CScalarType {
     /// @retval false if the types do not match (are not compatible)
     virtual bool Match(const CType *t) const;
 
-    /// @brief compare two pointer types
-    ///
-    /// CPointerType::Compare() is identical to Match() but does not support
-    /// pointers to open arrays.
-    ///
-    /// @param t type to compare this type to
-    /// @retval true if the types are equal
-    /// @retval false if the types are not equal
-    virtual bool Compare(const CType *t) const;
-
     /// @}
 
     /// @brief print the type to an output stream
@@ -585,16 +580,6 @@ class CArrayType : public CType {
     /// @retval false if the types do not match (are not compatible)
     virtual bool Match(const CType *t) const;
 
-    /// @brief compare two array types
-    ///
-    /// CArrayType::Compare() is identical to Match() but does not support
-    /// open arrays.
-    ///
-    /// @param t type to compare this type to
-    /// @retval true if the types are equal
-    /// @retval false if the types are not equal
-    virtual bool Compare(const CType *t) const;
-
     /// @}
 
     /// @brief print the type to an output stream
@@ -615,10 +600,18 @@ class CArrayType : public CType {
 /// manages all types in a module
 ///
 class CTypeManager {
+  friend class CContext;
+
   public:
-    /// @brief return the global type manager
+    /// @brief return the type manager of the calling thread
     static CTypeManager* Get(void);
 
+    /// @brief make @a tm the type manager of the calling thread
+    ///
+    /// @param tm type manager (NULL: create a new one on the next call to Get())
+    /// @retval the previous type manager of the calling thread
+    static CTypeManager* Set(CTypeManager *tm);
+
     /// @name base types
     /// @{
 
@@ -646,6 +639,12 @@ class CTypeManager {
     /// @param innertype type of array elements
     const CArrayType* GetArray(unsigned int nelem, const CType* innertype);
 
+    /// @brief return all pointer types (including the void pointer) in order of creation
+    const vector<CPointerType*>& GetPointerTypes(void) const { return _ptr; };
+
+    /// @brief return all array types in order of creation
+    const vector<CArrayType*>& GetArrayTypes(void) const { return _array; };
+
     /// @}
 
     /// @brief print all types to an output stream
@@ -671,10 +670,23 @@ class CTypeManager {
     CIntType      *_register;     ///< register base type (CIntegerType or CLongintType)
     CPointerType  *_voidptr;      ///< void pointer type
 
+    /// @brief hash of the key (element count, inner type) of array types
+    struct SArrayKeyHash {
+      size_t operator()(const pair<unsigned int, const CType*> &k) const
+      {
+        return hash<const CType*>()(k.second) ^ (k.first * 0x9e3779b97f4a7c15ULL);
+      }
+    };
+
     vector<CPointerType*> _ptr;   ///< pointer types
     vector<CArrayType*> _array;   ///< array types
 
-    static CTypeManager *_global_tm; ///< global type manager instance
+    unordered_map<const CType*, CPointerType*>
+                  _ptr_index;     ///< pointer types by base type
+    unordered_map<pair<unsigned int, const CType*>, CArrayType*, SArrayKeyHash>
+                  _array_index;   ///< array types by (element count, inner type)
+
+    static thread_local CTypeManager *_global_tm; ///< type manager of the current thread
 };
 
 
@@ -0,0 +1,52 @@
+//
+// test22
+//
+// Code generation
+// - block layout: early returns, if/else in loops, nested loops
+//
+
+module test22;
+
+var n, i: integer;
+
+function collatz(n: integer): integer;
+var steps: integer;
+begin
+  if (n <= 0) then return -1 end;
+
+  steps := 0;
+  while (n # 1) do
+    if (n / 2 * 2 = n) then n := n / 2
+    else n := 3 * n + 1
+    end;
+    steps := steps + 1
+  end;
+  return steps
+end collatz;
+
+function triangle(n: integer): integer;
+var i, j, s: integer;
+begin
+  s := 0;
+  i := 0;
+  while (i < n) do
+    j := 0;
+    while ((j < i) && (j < 100)) do
+      s := s + j;
+      j := j + 1
+    end;
+    i := i + 1
+  end;
+  return s
+end triangle;
+
+begin
+  WriteStr("Enter a number: "); n := ReadInt(); WriteLn();
+
+  i := -1;
+  while (i <= n) do
+    WriteStr("collatz("); WriteInt(i); WriteStr(") = "); WriteInt(collatz(i));
+    WriteStr(", triangle = "); WriteInt(triangle(i)); WriteLn();
+    i := i + 1
+  end
+end test22.
@@ -0,0 +1,36 @@
+//
+// test23
+//
+// Code generation
+// - parameters kept in registers
+// - stack arguments passed from within a procedure
+//
+
+module test23;
+
+function sum8(a, b, c, d, e, f, g, h: integer): integer;
+begin
+  return a + b*2 + c*3 + d*4 + e*5 + f*6 + g*7 + h*8
+end sum8;
+
+function pass(x, y: integer; z: char; w: boolean): integer;
+begin
+  if (w) then WriteChar(z) end;
+  return x*y - sum8(x, y, 3, 4, x, y, 7, y)
+end pass;
+
+procedure fill(a: integer[]; n: integer);
+var i: integer;
+begin
+  i := 0;
+  while (i < n) do a[i] := i * n; i := i + 1 end
+end fill;
+
+var A: integer[5];
+
+begin
+  WriteInt(sum8(1, 2, 3, 4, 5, 6, 7, 8)); WriteLn();
+  WriteInt(pass(5, -3, 'x', true)); WriteLn();
+  WriteInt(pass(-20, 1, 'y', false)); WriteLn();
+  fill(A, 5); WriteInt(A[4]); WriteLn()
+end test23.
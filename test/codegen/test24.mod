@@ -0,0 +1,38 @@
+//
+// test24
+//
+// Code generation
+// - globals kept in registers
+// - write-back and reload around calls that access them
+//
+
+module test24;
+var sum, n, calls: integer; c: char;
+procedure bump();
+begin
+  calls := calls + 1
+end bump;
+function peek(): integer;
+begin
+  return sum
+end peek;
+procedure work(k: integer);
+var i: integer;
+begin
+  i := 0;
+  while (i < k) do
+    sum := sum + i;
+    if (i = 5) then bump() end;
+    if (i = 7) then WriteInt(peek()); WriteLn() end;
+    i := i + 1
+  end
+end work;
+begin
+  n := 0; c := 'a';
+  while (n < 10) do
+    n := n + 1;
+    work(n);
+    c := c
+  end;
+  WriteInt(sum); WriteLn(); WriteInt(calls); WriteLn(); WriteChar(c); WriteLn()
+end test24.
@@ -0,0 +1,114 @@
+#!/bin/bash
+#---------------------------------------------------------------------------------------------------
+# SnuPL/2 memory check
+#
+# 1. Compiles all test modules in one process with the compiler built with AddressSanitizer and
+#    LeakSanitizer (snuplc_asan) in several configurations, including the IR interpreter, parallel
+#    compilation, and loading binary IR (valid, truncated, and the semantically invalid files
+#    generated by test_irfile, which also fails unless the IR reader rejects all of them). Any
+#    memory error or leak fails the check. The test modules include programs with syntax and semantic errors, so the error paths
+#    are covered as well.
+# 2. Compiles the test modules REPS and 4*REPS times in one process with the regular compiler and
+#    compares the peak memory reported by --time-report. Everything allocated for a compilation
+#    must be released before the next one starts, so the peak may only grow by the memory for the
+#    list of file names (a few hundred bytes per file).
+#
+# usage: memcheck.sh [-r REPS]
+#   -r REPS  number of times the test modules are compiled in the first run (default: 5)
+#
+# The compilers can be overridden with the SNUPLC and SNUPLC_ASAN environment variables, the IR
+# file test with TEST_IRFILE.
+#
+
+TEST=$(cd "$(dirname "$0")" && pwd)
+ROOT=$TEST/../snuplc
+SNUPLC=${SNUPLC:-$ROOT/snuplc}
+SNUPLC_ASAN=${SNUPLC_ASAN:-$ROOT/snuplc_asan}
+TEST_IRFILE=${TEST_IRFILE:-$ROOT/test_irfile}
+
+# allowed growth of the peak memory in KiB
+SLACK=1024
+
+REPS=5
+while getopts "r:" opt; do
+  case "$opt" in
+    r) REPS=$OPTARG ;;
+    *) sed -n '/^# usage/,/^#$/p' "$0" | sed 's/^# \{0,1\}//' >&2; exit 1 ;;
+  esac
+done
+
+WORK=$(mktemp -d)
+trap 'rm -rf "$WORK"' EXIT
+
+# test modules of all phases; the names are prefixed by the phase to keep them apart
+for f in "$TEST"/*/*.mod; do
+  d=$(basename "$(dirname "$f")")
+  cp "$f" "$WORK/$d-$(basename "$f")"
+done
+cd "$WORK" || exit 1
+MODULES=(*.mod)
+# programs that are meant to be run (some parser tests do not terminate)
+PROGRAMS=(codegen-*.mod)
+
+export ASAN_OPTIONS=detect_leaks=1
+fail=0
+
+# asan <name> <options and files>...: compile in one process with the instrumented compiler
+asan() {
+  local name=$1
+  shift
+  "$SNUPLC_ASAN" --no-cache --no-exe "$@" < /dev/null > "$WORK/$name.log" 2>&1
+  if grep -q "ERROR: \(AddressSanitizer\|LeakSanitizer\)" "$WORK/$name.log"; then
+    printf "  %-24s %s\n" "$name" "$(grep -m1 SUMMARY "$WORK/$name.log")"
+    fail=1
+  else
+    printf "  %-24s ok\n" "$name"
+  fi
+}
+
+echo "SnuPL/2 memory check: ${#MODULES[@]} test modules"
+echo "AddressSanitizer/LeakSanitizer:"
+asan default "${MODULES[@]}"
+asan O0 -O0 "${MODULES[@]}"
+asan O2 -O2 --instrument "${MODULES[@]}"
+asan parallel -O2 -j 4 "${MODULES[@]}"
+asan print-after -O2 --print-after=all "${MODULES[@]}"
+asan interpret --interpret "${PROGRAMS[@]}"
+asan emit-ir -O0 --emit-ir "${MODULES[@]}"
+IRS=(*.mod.ir)
+for ir in "${IRS[@]:0:4}"; do
+  head -c $(( $(stat -c %s "$ir") / 2 )) "$ir" > "truncated-$ir"
+done
+asan load-ir -O2 "${IRS[@]}" truncated-*.ir
+if "$TEST_IRFILE" "${PROGRAMS[@]}" > "$WORK/test_irfile.log" 2>&1; then
+  printf "  %-24s ok\n" test_irfile
+else
+  printf "  %-24s %s\n" test_irfile "$(grep -m1 "ACCEPTED\|REJECTED\|Assert" "$WORK/test_irfile.log")"
+  fail=1
+fi
+asan invalid-ir -O2 codegen-*.mod.*.ir
+
+# peak <repetitions> [options]...: peak memory in KiB of compiling the modules repeatedly
+peak() {
+  local reps=$1 files=() i
+  shift
+  local modules=("${MODULES[@]}")
+  [ "$1" = --interpret ] && modules=("${PROGRAMS[@]}")
+  for ((i=0; i<reps; i++)); do files+=("${modules[@]}"); done
+  "$SNUPLC" --no-cache --no-exe --time-report "$@" "${files[@]}" < /dev/null 2>&1 > /dev/null | \
+    awk '$1 == "total" { printf "%d\n", $6 * 1024 }'
+}
+
+echo "peak memory ($REPS and $((4*REPS)) compilations of each module):"
+for opts in "" "-O2 -j 4" "--interpret"; do
+  p1=$(peak "$REPS" $opts)
+  p4=$(peak $((4*REPS)) $opts)
+  status=ok
+  if [ -z "$p1" ] || [ -z "$p4" ] || [ $((p4 - p1)) -gt $SLACK ]; then
+    status=failed
+    fail=1
+  fi
+  printf "  %-24s %8s KiB %8s KiB  %s\n" "${opts:-default}" "$p1" "$p4" "$status"
+done
+
+exit $fail
@@ -0,0 +1,6 @@
+// identifiers, numbers and white space longer than one vector (16/32 characters)
+an_identifier_that_is_longer_than_thirty_two_characters := 12345678901234567890123456789012345;
+                                     x																				y
+ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz_0123456789@abc
+short_id_15chrs 1234567890123456L
+a23456789012345678901234567890123
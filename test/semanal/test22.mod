@@ -0,0 +1,24 @@
+//
+// test22
+//
+// semantic analysis
+// - constant expressions: division overflow
+//
+
+module test22;
+
+const
+  IMin : integer = -2147483647 - 1;
+  LMin : longint = -9223372036854775807L - 1L;
+
+  I1   : integer = IMin / (-2);                // pass
+  L1   : longint = LMin / (-2L);               // pass
+  I2   : integer = (IMin + 1) / (-1);          // pass
+  L2   : longint = LMin / (-1L);               // fail: overflows, traps at run time
+
+var
+  i : integer;
+
+begin
+  i := IMin / (-1)                             // pass: not folded, traps at run time
+end test22.